@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+#include "Benchmark.hpp"
+
+namespace {
+    double Mean(const std::vector<double>& samples) {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        return std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    }
+
+    double NanosecondsPerItem(const BenchmarkResult& result, const TimingSummary& summary) {
+        return summary.median * 1e6 / static_cast<double>(std::max<std::uint64_t>(result.items, 1));
+    }
+
+    std::string Escaped(const std::string_view text) {
+        std::string escaped;
+        for (const auto c : text) {
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    // JSON has no inf or nan, e.g. a ratio counter over an empty run
+    std::string JsonNumber(const double value) {
+        return std::isfinite(value) ? std::format("{}", value) : "null";
+    }
+}
+
+bool BenchmarkSelected(const BenchmarkRun& run, const std::string_view name) {
+    return run.settings.filter.empty() || name.find(run.settings.filter) != std::string_view::npos;
+}
+
+void PrintBenchmarkReport(const BenchmarkRun& run) {
+    std::cout << std::format("{:<48} {:>8} {:>10} {:>10} {:>10} {:>12}\n", "benchmark (ms per sample)", "samples",
+                             "min", "median", "p99", "ns/item");
+    for (const auto& result : run.results) {
+        const auto summary = SummarizeTimings(result.sample_ms);
+        std::cout << std::format("{:<48} {:>8} {:>10.4f} {:>10.4f} {:>10.4f} {:>12.2f}\n", result.name,
+                                 result.sample_ms.size(), summary.min, summary.median, summary.p99,
+                                 NanosecondsPerItem(result, summary));
+        for (const auto& [name, value] : result.counters) {
+            std::cout << std::format("    {:<44} {:>12.3f}\n", name, value);
+        }
+    }
+}
+
+void WriteBenchmarkJson(const BenchmarkRun& run, const std::filesystem::path& path, const std::string_view label) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("{}: could not open for writing", path.string()));
+    }
+
+    file << std::format("{{\n  \"label\": \"{}\",\n  \"quick\": {},\n  \"benchmarks\": [", Escaped(label),
+                        run.settings.quick);
+    const char* separator = "\n";
+    for (const auto& result : run.results) {
+        const auto summary = SummarizeTimings(result.sample_ms);
+        file << separator;
+        separator = ",\n";
+        file << std::format("    {{\"name\": \"{}\", \"samples\": {}, \"items_per_sample\": {}, \"min_ms\": {}, "
+                            "\"median_ms\": {}, \"p99_ms\": {}, \"mean_ms\": {}, \"median_ns_per_item\": {}",
+                            Escaped(result.name), result.sample_ms.size(), result.items, JsonNumber(summary.min),
+                            JsonNumber(summary.median), JsonNumber(summary.p99), JsonNumber(Mean(result.sample_ms)),
+                            JsonNumber(NanosecondsPerItem(result, summary)));
+        file << ", \"counters\": {";
+        const char* counter_separator = "";
+        for (const auto& [name, value] : result.counters) {
+            file << std::format("{}\"{}\": {}", counter_separator, Escaped(name), JsonNumber(value));
+            counter_separator = ", ";
+        }
+        file << "}}";
+    }
+    file << "\n  ]\n}\n";
+    if (!file) {
+        throw std::runtime_error(std::format("{}: write failed", path.string()));
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "FrameStats.hpp"
+
+// A benchmark times repeated samples of a body on FrameClock. Microbenchmarks loop over `items` calls inside one
+// sample, so results are also reported per item; scene benchmarks time one frame per sample. Sampling continues
+// until both min_samples and min_time_ms are reached, or max_samples is.
+struct BenchmarkSettings {
+    std::size_t warmup_samples = 2;
+    std::size_t min_samples = 10;
+    std::size_t max_samples = 1000;
+    double min_time_ms = 250.0;
+    std::string filter; // only benchmarks whose name contains it run
+    bool quick = false; // smaller scenes and shorter runs, for checking the suite itself
+};
+struct BenchmarkResult {
+    std::string name;
+    std::uint64_t items = 1; // per sample
+    std::vector<double> sample_ms;
+    std::vector<std::pair<std::string, double>> counters; // extra per-benchmark figures, written as-is
+};
+struct BenchmarkRun {
+    BenchmarkSettings settings;
+    std::vector<BenchmarkResult> results;
+};
+
+// Stops the compiler from discarding a computation whose result is otherwise unused.
+template <typename T>
+inline void KeepAlive(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+bool BenchmarkSelected(const BenchmarkRun& run, std::string_view name);
+
+// Runs body() for warmup and then timed samples. Returns the recorded result, valid until the next benchmark is run,
+// so callers can attach counters; nullptr if the name is filtered out.
+template <typename Body>
+BenchmarkResult* RunBenchmark(BenchmarkRun& run, std::string name, const std::uint64_t items, Body&& body) {
+    if (!BenchmarkSelected(run, name)) {
+        return nullptr;
+    }
+    const auto& settings = run.settings;
+    for (std::size_t i = 0; i < settings.warmup_samples; ++i) {
+        body();
+    }
+
+    BenchmarkResult result{.name = std::move(name), .items = items};
+    const auto start = FrameClock::now();
+    while (result.sample_ms.size() < settings.max_samples) {
+        const auto sample_start = FrameClock::now();
+        body();
+        const auto sample_end = FrameClock::now();
+        result.sample_ms.push_back(MillisecondsBetween(sample_start, sample_end));
+        if (result.sample_ms.size() >= settings.min_samples &&
+            MillisecondsBetween(start, sample_end) >= settings.min_time_ms) {
+            break;
+        }
+    }
+    run.results.push_back(std::move(result));
+    return &run.results.back();
+}
+
+void PrintBenchmarkReport(const BenchmarkRun& run);
+// One object per benchmark with min/median/p99/mean milliseconds per sample, median nanoseconds per item and its
+// counters; `label` (e.g. a commit hash) is stored alongside. Throws std::runtime_error if the file cannot be written.
+void WriteBenchmarkJson(const BenchmarkRun& run, const std::filesystem::path& path, std::string_view label);
+
+// Suites, in benchmarks/*Benchmarks.cpp
+void RunMathBenchmarks(BenchmarkRun& run);
+void RunUploadBenchmarks(BenchmarkRun& run);
+void RunSceneBenchmarks(BenchmarkRun& run);
+void RunTerrainBenchmarks(BenchmarkRun& run);
+void RunLightingBenchmarks(BenchmarkRun& run);
@@ -0,0 +1,27 @@
+#include <format>
+
+#include "Benchmark.hpp"
+#include "ClusteredLighting.hpp"
+#include "ProceduralScenes.hpp"
+
+void RunLightingBenchmarks(BenchmarkRun& run) {
+    // one frame's light binning from the test scene's starting view; items are lights
+    const auto camera = CreateCamera();
+    for (const auto light_count : {256u, 1024u}) {
+        const auto name = std::format("lighting/BuildLightClusters/{}_lights", light_count);
+        if (!BenchmarkSelected(run, name)) {
+            continue;
+        }
+        const auto field = CreateLightField(light_count, kLightFieldExtent, kLightRadius);
+        auto clusters = CreateLightClusters(nullptr);
+        auto* result = RunBenchmark(run, name, light_count, [&] {
+            BuildLightClusters(clusters, field.lights, camera.view, camera.proj,
+                               glm::vec2{640.0f, 640.0f}, GetThreadPool());
+            KeepAlive(clusters.ranges[0]);
+        });
+        const auto& stats = clusters.frame_stats;
+        result->counters = {
+            {"lights_per_froxel", static_cast<double>(stats.assignments) / static_cast<double>(stats.froxels)},
+            {"max_lights_per_froxel", static_cast<double>(stats.max_lights)}};
+    }
+}
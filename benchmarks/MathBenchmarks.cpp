@@ -0,0 +1,63 @@
+#include <format>
+
+#include "Benchmark.hpp"
+#include "ProceduralScenes.hpp"
+#include "SceneMath.hpp"
+#include "TransformHierarchy.hpp"
+#include "VertexNormals.hpp"
+
+namespace {
+    constexpr std::uint64_t kCallsPerSample = 1u << 16;
+    constexpr std::uint32_t kTransformNodes = 4096;
+}
+
+void RunMathBenchmarks(BenchmarkRun& run) {
+    // inputs vary per call so nothing is hoisted out of the loop
+    auto camera = CreateCamera();
+    RunBenchmark(run, "math/LookAt", kCallsPerSample, [&] {
+        for (std::uint64_t i = 0; i < kCallsPerSample; ++i) {
+            camera.camera_coords.x = static_cast<float>(i & 255) * 0.01f;
+            KeepAlive(LookAt(camera, camera.target_coords));
+        }
+    });
+    RunBenchmark(run, "math/Project", kCallsPerSample, [&] {
+        for (std::uint64_t i = 0; i < kCallsPerSample; ++i) {
+            KeepAlive(Project(camera, 0.5f + static_cast<float>(i & 255) * 0.001f, 1.0f, 1.0f, 0.0f));
+        }
+    });
+
+    TransformHierarchy transforms;
+    for (std::uint32_t i = 0; i < kTransformNodes; ++i) {
+        AddTransform(transforms);
+    }
+    RunBenchmark(run, "math/RotateModelInPlace", kCallsPerSample, [&] {
+        for (std::uint64_t i = 0; i < kCallsPerSample; ++i) {
+            RotateModelInPlace(transforms, static_cast<TransformHandle>(i % kTransformNodes), 0.01f,
+                               glm::vec3{0.0f, 1.0f, 0.0f});
+        }
+        KeepAlive(transforms.rotation_w[0]);
+    });
+    // every node dirty, as after the loop above
+    RunBenchmark(run, std::format("math/UpdateTransforms/{}_nodes", kTransformNodes), kTransformNodes, [&] {
+        for (TransformHandle node = 0; node < kTransformNodes; ++node) {
+            RotateModelInPlace(transforms, node, 0.01f, glm::vec3{0.0f, 1.0f, 0.0f});
+        }
+        UpdateTransforms(transforms, GetThreadPool());
+        KeepAlive(transforms.world[0]);
+    });
+
+    for (const auto cells : {64u, 256u, 1024u}) {
+        if (run.settings.quick && cells > 256) {
+            continue;
+        }
+        const auto name = std::format("math/CalculateVertexNormals/{}_triangles", 2 * cells * cells);
+        if (!BenchmarkSelected(run, name)) {
+            continue;
+        }
+        auto plane = CreateSubdividedPlane(cells);
+        RunBenchmark(run, name, plane.indices.size(), [&] {
+            CalculateVertexNormals(plane);
+            KeepAlive(plane.normals[0]);
+        });
+    }
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <format>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "DrawList.hpp"
+#include "FrustumCulling.hpp"
+#include "GeometryHeap.hpp"
+#include "LodSelection.hpp"
+#include "OcclusionCulling.hpp"
+#include "ProceduralScenes.hpp"
+#include "SceneMath.hpp"
+
+namespace {
+    // Everything Draw() touches on the CPU. The heap has no device: it only holds the allocation every object shares,
+    // which is all BuildDrawList() reads.
+    struct SceneFrame {
+        Scene scene;
+        GeometryHeap heap;
+        SceneBounds bounds;
+        OcclusionCuller occlusion = CreateOcclusionCuller();
+        LodSelector lods;
+        DrawList draws;
+        std::vector<std::byte> staging; // stands in for the upload ring
+        std::uint64_t frame = 0;
+        bool animate = true;
+    };
+
+    // Mean milliseconds per frame spent in each stage, over every timed and warmup frame.
+    struct StageTimes {
+        double animate = 0.0;
+        double transforms = 0.0;
+        double culling = 0.0;
+        double occlusion = 0.0;
+        double lods = 0.0;
+        double draw_list = 0.0;
+        double pack = 0.0;
+        std::uint64_t frames = 0;
+    };
+
+    SceneFrame PrepareSceneFrame(Scene scene, const bool animate = true) {
+        SceneFrame frame{.scene = std::move(scene), .animate = animate};
+        auto allocation = LayoutGeometry(frame.scene.Objects.front());
+        allocation.live = true;
+        frame.heap.allocations.push_back(allocation);
+        for (auto& obj : frame.scene.Objects) {
+            obj.geometry = 0;
+        }
+        return frame;
+    }
+
+    // Update() and Draw() without the GPU: a tenth of the objects turn each frame unless the scene is still, then
+    // transforms, frustum and occlusion culling, LOD selection and the draw list run as they do in the app under
+    // --occlusion, and the draw list is packed the way UploadDrawList() writes it into the ring. Everything parallel
+    // runs on `pool`.
+    void RunSceneFrame(SceneFrame& frame, StageTimes& times, ThreadPool& pool) {
+        // lambdas below capture these, which structured bindings cannot portably be
+        auto& Objects = frame.scene.Objects;
+        auto& Camera = frame.scene.Camera;
+        auto& Transforms = frame.scene.Transforms;
+        const auto stage = [](double& total, const std::function<void()>& work) {
+            const auto start = FrameClock::now();
+            work();
+            total += MillisecondsBetween(start, FrameClock::now());
+        };
+
+        stage(times.animate, [&] {
+            // every object turns its own node only
+            const auto first = frame.frame % 10;
+            const auto turning = frame.animate && Objects.size() > first ? (Objects.size() - first + 9) / 10 : 0;
+            pool.ParallelFor(turning, 4096, [&](const std::size_t begin, const std::size_t end, unsigned) {
+                for (auto i = begin; i < end; ++i) {
+                    RotateModelInPlace(Transforms, Objects[first + i * 10].transform, 0.01f,
+                                       glm::vec3{0.0f, 1.0f, 0.0f});
+                }
+            });
+        });
+        stage(times.transforms, [&] {
+            UpdateTransforms(Transforms, pool);
+            ApplyWorldTransforms(Transforms, Objects);
+        });
+        stage(times.culling, [&] {
+            UpdateSceneBounds(frame.bounds, Objects, pool);
+            CullScene(frame.bounds, ExtractFrustumPlanes(Camera.proj * Camera.view), pool);
+        });
+        stage(times.occlusion, [&] {
+            CullOccludedObjects(frame.occlusion, Objects, frame.bounds, Camera.proj * Camera.view, pool);
+        });
+        stage(times.lods, [&] { SelectLods(frame.lods, Objects, frame.bounds, Camera, pool); });
+        stage(times.draw_list, [&] {
+            BuildDrawList(frame.draws, frame.heap, Objects, frame.bounds.visible_objects, frame.lods.levels);
+        });
+        stage(times.pack, [&] {
+            const auto& draws = frame.draws;
+            const auto models = draws.models.size() * sizeof(glm::mat4);
+            const auto instances = draws.instances.size() * sizeof(std::uint32_t);
+            const auto commands = draws.commands.size() * sizeof(SDL_GPUIndexedIndirectDrawCommand);
+            frame.staging.resize(std::max(frame.staging.size(), models + instances + commands));
+            const auto staging = frame.staging.data();
+            PackDrawList(draws, {staging, staging + models, staging + models + instances}, pool);
+            KeepAlive(frame.staging[0]);
+        });
+        ++times.frames;
+        ++frame.frame;
+    }
+
+    void RunSceneBenchmark(BenchmarkRun& run, const std::string& name, const std::function<Scene()>& create,
+                           const bool animate = true) {
+        if (!BenchmarkSelected(run, name)) {
+            return;
+        }
+        const auto build_start = FrameClock::now();
+        auto frame = PrepareSceneFrame(create(), animate);
+        const auto build_ms = MillisecondsBetween(build_start, FrameClock::now());
+
+        StageTimes times{};
+        auto* result = RunBenchmark(run, name, frame.scene.Objects.size(),
+                                    [&] { RunSceneFrame(frame, times, GetThreadPool()); });
+        const auto frames = static_cast<double>(std::max<std::uint64_t>(times.frames, 1));
+        const auto& occlusion = frame.occlusion.total_stats;
+        const auto occlusion_tested = static_cast<double>(std::max<std::uint64_t>(occlusion.tested, 1));
+        std::uint64_t scene_triangles = 0;
+        for (const auto& obj : frame.scene.Objects) {
+            scene_triangles += obj.indices.size();
+        }
+        result->counters = {
+            {"build_ms", build_ms},
+            {"objects", static_cast<double>(frame.scene.Objects.size())},
+            {"scene_triangles", static_cast<double>(scene_triangles)},
+            {"visible_objects", static_cast<double>(frame.bounds.visible_objects.size())},
+            {"draw_commands", static_cast<double>(frame.draws.commands.size())},
+            {"triangles_drawn", static_cast<double>(CountDrawListTriangles(frame.draws))},
+            {"animate_ms", times.animate / frames},
+            {"transforms_ms", times.transforms / frames},
+            {"culling_ms", times.culling / frames},
+            {"occlusion_ms", times.occlusion / frames},
+            {"occluder_raster_ms", occlusion.raster_ms / frames},
+            {"occluders", static_cast<double>(occlusion.occluders) / frames},
+            {"occluded_percent", 100.0 * static_cast<double>(occlusion.culled) / occlusion_tested},
+            {"lods_ms", times.lods / frames},
+            {"draw_list_ms", times.draw_list / frames},
+            {"pack_ms", times.pack / frames},
+        };
+    }
+
+    // One scene on pools of 1, 2, 4, ... threads up to the machine's, each benchmark with its own pool; speedup and
+    // efficiency are against the 1-thread median.
+    void RunScalingBenchmarks(BenchmarkRun& run, const std::uint32_t cube_count) {
+        const auto hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> thread_counts;
+        for (unsigned threads = 1; threads < hardware_threads; threads *= 2) {
+            thread_counts.push_back(threads);
+        }
+        thread_counts.push_back(hardware_threads);
+
+        const auto name = [cube_count](const unsigned threads) {
+            return std::format("scaling/cubes_{}/threads_{}", cube_count, threads);
+        };
+        if (std::ranges::none_of(thread_counts, [&](const unsigned threads) {
+                return BenchmarkSelected(run, name(threads));
+            })) {
+            return;
+        }
+        auto frame = PrepareSceneFrame(CreateCubeFieldScene(cube_count));
+
+        double single_thread_ms = 0.0;
+        for (const auto threads : thread_counts) {
+            ThreadPool pool(threads);
+            StageTimes times{};
+            auto* result = RunBenchmark(run, name(threads), frame.scene.Objects.size(),
+                                        [&] { RunSceneFrame(frame, times, pool); });
+            if (result == nullptr) {
+                continue;
+            }
+            const auto median_ms = SummarizeTimings(result->sample_ms).median;
+            if (threads == 1) {
+                single_thread_ms = median_ms;
+            }
+            result->counters = {{"threads", static_cast<double>(threads)}};
+            if (single_thread_ms > 0.0 && median_ms > 0.0) {
+                const auto speedup = single_thread_ms / median_ms;
+                result->counters.emplace_back("speedup", speedup);
+                result->counters.emplace_back("efficiency", speedup / threads);
+            }
+        }
+    }
+}
+
+// End-to-end CPU frame cost of generated scenes; items are scene objects, so ns/item is the cost per object.
+void RunSceneBenchmarks(BenchmarkRun& run) {
+    const auto cube_counts = run.settings.quick ? std::vector<std::uint32_t>{1000}
+                                                : std::vector<std::uint32_t>{1000, 10000, 100000};
+    for (const auto count : cube_counts) {
+        RunSceneBenchmark(run, std::format("scene/cubes_{}", count), [count] { return CreateCubeFieldScene(count); });
+    }
+
+    // planes_COUNTxCELLS: about 130k triangles in many small objects, then 2M in a few large ones
+    const auto plane_fields = run.settings.quick ? std::vector<std::pair<std::uint32_t, std::uint32_t>>{{16, 32}}
+                                                 : std::vector<std::pair<std::uint32_t, std::uint32_t>>{{64, 32},
+                                                                                                       {8, 362}};
+    for (const auto [count, cells] : plane_fields) {
+        RunSceneBenchmark(run, std::format("scene/planes_{}x{}", count, cells),
+                          [count, cells] { return CreatePlaneFieldScene(count, cells); });
+    }
+
+    // interior_ROOMS: rooms walled off from each other, where occlusion culling does most of the work; the scene
+    // stays still so the walls keep standing
+    const auto room_counts = run.settings.quick ? std::vector<std::uint32_t>{32} : std::vector<std::uint32_t>{32, 256};
+    for (const auto rooms : room_counts) {
+        RunSceneBenchmark(run, std::format("scene/interior_{}", rooms), [rooms] { return CreateInteriorScene(rooms); },
+                          false);
+    }
+
+    RunScalingBenchmarks(run, run.settings.quick ? 10000 : 100000);
+}
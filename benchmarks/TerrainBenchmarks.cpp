@@ -0,0 +1,14 @@
+#include <cstdint>
+#include <format>
+
+#include "Benchmark.hpp"
+#include "Terrain.hpp"
+
+void RunTerrainBenchmarks(BenchmarkRun& run) {
+    // what one terrain worker does per chunk; items are the chunk's vertices, skirts included
+    const TerrainSettings terrain{};
+    const auto chunk_vertices = std::uint64_t{terrain.chunk_cells + 1} * (terrain.chunk_cells + 5);
+    RunBenchmark(run, std::format("terrain/CreateTerrainChunk/{}_cells", terrain.chunk_cells), chunk_vertices, [&] {
+        KeepAlive(CreateTerrainChunk(terrain, {3, -2}).local_sphere);
+    });
+}
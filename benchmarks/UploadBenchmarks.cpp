@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "GeometryHeap.hpp"
+#include "ProceduralScenes.hpp"
+#include "VertexQuantization.hpp"
+
+namespace {
+    // A heap's bookkeeping with no GPU buffers behind it: `count` objects of assorted sizes allocated back to back,
+    // then every third one freed, which strands about a third of each pool in holes.
+    GeometryHeap CreateFragmentedHeap(const std::uint32_t count) {
+        GeometryHeap heap{};
+        std::vector<std::uint32_t> vertex_counts(count);
+        std::uint32_t total = 0;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            vertex_counts[i] = 64 + i * 37 % 512;
+            total += vertex_counts[i];
+        }
+        for (auto [allocator, capacity] : {std::pair{&heap.vertices, total}, std::pair{&heap.indices16, total * 3}}) {
+            allocator->capacity = capacity;
+            allocator->free_ranges.push_back(GeometryRange{0, capacity});
+        }
+        for (const auto vertex_count : vertex_counts) {
+            auto& allocation = heap.allocations.emplace_back();
+            allocation.vertices = GeometryRange{*AllocateRange(heap.vertices, vertex_count), vertex_count};
+            allocation.indices = GeometryRange{*AllocateRange(heap.indices16, vertex_count * 3), vertex_count * 3};
+            allocation.live = true;
+        }
+        for (std::uint32_t i = 0; i < count; i += 3) {
+            auto& allocation = heap.allocations[i];
+            FreeRange(heap.vertices, allocation.vertices);
+            FreeRange(heap.indices16, allocation.indices);
+            allocation = GeometryAllocation{};
+        }
+        return heap;
+    }
+}
+
+// The CPU side of getting a mesh into the geometry heap: what UploadGeometry() and UploadQuantizedGeometry() write
+// into the upload ring, packed here into plain memory instead.
+void RunUploadBenchmarks(BenchmarkRun& run) {
+    // 128 cells stays within 16-bit indices, 1024 needs 32-bit ones
+    for (const auto cells : {128u, 1024u}) {
+        if (run.settings.quick && cells > 128) {
+            continue;
+        }
+        const auto plane = CreateSubdividedPlane(cells);
+        const auto vertex_count = plane.vertices.size();
+        const auto layout = LayoutGeometry(plane);
+        const auto wide = layout.index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT;
+        std::vector<std::byte> staging(std::max<std::size_t>(
+            vertex_count * (sizeof(PositionAndColorVertex) + sizeof(VertexNormal)),
+            std::size_t{layout.indices.count} * (wide ? 4 : 2)));
+
+        RunBenchmark(run, std::format("upload/PackIndices/{}bit_{}_indices", wide ? 32 : 16, layout.indices.count),
+                     layout.indices.count, [&] {
+                         PackIndices(staging.data(), layout, plane);
+                         KeepAlive(staging[0]);
+                     });
+        RunBenchmark(run, std::format("upload/CopyFloatVertices/{}_vertices", vertex_count), vertex_count, [&] {
+            const auto vertex_bytes = vertex_count * sizeof(PositionAndColorVertex);
+            std::memcpy(staging.data(), plane.vertices.data(), vertex_bytes);
+            std::memcpy(staging.data() + vertex_bytes, plane.normals.data(), vertex_count * sizeof(VertexNormal));
+            KeepAlive(staging[0]);
+        });
+        RunBenchmark(run, std::format("upload/QuantizeMesh/{}_vertices", vertex_count), vertex_count, [&] {
+            const auto mesh = QuantizeMesh(plane);
+            KeepAlive(mesh.vertices[0]);
+        });
+    }
+
+    // compaction's bookkeeping: deciding every move and rewriting the ranges; each sample first restores the
+    // fragmented state, which is a plain copy into vectors that already have the room
+    const auto object_count = run.settings.quick ? 512u : 8192u;
+    const auto fragmented = CreateFragmentedHeap(object_count);
+    auto heap = fragmented;
+    auto* result = RunBenchmark(run, std::format("upload/PackGeometryHeap/{}_objects", object_count), object_count, [&] {
+        heap.allocations = fragmented.allocations;
+        heap.vertices = fragmented.vertices;
+        heap.indices16 = fragmented.indices16;
+        PackGeometryHeap(heap);
+        KeepAlive(heap.compaction.vertices.back());
+    });
+    if (result != nullptr) {
+        const auto moves = heap.compaction.vertices.size() + heap.compaction.indices16.size();
+        result->counters = {{"fragmentation", GeometryHeapFragmentation(fragmented)},
+                            {"moves", static_cast<double>(moves)}};
+    }
+}
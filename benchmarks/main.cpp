@@ -0,0 +1,68 @@
+#include <exception>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Benchmark.hpp"
+
+// CPU benchmarks for the math hot paths, upload packing, whole frames of generated scenes, terrain chunk generation
+// and light binning. Nothing here needs a GPU or a window.
+//
+// Command line: --filter TEXT runs only benchmarks whose name contains TEXT, --json PATH writes the results as JSON
+// and --label TEXT stores TEXT (a commit hash, say) in it, --quick runs smaller scenes for fewer samples
+struct BenchmarkOptions {
+    BenchmarkSettings settings;
+    std::string json_path;
+    std::string label;
+};
+
+auto ParseBenchmarkOptions(int argc, char** argv) {
+    BenchmarkOptions options{};
+    for (auto i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.settings.filter = argv[++i];
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        }
+        else if (arg == "--label" && i + 1 < argc) {
+            options.label = argv[++i];
+        }
+        else if (arg == "--quick") {
+            options.settings.quick = true;
+            options.settings.warmup_samples = 1;
+            options.settings.min_samples = 3;
+            options.settings.min_time_ms = 20.0;
+        }
+        else {
+            throw std::invalid_argument(std::format("unknown argument: {}", arg));
+        }
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    try {
+        const auto options = ParseBenchmarkOptions(argc, argv);
+        BenchmarkRun run{.settings = options.settings};
+        RunMathBenchmarks(run);
+        RunUploadBenchmarks(run);
+        RunSceneBenchmarks(run);
+        RunTerrainBenchmarks(run);
+        RunLightingBenchmarks(run);
+
+        PrintBenchmarkReport(run);
+        if (!options.json_path.empty()) {
+            WriteBenchmarkJson(run, options.json_path, options.label);
+            std::cout << std::format("Results written to {}\n", options.json_path);
+        }
+        return 0;
+    }
+    catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts calls to the global operator new, from every thread, to check that steady-state frames stay off the heap.
+// Builds with the profiler (TBDGAME_PROFILER) replace operator new and delete with versions over malloc that bump
+// one relaxed atomic; without it nothing is replaced and the count stays 0.
+struct AllocationStats {
+    std::uint64_t frames = 0;            // checked, past the warm-up
+    std::uint64_t allocating_frames = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t worst_frame = 0; // most allocations in one frame
+};
+
+constexpr bool AllocationCountingBuiltIn() {
+#ifdef TBDGAME_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+// Allocations since the program started.
+std::uint64_t CountedAllocations();
+void RecordFrameAllocations(AllocationStats& stats, std::uint64_t allocations);
+void PrintAllocationReport(const AllocationStats& stats, std::size_t warmup_frames);
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "UploadRing.hpp"
+
+// Clustered forward lighting. The view frustum is cut into froxels: tiles_x by tiles_y screen tiles, each split into
+// depth_slices slices whose view depths grow geometrically from near_depth to far_depth, so froxels stay roughly
+// cube-shaped. Every frame BuildLightClusters() moves the lights into view space and gives each froxel the lights
+// whose sphere of influence touches its view-space box, one depth slice per job. The lists go up compacted, as
+// fragment storage buffers: the view-space lights, one (offset, count) pair per froxel, and the light indices those
+// pairs point into. The ClusteredLighting fragment shader finds its froxel from the pixel position and view depth
+// and shades only that froxel's lights.
+//
+// Froxel boxes assume a symmetric perspective projection with w = -view z, which is what Project() builds. The first
+// slice reaches back to the eye and fragments past far_depth use the last slice, so lights only reach them as far
+// as that slice's box does.
+struct ClusterSettings {
+    std::uint32_t tiles_x = 16;
+    std::uint32_t tiles_y = 9;
+    std::uint32_t depth_slices = 24;
+    float near_depth = 0.25f;
+    float far_depth = 64.0f;
+    glm::vec3 ambient{0.04f};
+};
+struct PointLight {
+    glm::vec3 position{}; // world space
+    float radius = 1.0f;  // the light falls off to nothing here
+    glm::vec3 color{1.0f};
+    float intensity = 1.0f;
+};
+// A light as the shader reads it.
+struct GpuPointLight {
+    glm::vec4 position_radius; // view space
+    glm::vec4 color_intensity;
+};
+// Pushed as the scene pass's fragment uniforms.
+struct ClusterUniformData {
+    glm::vec2 viewport_size; // pixels
+    float depth_scale;       // slice = log(view depth) * depth_scale + depth_bias
+    float depth_bias;
+    glm::uvec4 counts; // tiles_x, tiles_y, depth_slices, lights
+    glm::vec4 ambient;
+};
+struct ClusterStats {
+    double build_ms = 0.0;
+    std::uint64_t froxels = 0;
+    std::uint64_t lights = 0;      // in at least one froxel
+    std::uint64_t assignments = 0; // froxel-light pairs
+    std::uint64_t occupied = 0;    // froxels with at least one light
+    std::uint32_t max_lights = 0;  // in one froxel
+};
+// Lights scattered over a square of side `extent` around the origin, each circling the y axis at its own rate.
+struct LightField {
+    std::vector<PointLight> lights;
+    std::vector<float> orbit_rates; // radians per second, per light
+};
+struct LightClusters {
+    ClusterSettings settings;
+    SDL_GPUDevice* device = nullptr;
+
+    std::vector<GpuPointLight> lights;     // view space, in scene order
+    std::vector<glm::uvec2> ranges;        // per froxel: offset and count into light_indices
+    std::vector<std::uint32_t> light_indices;
+    ClusterUniformData uniforms{};
+
+    // froxel boxes in view space, rebuilt when the projection or the settings change
+    std::vector<glm::vec3> box_min;
+    std::vector<glm::vec3> box_max;
+    glm::vec2 box_focal{0.0f}; // proj[0][0] and proj[1][1] the boxes were built for
+
+    // scratch
+    std::vector<glm::uvec4> light_tiles;  // per light: first and last tile in x and y
+    std::vector<glm::uvec2> light_slices; // per light: first and last slice; first > last when it reaches none
+    std::vector<std::vector<std::uint32_t>> froxel_lights;
+
+    SDL_GPUBuffer* light_buffer = nullptr;
+    SDL_GPUBuffer* range_buffer = nullptr;
+    SDL_GPUBuffer* index_buffer = nullptr;
+    std::uint32_t light_capacity = 0; // capacities in elements
+    std::uint32_t range_capacity = 0;
+    std::uint32_t index_capacity = 0;
+
+    ClusterStats frame_stats;
+    ClusterStats total_stats;
+};
+
+inline constexpr float kLightFieldExtent = 8.0f; // the test scene's lights scatter over a square this wide around it
+inline constexpr float kLightRadius = 1.5f;
+
+LightField CreateLightField(std::uint32_t count, float extent, float radius, std::uint32_t seed = 1);
+void OrbitLights(LightField& field, float dt);
+
+LightClusters CreateLightClusters(SDL_GPUDevice* device, const ClusterSettings& settings = {});
+void DestroyLightClusters(LightClusters& clusters);
+// `proj` is the projection the frame is drawn with, viewport_size the backbuffer's in pixels.
+void BuildLightClusters(LightClusters& clusters, const std::vector<PointLight>& lights, const glm::mat4& view,
+                        const glm::mat4& proj, glm::vec2 viewport_size, ThreadPool& pool);
+// Streams the lights, ranges and indices through the ring, cycling the buffers, which grow as needed.
+void UploadLightClusters(LightClusters& clusters, UploadRing& ring);
+// Binds the three buffers as fragment storage buffers 0..2 and pushes the uniforms to fragment slot 0.
+void BindLightClusters(SDL_GPURenderPass* pass, SDL_GPUCommandBuffer* cmdbuf, const LightClusters& clusters);
+void PrintClusterReport(const ClusterStats& stats, std::size_t frame_count);
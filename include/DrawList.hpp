@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GeometryHeap.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "UploadRing.hpp"
+
+// Turns the scene's objects into as few indirect draws as the geometry heap allows. Objects sharing a GeometryHandle
+// and LOD level collapse into one instanced command, and commands are grouped by index width so each group goes out
+// as a single SDL_DrawGPUIndexedPrimitivesIndirect() with draw_count > 1 (at most two calls: 16- and 32-bit indices).
+// Each instance carries its object's index as a per-instance vertex attribute, which the vertex shader uses to fetch
+// the model matrix from a storage buffer.
+struct DrawBatch {
+    SDL_GPUIndexElementSize index_size;
+    std::uint32_t first_command;
+    std::uint32_t command_count;
+};
+struct DrawList {
+    std::vector<glm::mat4> models;        // one per scene object, visible or not
+    std::vector<std::uint32_t> instances; // object index per instance, in command order
+    std::vector<SDL_GPUIndexedIndirectDrawCommand> commands;
+    std::vector<DrawBatch> batches;
+    std::vector<std::uint32_t> order; // scratch
+};
+struct DrawBuffers {
+    SDL_GPUDevice* device = nullptr;
+    SDL_GPUBuffer* models = nullptr;    // vertex storage buffer
+    SDL_GPUBuffer* instances = nullptr; // per-instance vertex buffer, bound at slot kInstanceBufferSlot
+    SDL_GPUBuffer* commands = nullptr;  // SDL_GPUIndexedIndirectDrawCommands
+    std::uint32_t model_capacity = 0;   // capacities in elements
+    std::uint32_t instance_capacity = 0;
+    std::uint32_t command_capacity = 0;
+};
+
+inline constexpr std::uint32_t kInstanceBufferSlot = 2;
+
+DrawBuffers CreateDrawBuffers(SDL_GPUDevice* device, std::uint32_t object_capacity);
+void DestroyDrawBuffers(DrawBuffers& buffers);
+
+// Draws objects[visible_objects[...]] at the level object_lods gives each of them (level 0 past its end); objects
+// without uploaded geometry are skipped.
+void BuildDrawList(DrawList& list, const GeometryHeap& heap, const std::vector<RenderableObject>& objects,
+                   const std::vector<std::uint32_t>& visible_objects, const std::vector<std::uint8_t>& object_lods);
+// Copies models, instances and commands to the three targets (each null or large enough for its array) in blocks
+// spread across the pool; small lists are copied on the calling thread.
+void PackDrawList(const DrawList& list, const std::array<std::byte*, 3>& targets, ThreadPool& pool);
+// Streams the list through the ring, packed by PackDrawList(); the buffers are rewritten whole every frame, so they
+// are cycled, and replaced outright when they need to grow.
+void UploadDrawList(DrawBuffers& buffers, UploadRing& ring, const DrawList& list, ThreadPool& pool);
+// Expects the pipeline and the geometry heap's vertex buffers to be bound already.
+void RecordDrawList(SDL_GPURenderPass* pass, const DrawBuffers& buffers, const DrawList& list,
+                    const GeometryHeap& heap);
+// Triangles the list draws, over all instances.
+std::uint64_t CountDrawListTriangles(const DrawList& list);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Frame-scoped linear allocation. A LinearArena hands out memory by bumping an offset into one buffer and frees it
+// all at once in Reset(); deallocate() does nothing. It is a std::pmr::memory_resource, so std::pmr containers can
+// build their per-frame contents in it. Allocations that do not fit spill to the heap and are freed by the next
+// Reset(), which first grows the buffer to cover everything the arena handed out, so a frame that repeats spills once.
+//
+// A FrameArena cycles kFrameArenaCount arenas: BeginArenaFrame() resets the oldest and makes it the frame's, so what
+// a frame allocates stays valid until the end of the frame after it, for data still referenced when the next frame
+// replaces it.
+class LinearArena final : public std::pmr::memory_resource {
+public:
+    LinearArena();
+    explicit LinearArena(std::size_t capacity);
+    ~LinearArena() override;
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void Reset();
+    // Bytes handed out since the last Reset(), alignment padding and spills included.
+    std::size_t Used() const {
+        return offset + spilled;
+    }
+    std::size_t Capacity() const {
+        return capacity;
+    }
+    std::size_t Spilled() const {
+        return spilled;
+    }
+
+private:
+    struct Spill {
+        void* memory;
+        std::size_t bytes;
+        std::size_t alignment;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::unique_ptr<std::byte[]> buffer;
+    std::size_t capacity = 0;
+    std::size_t offset = 0;
+    std::size_t spilled = 0;
+    std::vector<Spill> spills;
+};
+
+inline constexpr std::size_t kFrameArenaCount = 2;
+inline constexpr std::size_t kFrameArenaInitialBytes = 64 * 1024;
+
+struct FrameArenaStats {
+    std::uint64_t frames = 0;
+    std::uint64_t bytes = 0;          // handed out, summed over frames
+    std::uint64_t high_water = 0;     // most bytes one frame used
+    std::uint64_t spilled_frames = 0; // frames that outgrew their arena
+};
+struct FrameArena {
+    std::array<LinearArena, kFrameArenaCount> arenas;
+    std::size_t current = 0;
+
+    FrameArenaStats frame_stats; // of the last EndArenaFrame()
+    FrameArenaStats total_stats;
+};
+
+// Resets the oldest arena and returns it for this frame's allocations.
+std::pmr::memory_resource& BeginArenaFrame(FrameArena& arena);
+void EndArenaFrame(FrameArena& arena);
+void PrintFrameArenaReport(const FrameArenaStats& stats);
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RenderGraph.hpp"
+
+// Captures rendered frames to disk without stalling the frame loop. After a frame is submitted, CaptureFrame()
+// downloads its color texture into one of a ring of download transfer buffers, in a command buffer of its own so
+// the download has its own fence. Poll() takes the readbacks whose fences have signalled, a frame or two later,
+// copies the pixels out and hands them to an encoder thread, which writes each frame as a PNG or appends it to a raw
+// RGBA video stream (ffmpeg reads it with -f rawvideo -pixel_format rgba -video_size WxH).
+//
+// Nothing waits: a frame is dropped when every readback slot is still on the GPU, or when the encoder already has
+// max_queued frames waiting. Both are counted, as are readbacks that finished more than kCaptureLateFrames frames
+// after they were drawn. PNGs are written with uncompressed deflate blocks, so encoding costs about a copy.
+enum class CaptureFormat {
+    Png,      // `output` is a directory of frame_NNNNN.png, numbered by frame
+    RawVideo, // `output` is one file of RGBA frames back to back
+};
+struct CaptureSettings {
+    std::filesystem::path output;
+    CaptureFormat format = CaptureFormat::Png;
+    std::uint32_t interval = 1;   // captures every Nth frame
+    std::uint32_t ring_size = 4;  // readbacks in flight at once
+    std::uint32_t max_queued = 8; // frames copied out and waiting for the encoder
+};
+struct CaptureStats {
+    std::uint64_t requested = 0; // frames the interval picked
+    std::uint64_t captured = 0;  // downloads recorded
+    std::uint64_t written = 0;
+    std::uint64_t dropped_busy = 0;    // every readback slot still on the GPU
+    std::uint64_t dropped_backlog = 0; // the encoder was max_queued frames behind
+    std::uint64_t dropped_resized = 0; // raw video frames not at the first frame's size
+    std::uint64_t late = 0;
+    std::uint64_t max_latency_frames = 0; // drawn -> taken by Poll()
+    std::uint64_t bytes_written = 0;
+    std::uint32_t video_width = 0; // raw video frame size, set by the first frame written; what -video_size needs
+    std::uint32_t video_height = 0;
+    double render_thread_ms = 0.0; // in CaptureFrame() and Poll()
+    double encode_ms = 0.0;        // on the encoder thread
+};
+
+inline constexpr std::uint64_t kCaptureLateFrames = 2;
+
+class FrameCapture {
+public:
+    // Creates the PNG directory or opens the video file; throws std::runtime_error if it cannot.
+    FrameCapture(SDL_GPUDevice* device, const CaptureSettings& settings);
+    ~FrameCapture();
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Main thread, once per frame, after the frame's command buffer is submitted and before the graph is reset.
+    // `source` must be an 8-bit RGBA or BGRA texture the GPU can copy from, which rules out swapchain images.
+    void CaptureFrame(const RenderGraph& graph, RenderResource source);
+    // Main thread, once per frame. Rethrows, as std::runtime_error, a write the encoder failed.
+    void Poll();
+    // Main thread. Waits for the readbacks still on the GPU and for the encoder to write everything queued, so the
+    // stats count every frame; the destructor does the same.
+    void Flush();
+    // Main thread.
+    CaptureStats Stats();
+
+private:
+    struct Readback {
+        SDL_GPUTransferBuffer* buffer = nullptr;
+        std::uint32_t capacity = 0;
+        SDL_GPUFence* fence = nullptr; // null when the slot is free
+        std::uint64_t frame = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        bool bgra = false;
+    };
+    struct CapturedFrame {
+        std::uint64_t frame = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        bool bgra = false;
+        std::vector<std::uint8_t> pixels; // as downloaded, rows top first
+    };
+
+    // Copies a signalled readback out to a free CapturedFrame and queues it, or drops it if none is free and
+    // `wait_for_encoder` is not set.
+    void TakeReadback(Readback& readback, bool wait_for_encoder);
+    // The oldest readback still on the GPU, or null.
+    Readback* OldestReadback();
+    void EncoderLoop();
+    // Returns the bytes written, 0 for a dropped frame.
+    std::uint64_t Encode(const CapturedFrame& frame);
+
+    SDL_GPUDevice* device;
+    CaptureSettings settings;
+
+    // main thread only
+    std::vector<Readback> readbacks;
+    std::uint64_t frame = 0;
+    CaptureStats stats;
+
+    // encoder thread only, once started
+    std::ofstream video;
+    std::uint32_t video_width = 0; // set under `mutex`, since Stats() reads it
+    std::uint32_t video_height = 0;
+    std::vector<std::uint8_t> scanlines;
+    std::vector<std::uint8_t> encoded;
+
+    std::mutex mutex;
+    std::condition_variable wake; // a frame queued or written, or stopping
+    std::vector<CapturedFrame> frames;
+    std::vector<std::uint32_t> free_frames;
+    std::vector<std::uint32_t> queue; // oldest first
+    std::uint64_t written = 0;        // the encoder's part of the stats
+    std::uint64_t dropped_resized = 0;
+    std::uint64_t bytes_written = 0;
+    double encode_ms = 0.0;
+    std::exception_ptr error; // the first failed write, for Poll() to rethrow
+    bool stopping = false;
+    std::thread encoder; // last, so everything above exists before it starts
+};
+
+void PrintCaptureReport(const CaptureStats& stats, std::size_t frame_count);
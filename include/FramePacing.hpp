@@ -0,0 +1,75 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FrameStats.hpp"
+#include "UploadRing.hpp"
+
+// How far the CPU runs ahead of the GPU, and how frames reach the screen. BeginPacedFrame() runs before the frame's
+// input is read and waits, on the fences the upload ring keeps, until fewer than frames_in_flight earlier frames are
+// still on the GPU. EndPacedFrame() runs once the frame is retired to the ring. Input latency is measured from
+// MarkInputSampled() to the first time a later Begin or End call sees the frame's fence signalled. SDL has no
+// present timestamps, so GPU completion stands in for the present, and the figure is only as fine as the frame rate.
+//
+// Throttled waits for a swapchain image as it always has. Uncapped takes one only if it is ready and skips drawing
+// the frame otherwise, and benchmark runs stop waiting on every frame's fence, so the run measures throughput.
+// LowLatency waits for every earlier frame to finish before reading input, so the frame is built from the newest
+// input there is, at the cost of the CPU and GPU no longer overlapping.
+enum class PresentMode {
+    Vsync,
+    Mailbox,   // vsync without blocking: newer frames replace queued ones
+    Immediate, // may tear
+};
+enum class PacingMode {
+    Throttled,
+    Uncapped,
+    LowLatency,
+};
+struct FramePacingSettings {
+    PresentMode present_mode = PresentMode::Vsync;
+    PacingMode mode = PacingMode::Throttled;
+    std::uint32_t frames_in_flight = 2;
+};
+struct FramePacingStats {
+    std::uint64_t frames = 0;
+    std::uint64_t skipped = 0; // no swapchain image was ready
+    double wait_ms = 0.0;      // in BeginPacedFrame(), waiting on earlier frames
+};
+// A frame retired to the upload ring whose fence has not been seen to signal.
+struct PacedFrame {
+    FrameClock::time_point input_time;
+    bool presented;
+};
+struct FramePacer {
+    FramePacingSettings settings;
+    std::vector<PacedFrame> in_flight; // oldest first, in step with the upload ring's
+    FrameClock::time_point input_time;
+    FrameClock::time_point first_frame;
+    FrameClock::time_point last_frame;
+
+    std::vector<double> latency_ms; // input -> GPU complete, per presented frame; kept only for benchmark runs
+    bool record_latency = false;
+
+    FramePacingStats total_stats;
+};
+
+// SDL lets a device have at most this many frames in flight.
+inline constexpr std::uint32_t kMaxFramesInFlight = 3;
+
+// LowLatency always runs one frame in flight.
+std::uint32_t FramesInFlight(const FramePacingSettings& settings);
+// `frame_limit` reserves room for that many latency samples; 0 keeps none.
+FramePacer CreateFramePacer(const FramePacingSettings& settings, std::size_t frame_limit);
+// Sets the window's present mode and the device's frames in flight. Throws std::runtime_error if the window cannot
+// present in that mode.
+void ApplyFramePacing(SDL_GPUDevice* device, SDL_Window* window, const FramePacingSettings& settings);
+void BeginPacedFrame(FramePacer& pacer, UploadRing& uploads);
+void MarkInputSampled(FramePacer& pacer);
+// After RetireUploadRingFrame(); `presented` is false for frames that drew nothing.
+void EndPacedFrame(FramePacer& pacer, UploadRing& uploads, bool presented);
+const char* PresentModeName(PresentMode mode);
+const char* PacingModeName(PacingMode mode);
+void PrintFramePacingReport(const FramePacer& pacer);
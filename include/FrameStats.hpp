@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+// Per-frame timings collected by a benchmark run, in milliseconds.
+struct FrameTimings {
+    std::vector<double> cpu_ms;    // frame start -> command buffer submitted
+    std::vector<double> submit_ms; // command buffer submitted -> GPU fence signalled
+};
+struct TimingSummary {
+    double min = 0.0;
+    double median = 0.0;
+    double p99 = 0.0;
+};
+
+// A uniform random sample of at most `capacity` timings from a stream of any length (reservoir sampling), so a long
+// run summarizes in fixed memory. AddTimingSample() never allocates once the reservoir is created.
+struct TimingReservoir {
+    std::vector<double> samples;
+    std::size_t capacity = 0;
+    std::uint64_t seen = 0;
+    std::minstd_rand random;
+};
+
+using FrameClock = std::chrono::steady_clock;
+
+double MillisecondsBetween(FrameClock::time_point start, FrameClock::time_point end);
+TimingSummary SummarizeTimings(std::vector<double> samples);
+TimingReservoir CreateTimingReservoir(std::size_t capacity);
+void AddTimingSample(TimingReservoir& reservoir, double sample);
+void PrintFrameTimingReport(const FrameTimings& timings);
+// One `frame,cpu_ms,submit_ms` row per frame, for comparing runs frame by frame. Throws std::runtime_error if the file
+// cannot be written.
+void WriteFrameTimingsCsv(const FrameTimings& timings, const std::filesystem::path& path);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+// World-space bounds for every scene object, kept as flat SoA arrays so the culling loop streams through them, and
+// the per-frame result: a flag per object plus the compacted list of visible object indices in scene order.
+struct FrustumPlanes {
+    glm::vec4 planes[5]; // xyz = inward unit normal, w = distance; inside when dot(xyz, p) + w >= 0
+};
+struct CullingStats {
+    std::uint64_t visible = 0;
+    std::uint64_t culled = 0;
+};
+struct SceneBounds {
+    std::vector<float> center_x, center_y, center_z; // world AABB centers
+    std::vector<float> extent_x, extent_y, extent_z; // world AABB half sizes
+    std::vector<float> sphere_x, sphere_y, sphere_z, sphere_radius;
+
+    std::vector<std::uint8_t> visible;          // per object
+    std::vector<std::uint32_t> visible_objects; // compacted, ascending
+
+    CullingStats frame_stats;
+    CullingStats total_stats;
+};
+
+void UpdateLocalBounds(RenderableObject& obj);
+
+// Gribb-Hartmann extraction of the left, right, bottom and top planes plus w >= 0 (in front of the eye). There is
+// no far plane to test: the scene pipeline clamps depth instead of clipping it.
+FrustumPlanes ExtractFrustumPlanes(const glm::mat4& view_proj);
+
+// Transforms each object's local bounds by its model matrix into the SoA arrays.
+void UpdateSceneBounds(SceneBounds& bounds, const std::vector<RenderableObject>& objects, ThreadPool& pool);
+// Tests every object's sphere and box against the planes in parallel, then compacts the visible indices.
+void CullScene(SceneBounds& bounds, const FrustumPlanes& frustum, ThreadPool& pool);
+void PrintCullingReport(const CullingStats& stats, std::size_t frame_count);
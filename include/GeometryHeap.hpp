@@ -0,0 +1,126 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "MeshFile.hpp"
+#include "Scene.hpp"
+#include "UploadRing.hpp"
+#include "VertexQuantization.hpp"
+
+// Sub-allocates vertex and index ranges for every RenderableObject out of a few large GPU buffers. Vertex positions
+// and normals share one element range (VertexBuf and NormalBuf are indexed alike). Indices live in a 16-bit pool
+// unless an object has more vertices than a 16-bit index can reach, in which case it gets 32-bit indices. An object's
+// LOD levels share its vertex range and are stored back to back in its index range, full mesh first. Objects with
+// identical topology (terrain chunks, say) can instead borrow every index level of one index pattern allocation and
+// own only their vertices.
+// Buffers grow by reallocating and copying on the GPU; CompactGeometryHeap() closes the holes left by freed objects,
+// and the frame loop calls it once GeometryHeapFragmentation() says enough of a pool is stranded in them.
+inline constexpr std::uint32_t kMax16BitVertices = 0x10000; // objects with more vertices get 32-bit indices
+
+struct GeometryRange {
+    std::uint32_t offset = 0; // in elements
+    std::uint32_t count = 0;
+};
+struct RangeAllocator {
+    std::uint32_t capacity = 0;
+    std::uint32_t used = 0;
+    std::vector<GeometryRange> free_ranges; // sorted by offset, adjacent ranges coalesced
+};
+// One copy a compaction records, in elements of its pool: live ranges that were already back to back move as one.
+struct GeometryMove {
+    std::uint32_t source = 0;
+    std::uint32_t destination = 0;
+    std::uint32_t count = 0;
+};
+struct GeometryCompaction {
+    std::vector<GeometryMove> vertices;
+    std::vector<GeometryMove> indices16;
+    std::vector<GeometryMove> indices32;
+    std::vector<GeometryRange*> ranges; // scratch: one pool's live ranges, sorted by offset
+};
+struct GeometryAllocation {
+    GeometryRange vertices;
+    GeometryRange indices;                           // every level
+    std::array<GeometryRange, kMaxLodLevels> lods{}; // offsets relative to indices.offset
+    std::uint32_t lod_count = 1;
+    SDL_GPUIndexElementSize index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    GeometryHandle index_pattern = kNoGeometry; // indices and levels borrowed from this allocation, if set
+    bool live = false;
+};
+struct GeometryHeap {
+    SDL_GPUDevice* device = nullptr;
+    VertexFormat format = VertexFormat::Float;
+    std::uint32_t vertex_stride = 0; // bytes per element in vertex_buffer / normal_buffer
+    std::uint32_t normal_stride = 0;
+    SDL_GPUBuffer* vertex_buffer = nullptr;
+    SDL_GPUBuffer* normal_buffer = nullptr;
+    SDL_GPUBuffer* index16_buffer = nullptr;
+    SDL_GPUBuffer* index32_buffer = nullptr;
+
+    RangeAllocator vertices;
+    RangeAllocator indices16;
+    RangeAllocator indices32;
+
+    std::vector<GeometryAllocation> allocations; // indexed by GeometryHandle
+    std::vector<GeometryHandle> free_handles;
+
+    GeometryCompaction compaction; // the last compaction's moves, kept so later ones reuse the memory
+    std::uint64_t compactions = 0;
+};
+
+std::optional<std::uint32_t> AllocateRange(RangeAllocator& allocator, std::uint32_t count);
+void FreeRange(RangeAllocator& allocator, GeometryRange range);
+// The share of the pool's capacity that is free but outside its largest free range: 0 when the free space is one
+// block, and the part of it only smaller allocations can use otherwise.
+float RangeFragmentation(const RangeAllocator& allocator);
+
+GeometryHeap CreateGeometryHeap(SDL_GPUDevice* device, std::uint32_t vertex_capacity, std::uint32_t index_capacity,
+                                VertexFormat format = VertexFormat::Float);
+void DestroyGeometryHeap(GeometryHeap& heap);
+
+// The ranges an upload of obj takes, before they are placed in the heap: its vertex and index counts at offset 0,
+// the index size its vertex count needs, and every LOD level back to back (obj.indices first).
+GeometryAllocation LayoutGeometry(const RenderableObject& obj);
+// Writes every level of obj's indices into destination as layout.index_size elements; layout.indices.count of them.
+void PackIndices(void* destination, const GeometryAllocation& layout, const RenderableObject& obj);
+
+// Writes the object's data into the upload ring and records any buffer growth into cmdbuf; the data reaches the GPU
+// when the ring is next flushed into the same command buffer. obj.indices and obj.lods are written as 16- or 32-bit
+// as needed.
+// Float heaps only.
+GeometryHandle UploadGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                              const RenderableObject& obj);
+// For VertexFormat::Quantized heaps: the vertex streams come from `mesh`, the indices and LOD levels from obj.
+GeometryHandle UploadQuantizedGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                       const RenderableObject& obj, const QuantizedMesh& mesh);
+// Float heaps only, straight from a mapped mesh file: each section is copied once, from the mapping into the ring,
+// and the mesh may be unmapped as soon as this returns.
+GeometryHandle UploadMappedMesh(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                const MappedMesh& mesh);
+// Indices only: every level of pattern's indices, sized for pattern.vertices.size() vertices, for
+// UploadPatternGeometry() to share.
+GeometryHandle UploadIndexPattern(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                  const RenderableObject& pattern);
+// Vertices only: draws use the index levels of `pattern`, which must stay live as long as this geometry. On
+// VertexFormat::Quantized heaps the vertex streams come from `mesh`, which is ignored otherwise.
+GeometryHandle UploadPatternGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                     const RenderableObject& obj, GeometryHandle pattern,
+                                     const QuantizedMesh* mesh = nullptr);
+void FreeGeometry(GeometryHeap& heap, GeometryHandle handle);
+// The worst RangeFragmentation() of the heap's vertex and index pools.
+float GeometryHeapFragmentation(const GeometryHeap& heap);
+// The CPU half of a compaction: moves every live range to the front of its pool, in offset order, updates the
+// allocations and allocators to match and fills heap.compaction with the copies that would move the data.
+void PackGeometryHeap(GeometryHeap& heap);
+// PackGeometryHeap() plus the copies, recorded into cmdbuf from the old buffers into fresh ones. Draw commands built
+// before compaction are stale afterwards.
+void CompactGeometryHeap(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf);
+
+// `lod` is clamped to the levels the object was uploaded with.
+SDL_GPUIndexedIndirectDrawCommand GeometryDrawCommand(const GeometryHeap& heap, GeometryHandle handle,
+                                                      std::uint32_t lod = 0);
+SDL_GPUBuffer* GeometryIndexBuffer(const GeometryHeap& heap, SDL_GPUIndexElementSize index_size);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a over raw bytes, for hashes that must come out the same on every run: pipeline cache keys and the
+// replay's final-state check. Start from kFnvOffsetBasis and chain calls by passing each result back in.
+inline constexpr std::uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+
+std::uint64_t HashBytes(std::uint64_t hash, const void* data, std::size_t size);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Input recordings (.s3dinput) for reproducible runs. A fixed header is followed by one InputFrame per rendered
+// frame: the keys held that frame, as PackKeys() bits, and the one-shot actions taken in it. Recording and replay
+// both run the simulation in lockstep, one step per frame, so replaying the frames in order puts the scene through
+// exactly the same states; the header keeps the hash of the last one to check that against.
+inline constexpr std::uint32_t kInputFileMagic = 0x4E504933; // "3IPN"
+inline constexpr std::uint32_t kInputFileVersion = 1;
+
+enum InputAction : std::uint8_t {
+    kInputActionReset = 1 << 0,          // R
+    kInputActionPrintVertex = 1 << 1,    // SPACE
+    kInputActionCaptureProfile = 1 << 2, // P
+};
+struct InputFileHeader {
+    std::uint32_t magic = kInputFileMagic;
+    std::uint32_t version = kInputFileVersion;
+    std::uint32_t frame_count = 0;
+    std::uint32_t simulation_rate = 0; // steps per second, one per frame
+    std::uint64_t state_hash = 0;      // HashSnapshot() after the last frame
+};
+struct InputFrame {
+    std::uint16_t keys = 0;
+    std::uint8_t actions = 0; // InputAction bits
+    std::uint8_t reserved = 0;
+};
+static_assert(sizeof(InputFileHeader) == 24 && sizeof(InputFrame) == 4);
+
+struct InputRecording {
+    std::uint32_t simulation_rate = 0;
+    std::vector<InputFrame> frames;
+    std::uint64_t state_hash = 0;
+};
+
+// Both throw std::runtime_error if the file cannot be written or read, or fails validation.
+void WriteInputRecording(const std::filesystem::path& path, const InputRecording& recording);
+InputRecording ReadInputRecording(const std::filesystem::path& path);
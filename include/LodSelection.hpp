@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "FrustumCulling.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+// Per-frame choice of LOD level for every visible object. An object's bounding sphere is projected with the camera's
+// vertical focal length (Camera.proj[1][1]) into pixels, and each level's error, which is relative to the sphere's
+// radius, shrinks with it. The coarsest level whose projected error stays under max_pixel_error is drawn.
+// To avoid popping, a level is only left for a coarser one once that one's error is below the threshold divided by
+// (1 + hysteresis), and for a finer one once its own error exceeds the threshold times (1 + hysteresis).
+struct LodSelectionSettings {
+    float viewport_height = 640.0f; // pixels
+    float max_pixel_error = 1.0f;
+    float hysteresis = 0.25f;
+};
+struct LodStats {
+    std::array<std::uint64_t, kMaxLodLevels> objects{}; // visible objects drawn at each level
+    std::uint64_t triangles = 0;                        // as drawn
+    std::uint64_t full_triangles = 0;                   // had every visible object been drawn at level 0
+};
+struct LodSelector {
+    std::vector<std::uint8_t> levels; // per object, kept between frames for hysteresis
+
+    LodStats frame_stats;
+    LodStats total_stats;
+};
+
+// Updates selector.levels for bounds.visible_objects; culled objects keep their level until they are seen again.
+void SelectLods(LodSelector& selector, const std::vector<RenderableObject>& objects, const SceneBounds& bounds,
+                const CameraObject& camera, ThreadPool& pool, const LodSelectionSettings& settings = {});
+void PrintLodSelectionReport(const LodStats& stats, std::size_t frame_count);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Scene.hpp"
+
+// Vertex -> triangle adjacency in CSR form, shared by the mesh passes that walk the triangles around a vertex: the
+// triangles using vertex v are triangles[offsets[v]] up to triangles[offsets[v + 1]], in index order, once per corner.
+struct TriangleAdjacency {
+    std::vector<std::uint32_t> offsets; // vertex_count + 1
+    std::vector<std::uint32_t> triangles;
+    std::vector<std::uint32_t> cursor; // scratch for the fill
+};
+
+// Rebuilds `adjacency` for `indices` over vertex_count vertices, reusing its storage.
+void BuildTriangleAdjacency(TriangleAdjacency& adjacency, const std::vector<TriangleIndices>& indices,
+                            std::size_t vertex_count);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "Scene.hpp"
+
+// Binary mesh container (.s3dmesh). A fixed header is followed by vertex, normal and index sections, each aligned to
+// kMeshSectionAlignment and laid out exactly as the GeometryHeap stores them: PositionAndColorVertex, VertexNormal,
+// then 16-bit indices when every vertex is reachable by one (32-bit otherwise). Loading maps the file and hands out
+// spans into the mapping, so sections go straight from the page cache into the upload ring. Bounds and normals are
+// precomputed when the file is written.
+inline constexpr std::uint32_t kMeshFileMagic = 0x48534D33; // "3MSH"
+inline constexpr std::uint32_t kMeshFileVersion = 1;
+inline constexpr std::uint64_t kMeshSectionAlignment = 64;
+
+struct MeshFileSection {
+    std::uint64_t offset = 0; // from the start of the file
+    std::uint64_t size = 0;   // in bytes
+};
+struct MeshFileHeader {
+    std::uint32_t magic = kMeshFileMagic;
+    std::uint32_t version = kMeshFileVersion;
+    std::uint32_t vertex_count = 0;
+    std::uint32_t index_count = 0;
+    std::uint32_t index_size = 2; // bytes per index
+    std::uint32_t reserved = 0;
+    MeshFileSection vertices;
+    MeshFileSection normals;
+    MeshFileSection indices;
+    float box_min[3] = {};
+    float box_max[3] = {};
+    float sphere_center[3] = {};
+    float sphere_radius = 0.0f;
+};
+static_assert(sizeof(MeshFileHeader) == 112);
+static_assert(sizeof(PositionAndColorVertex) == 16 && sizeof(VertexNormal) == 12);
+
+struct MappedMesh {
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+
+    std::uint32_t vertex_count = 0;
+    std::uint32_t index_count = 0;
+    std::uint32_t index_size = 2;
+    std::span<const PositionAndColorVertex> vertices;
+    std::span<const VertexNormal> normals;
+    std::span<const std::byte> indices;
+    BoundingBox box;
+    BoundingSphere sphere;
+};
+
+// Bounds and normals are taken from obj as they are; fill them in first.
+void WriteMeshFile(const std::filesystem::path& path, const RenderableObject& obj);
+// Throws std::runtime_error if the file cannot be mapped or fails validation.
+MappedMesh MapMeshFile(const std::filesystem::path& path);
+void UnmapMeshFile(MappedMesh& mesh);
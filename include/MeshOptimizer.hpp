@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "Scene.hpp"
+
+// Load-time reordering of a RenderableObject for the GPU. OptimizeMesh() runs three passes:
+//  1. Tipsify (Sander, Nehab & Barczak 2007) reorders triangles for the post-transform vertex cache.
+//  2. The result is cut into clusters where the cache order allows it. Clusters are then sorted so that
+//     outward-facing ones are drawn first, which reduces overdraw without undoing most of step 1.
+//  3. Vertices (and normals with them) are renumbered in first-use order, so vertex fetch walks memory forwards.
+//     Vertices no triangle uses keep their relative order at the end.
+// ACMR is cache misses per triangle, and ATVR is cache misses per referenced vertex (1.0 is ideal). Both are
+// measured with a FIFO cache of kVertexCacheSize entries.
+inline constexpr std::uint32_t kVertexCacheSize = 16;
+
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+struct MeshOptimizationStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    float front_facing = 0.0f; // OptimizeOverdraw()'s result
+};
+
+VertexCacheStats AnalyzeVertexCache(const RenderableObject& obj, std::uint32_t cache_size = kVertexCacheSize);
+
+void OptimizeVertexCache(RenderableObject& obj, std::uint32_t cache_size = kVertexCacheSize);
+// threshold > 1 lets clusters be cut where doing so raises the cache miss rate by at most that factor. Returns how far
+// the first cluster drawn faces away from the mesh centre: its centroid's offset from the mesh centroid along its
+// mean normal, positive when it faces outward (0 for a single cluster or a flat mesh).
+float OptimizeOverdraw(RenderableObject& obj, float threshold = 1.05f);
+void OptimizeVertexFetch(RenderableObject& obj);
+
+MeshOptimizationStats OptimizeMesh(RenderableObject& obj);
+void PrintMeshOptimizationReport(std::string_view name, const MeshOptimizationStats& stats);
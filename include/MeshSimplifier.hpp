@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+// Quadric error metric simplification (Garland & Heckbert 1997) by half-edge collapse: a vertex is merged into one
+// of its neighbours, so no vertices are created or moved and every level can index the original vertex range.
+// Collapses are applied in passes, cheapest first, with the error measured as mean squared distance to the planes
+// of the triangles each vertex has absorbed. A vertex is only ever collapsed if that keeps the mesh's outline:
+//  - interior vertices may collapse into any neighbour;
+//  - vertices on an open border may only slide along it, and borders add a plane perpendicular to the surface;
+//  - attribute seams (several vertices at one position) and non-manifold vertices stay where they are.
+// Triangles that would flip are rejected.
+struct LodChainSettings {
+    float reduction = 0.5f;      // target triangle count of each level relative to the previous one
+    float min_reduction = 0.85f; // stop once a level keeps more than this fraction of its parent
+    std::size_t min_triangles = 32;
+};
+
+// Simplifies `indices` (triangles over obj.vertices) towards target_triangle_count without exceeding max_error.
+// The returned error is the square root of the largest quadric error among the applied collapses: an estimate of the
+// RMS distance a moved vertex ends up from the planes it absorbed, relative to `indices` and not to obj.indices. It
+// is not a bound on the distance between the two surfaces, which can be larger.
+LodLevel SimplifyMesh(const RenderableObject& obj, const std::vector<TriangleIndices>& indices,
+                      std::size_t target_triangle_count, float max_error);
+
+// Fills obj.lods with up to kMaxLodLevels - 1 levels, each simplified from the one before. Level errors are summed
+// along the chain, so each one estimates the deviation from the full mesh and grows with the level, but like the
+// per-level error it is not a bound. Triangle order follows obj.indices, which keeps most of the vertex cache
+// ordering from OptimizeMesh().
+void BuildLodChain(RenderableObject& obj, const LodChainSettings& settings = {});
+// One object per task on the pool.
+void BuildLodChains(std::vector<RenderableObject>& objects, ThreadPool& pool, const LodChainSettings& settings = {});
+void PrintLodChainReport(std::string_view name, const RenderableObject& obj);
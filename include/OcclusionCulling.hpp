@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+#include "FrustumCulling.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+// Software occlusion culling, run after CullScene(). The largest nearby visible objects that still have CPU-side
+// geometry become occluders and are rasterized, depth only, into a small CPU buffer of 1 / clip w cleared to 0, so
+// nearer is greater as under the scene pipeline's COMPAREOP_GREATER. Horizontal bands of the buffer are filled in
+// parallel, eight texels at a time. Every other visible object's world box is then projected to a screen rectangle
+// and the depth of its nearest corner, and the object is dropped from bounds.visible_objects when every texel under
+// the rectangle holds something nearer.
+//
+// Occluders cover the texels whose centres they cover, as on the GPU, so an object showing only through a gap
+// narrower than a texel can be culled. Boxes reaching behind the eye are always kept.
+struct OcclusionSettings {
+    int width = 256;
+    int height = 128;
+    std::uint32_t max_occluders = 32;
+    float min_occluder_size = 0.1f;              // bounding sphere radius over view depth
+    std::uint32_t max_occluder_triangles = 4096; // denser meshes cost more to rasterize than they save
+};
+struct OcclusionStats {
+    double raster_ms = 0.0; // picking, setting up and rasterizing occluders
+    double test_ms = 0.0;
+    std::uint64_t occluders = 0;
+    std::uint64_t occluder_triangles = 0; // after near clipping
+    std::uint64_t tested = 0;             // visible after frustum culling, occluders aside
+    std::uint64_t culled = 0;
+};
+// An occluder triangle in buffer texels, wound so its edge functions are positive inside.
+struct OccluderTriangle {
+    float x[3];
+    float y[3];
+    float inv_w[3];
+    float inv_area;
+    int min_x, min_y, max_x, max_y; // inclusive texel bounds, clamped to the buffer; min_y > max_y when empty
+};
+struct OcclusionCuller {
+    OcclusionSettings settings;
+    std::vector<float> depth; // row-major, top row first
+
+    // scratch kept between frames
+    std::vector<std::pair<float, std::uint32_t>> candidates; // (size, object)
+    std::vector<std::uint32_t> occluders;                    // object indices
+    std::vector<std::uint8_t> is_occluder;                   // per object
+    std::vector<std::size_t> vertex_offsets;                 // per occluder, into clip_positions
+    std::vector<std::size_t> triangle_offsets;               // per occluder, two slots per source triangle
+    std::vector<glm::vec4> clip_positions;
+    std::vector<OccluderTriangle> triangles;
+
+    OcclusionStats frame_stats;
+    OcclusionStats total_stats;
+};
+
+inline constexpr int kOcclusionBandHeight = 8; // rows per raster job
+inline constexpr int kOcclusionLanes = 8;      // texels per step, sized for one AVX or two NEON registers
+
+OcclusionCuller CreateOcclusionCuller(const OcclusionSettings& settings = {});
+// Rasterizes this frame's occluders, then tests and compacts bounds.visible_objects, clearing bounds.visible for the
+// objects it drops. `view_proj` is the frame's projection times view.
+void CullOccludedObjects(OcclusionCuller& culler, const std::vector<RenderableObject>& objects, SceneBounds& bounds,
+                         const glm::mat4& view_proj, ThreadPool& pool);
+void PrintOcclusionReport(const OcclusionStats& stats, std::size_t frame_count);
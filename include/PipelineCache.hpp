@@ -0,0 +1,116 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Graphics pipelines built from compiled shader files on background threads. Callers describe a pipeline, get a
+// handle back immediately and only block when they first need it, so startup work overlaps the builds. Identical
+// descriptions share one entry. Every entry is keyed by a hash of its shader bytes and create info: Poll() watches
+// the shader files, rebuilds entries whose files changed and swaps the new pipeline in between frames, skipping the
+// build when the bytes hash the same and keeping the old pipeline when the new one fails.
+struct ShaderDesc {
+    std::string name; // file in the cache's directory, without the format's extension
+    SDL_GPUShaderStage stage = SDL_GPU_SHADERSTAGE_VERTEX;
+    std::uint32_t num_samplers = 0;
+    std::uint32_t num_storage_textures = 0;
+    std::uint32_t num_storage_buffers = 0;
+    std::uint32_t num_uniform_buffers = 0;
+};
+// SDL_GPUGraphicsPipelineCreateInfo with its arrays owned and its shaders named by file.
+struct PipelineDesc {
+    ShaderDesc vertex;
+    ShaderDesc fragment;
+    SDL_GPUPrimitiveType primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+    SDL_GPURasterizerState rasterizer_state{};
+    SDL_GPUMultisampleState multisample_state{};
+    SDL_GPUDepthStencilState depth_stencil_state{};
+    std::vector<SDL_GPUVertexBufferDescription> vertex_buffers;
+    std::vector<SDL_GPUVertexAttribute> vertex_attributes;
+    std::vector<SDL_GPUColorTargetDescription> color_targets;
+    bool has_depth_stencil_target = false;
+    SDL_GPUTextureFormat depth_stencil_format = SDL_GPU_TEXTUREFORMAT_INVALID;
+};
+
+using PipelineHandle = std::uint32_t;
+
+struct PipelineCacheStats {
+    std::size_t requests = 0;
+    std::size_t hits = 0;     // served by an existing entry, or rebuilt from unchanged bytes
+    std::size_t misses = 0;   // built from scratch
+    std::size_t reloads = 0;  // rebuilt pipelines swapped in
+    std::size_t failures = 0; // builds that produced no pipeline
+    double build_ms = 0.0;    // summed over the build threads
+};
+
+class PipelineCache {
+public:
+    // Shader files are looked up as directory / (name + ".msl" or ".spv", following format).
+    PipelineCache(SDL_GPUDevice* device, std::filesystem::path directory, SDL_GPUShaderFormat format,
+                  const char* entrypoint, unsigned thread_count = 2);
+    // Waits for builds in progress, then releases every pipeline.
+    ~PipelineCache();
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    PipelineHandle Request(const PipelineDesc& desc);
+    // The current pipeline, or nullptr while its first build is still running.
+    SDL_GPUGraphicsPipeline* Get(PipelineHandle handle) const;
+    // Blocks until the first build has finished; throws std::runtime_error if it failed.
+    SDL_GPUGraphicsPipeline* Wait(PipelineHandle handle);
+    // Main thread, between frames: swaps in finished rebuilds and, every kWatchInterval, queues rebuilds for
+    // entries whose shader files changed. Pipelines returned by Get() stay valid until the next Poll().
+    void Poll();
+    PipelineCacheStats Stats() const;
+
+    static constexpr auto kWatchInterval = std::chrono::milliseconds(500);
+
+private:
+    struct Entry {
+        PipelineDesc desc;
+        std::uint64_t content_hash = 0; // of the shader bytes and desc the current pipeline was built from
+        std::array<std::filesystem::path, 2> files;
+        std::array<std::filesystem::file_time_type, 2> write_times{};
+        SDL_GPUGraphicsPipeline* pipeline = nullptr;
+        SDL_GPUGraphicsPipeline* pending = nullptr; // rebuilt, waiting for Poll()
+        std::uint64_t pending_hash = 0;
+        bool built = false;    // the first build has finished, successfully or not
+        bool building = false; // queued or running
+        std::string error;     // from the last failed build
+    };
+
+    void WorkerLoop();
+    void Build(PipelineHandle handle);
+    void Enqueue(PipelineHandle handle);
+
+    SDL_GPUDevice* device;
+    std::filesystem::path directory;
+    SDL_GPUShaderFormat format;
+    std::string extension;
+    const char* entrypoint;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;     // work queued or stopping
+    std::condition_variable finished; // an entry finished a build
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::unordered_map<std::uint64_t, PipelineHandle> by_desc; // desc hash -> entry
+    std::deque<PipelineHandle> queue;
+    std::vector<std::string> reload_errors; // printed by Poll()
+    PipelineCacheStats stats;
+    std::chrono::steady_clock::time_point last_watch;
+    bool stopping = false;
+    std::vector<std::thread> workers; // last, so everything above exists before they start
+};
+
+void PrintPipelineCacheReport(const PipelineCacheStats& stats, double startup_ms);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Scene.hpp"
+
+// Functions for scaffolding a Scene: the test scene's meshes and generated stress scenes for benchmarks.
+RenderableObject CreateCube();
+// 7 x 7 cells, spanning 14 units at y = -1
+RenderableObject CreateFlatPlane();
+// CreateFlatPlane() with each side split into `cells` cells instead of 7, at 2 * cells * cells triangles; more than
+// 255 cells need 32-bit indices
+RenderableObject CreateSubdividedPlane(std::uint32_t cells);
+// cells x cells quads in the XZ plane, facing up; large enough grids need 32-bit indices
+RenderableObject CreateGridMesh(std::uint32_t cells);
+CameraObject CreateCamera();
+
+// `count` copies of an optimized mesh with its LOD chain, each on its own root transform, laid out on a square grid
+// in the XZ plane with the camera above one edge looking at the middle. Objects are not uploaded.
+Scene CreateCubeFieldScene(std::uint32_t count);
+Scene CreatePlaneFieldScene(std::uint32_t count, std::uint32_t cells);
+// `rooms` rooms in a row down -z, each walled off from the next but for a doorway, alternating sides, and holding a
+// 5 x 5 grid of small cubes, with the camera at the front of the first room looking down the row. The walls are the
+// cube mesh scaled flat, so every object shares one mesh as in the field scenes.
+Scene CreateInteriorScene(std::uint32_t rooms);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Scoped-zone frame profiler. PROFILE_ZONE("name") times the rest of the enclosing scope and PROFILE_COUNTER()
+// samples a value; both only record while a capture is running. Every thread appends to its own fixed-size buffer
+// with plain stores and a release of its event count, so recording takes no locks, and a full buffer drops events
+// (counted) rather than growing. EndProfilerCapture() writes everything recorded since BeginProfilerCapture() as
+// Chrome trace event JSON, which chrome://tracing and ui.perfetto.dev both open. Names must be string literals or
+// otherwise outlive the capture.
+//
+// The profiler is built only when TBDGAME_PROFILER is defined, which CMake does for every configuration except
+// Release. Without it the macros expand to nothing, their arguments are not evaluated, and the capture functions
+// do nothing.
+#ifdef TBDGAME_PROFILER
+namespace profiler_detail {
+    extern std::atomic<bool> capturing;
+
+    inline std::uint64_t Now() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+    void RecordZone(const char* name, std::uint64_t start_ns, std::uint64_t end_ns);
+    void RecordCounter(const char* name, double value);
+}
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name(name),
+          start_ns(profiler_detail::capturing.load(std::memory_order_relaxed) ? profiler_detail::Now() : 0) {}
+    ~ProfileZone() {
+        if (start_ns != 0) {
+            profiler_detail::RecordZone(name, start_ns, profiler_detail::Now());
+        }
+    }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    std::uint64_t start_ns;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) const ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_COUNTER(name, value)                                                                                   \
+    do {                                                                                                               \
+        if (profiler_detail::capturing.load(std::memory_order_relaxed)) {                                             \
+            profiler_detail::RecordCounter(name, static_cast<double>(value));                                          \
+        }                                                                                                              \
+    } while (false)
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_COUNTER(name, value) static_cast<void>(0)
+#endif
+
+struct ProfilerCaptureStats {
+    std::size_t events = 0;
+    std::size_t dropped = 0; // lost to full thread buffers
+    std::size_t threads = 0;
+};
+
+constexpr bool ProfilerBuiltIn() {
+#ifdef TBDGAME_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+bool ProfilerCapturing();
+void BeginProfilerCapture();
+// Stops recording and writes the capture; throws std::runtime_error if the file cannot be written.
+ProfilerCaptureStats EndProfilerCapture(const std::filesystem::path& path);
+void PrintProfilerCaptureReport(const std::filesystem::path& path, const ProfilerCaptureStats& stats);
+// Names the calling thread in captures ("main", "simulation", ...); by default threads are numbered.
+void SetProfilerThreadName(const char* name);
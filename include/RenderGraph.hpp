@@ -0,0 +1,139 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A frame's render passes described by the textures they read and write, rebuilt every frame. CompileRenderGraph()
+// drops passes nothing needs (a pass is kept when it writes an imported texture, is marked with side effects, or
+// writes something a kept pass reads), orders the rest so every texture's writers run before its readers, and gives
+// each transient texture a physical one from a pool that lives across frames. Two transient textures whose lifetimes
+// (first to last use in the compiled order) do not overlap and whose format, usage and size match share one pooled
+// texture. SDL's GPU API gives no control over memory placement, so this texture reuse is the graph's aliasing.
+//
+// Transient sizes of 0 follow the backbuffer, scaled by `scale`; SetRenderGraphBackbufferSize() releases those pooled
+// textures when the backbuffer changes size and the next compile creates them again. Pooled textures no frame has
+// used for kRenderGraphIdleFrames compiles are released too.
+//
+// Everything a frame adds (pass resource lists, copies of the pass callables, compile scratch) goes in the memory
+// given to ResetRenderGraph(), normally the frame's arena, and is never freed piece by piece, so building and
+// compiling a frame's graph does not touch the heap once the graph's own vectors have grown.
+using RenderResource = std::uint32_t;
+
+struct RenderTextureDesc {
+    SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    SDL_GPUTextureUsageFlags usage = 0;
+    std::uint32_t width = 0; // 0 follows the backbuffer
+    std::uint32_t height = 0;
+    float scale = 1.0f; // of the backbuffer size, when width and height follow it
+};
+
+struct RenderGraph;
+// A pass callable copied into the frame's memory; see AddRenderPass().
+struct RenderPassExecute {
+    const void* callable = nullptr;
+    void (*invoke)(const void* callable, SDL_GPUCommandBuffer* cmdbuf, const RenderGraph& graph) = nullptr;
+};
+
+struct RenderPassNode {
+    const char* name; // a string literal: it names the pass's profiler zone
+    std::span<const RenderResource> reads;  // in the frame's memory
+    std::span<const RenderResource> writes;
+    bool side_effects = false; // kept even when nothing reads what it writes
+    RenderPassExecute execute;
+};
+struct RenderResourceNode {
+    const char* name;
+    RenderTextureDesc desc;
+    SDL_GPUTexture* imported = nullptr; // null for transient textures
+    std::uint32_t first_use = 0;        // positions in the compiled order
+    std::uint32_t last_use = 0;
+    bool used = false;
+    std::uint32_t physical = 0; // index into the pool, for used transient textures
+};
+struct PooledRenderTexture {
+    SDL_GPUTextureFormat format;
+    SDL_GPUTextureUsageFlags usage;
+    std::uint32_t width;
+    std::uint32_t height;
+    bool follows_backbuffer;
+    SDL_GPUTexture* texture;
+    std::uint64_t bytes;
+    std::uint64_t last_frame;     // the last compile that used it
+    std::uint32_t busy_until = 0; // compiled position of its current user's last use, this frame
+};
+
+struct RenderGraphStats {
+    std::uint32_t passes = 0;
+    std::uint32_t culled_passes = 0;
+    std::uint32_t transient_textures = 0;
+    std::uint32_t pooled_textures = 0; // physical textures the transient ones were given
+    std::uint64_t transient_bytes = 0;  // held by those pooled textures
+    std::uint64_t unaliased_bytes = 0;  // if every transient texture had its own
+    std::uint64_t textures_created = 0; // since the graph was created
+    std::uint64_t resizes = 0;
+};
+
+inline constexpr std::uint64_t kRenderGraphIdleFrames = 120;
+
+struct RenderGraph {
+    std::pmr::memory_resource* frame_memory = nullptr; // given to the last ResetRenderGraph()
+    std::vector<RenderPassNode> passes;
+    std::vector<RenderResourceNode> resources;
+    std::vector<std::uint32_t> order; // kept passes, in execution order
+    std::vector<PooledRenderTexture> pool;
+
+    SDL_GPUDevice* device = nullptr;
+    std::uint32_t backbuffer_width = 0;
+    std::uint32_t backbuffer_height = 0;
+    std::uint64_t frame = 0;
+    RenderGraphStats stats; // of the last compile
+};
+
+RenderGraph CreateRenderGraph(SDL_GPUDevice* device, std::uint32_t width, std::uint32_t height);
+void DestroyRenderGraph(RenderGraph& graph);
+// Returns true if the size changed, releasing every pooled texture that follows the backbuffer.
+bool SetRenderGraphBackbufferSize(RenderGraph& graph, std::uint32_t width, std::uint32_t height);
+
+// Clears the last frame's passes and resources, which may still point into the memory the last frame was given;
+// the pool is kept. This frame's passes go in `frame_memory`, which must stay valid until ExecuteRenderGraph()
+// returns.
+void ResetRenderGraph(RenderGraph& graph, std::pmr::memory_resource& frame_memory);
+// Textures the graph does not own, such as the swapchain; passes that write them are never culled.
+RenderResource ImportRenderTexture(RenderGraph& graph, const char* name, SDL_GPUTexture* texture,
+                                   const RenderTextureDesc& desc = {});
+RenderResource CreateRenderTexture(RenderGraph& graph, const char* name, const RenderTextureDesc& desc);
+void AddRenderPassNode(RenderGraph& graph, const char* name, std::span<const RenderResource> reads,
+                       std::span<const RenderResource> writes, RenderPassExecute execute, bool side_effects);
+// `execute(cmdbuf, graph)` runs inside ExecuteRenderGraph(); passes begin and end their own GPU passes and look their
+// textures up with GetRenderGraphTexture(). It is copied into the frame's memory and never destroyed, so it may only
+// capture references, pointers and plain values.
+template <class Execute>
+void AddRenderPass(RenderGraph& graph, const char* name, std::initializer_list<RenderResource> reads,
+                   std::initializer_list<RenderResource> writes, Execute execute, const bool side_effects = false) {
+    static_assert(std::is_trivially_destructible_v<Execute>, "render pass callables are never destroyed");
+    void* callable = nullptr;
+    if (graph.frame_memory != nullptr) {
+        callable = new (graph.frame_memory->allocate(sizeof(Execute), alignof(Execute))) Execute(std::move(execute));
+    }
+    const auto invoke = [](const void* callable, SDL_GPUCommandBuffer* cmdbuf, const RenderGraph& graph) {
+        (*static_cast<const Execute*>(callable))(cmdbuf, graph);
+    };
+    AddRenderPassNode(graph, name, reads, writes, RenderPassExecute{callable, invoke}, side_effects);
+}
+
+// Throws std::logic_error if the passes' reads and writes form a cycle.
+void CompileRenderGraph(RenderGraph& graph);
+void ExecuteRenderGraph(const RenderGraph& graph, SDL_GPUCommandBuffer* cmdbuf);
+// Valid between CompileRenderGraph() and the next ResetRenderGraph().
+SDL_GPUTexture* GetRenderGraphTexture(const RenderGraph& graph, RenderResource resource);
+std::uint32_t RenderTextureWidth(const RenderGraph& graph, RenderResource resource);
+std::uint32_t RenderTextureHeight(const RenderGraph& graph, RenderResource resource);
+
+void PrintRenderGraphReport(const RenderGraph& graph);
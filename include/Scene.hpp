@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "TransformHierarchy.hpp"
+
+// List of structs for rendering Scenes
+using TransformMatrix = glm::mat4;
+using TriangleIndices = glm::u32vec3;
+using VertexNormal = glm::vec3;
+using GeometryHandle = std::uint32_t;
+inline constexpr GeometryHandle kNoGeometry = ~0u;
+struct PositionAndColorVertex {
+    glm::vec3 pos{};
+    glm::u8vec4 color{};
+};
+struct BoundingBox {
+    glm::vec3 min{};
+    glm::vec3 max{};
+};
+struct BoundingSphere {
+    glm::vec3 center{};
+    float radius = 0.0f;
+};
+// Coarser versions of a mesh that reuse its vertices and only replace the triangle list; see BuildLodChain()
+inline constexpr std::uint32_t kMaxLodLevels = 4; // including the full mesh
+struct LodLevel {
+    std::vector<TriangleIndices> indices;
+    float error = 0.0f; // object-space deviation from the full mesh; how it is measured depends on the producer
+};
+struct RenderableObject {
+    std::vector<PositionAndColorVertex> vertices;
+    std::vector<VertexNormal> normals;
+    std::vector<TriangleIndices> indices;
+    std::vector<LodLevel> lods; // levels 1.. in increasing error; level 0 is `indices`
+    // triangles per level, level 0 first, for objects drawn from indices they do not hold (terrain chunks share one
+    // index pattern); empty when `indices` and `lods` have them
+    std::vector<std::uint32_t> level_triangles;
+    glm::mat4 model;                       // copied from the hierarchy's world matrix when `transform` is set
+    TransformHandle transform = kNoTransform;
+    glm::mat4 vertex_transform{1.0f};      // stored vertex -> object space; identity unless the upload quantized it
+    GeometryHandle geometry = kNoGeometry; // ranges in the GPU GeometryHeap, once uploaded
+    BoundingBox local_box;                 // object space; refresh with UpdateLocalBounds() when vertices change
+    BoundingSphere local_sphere;
+};
+struct CameraObject {
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec3 camera_coords;
+    glm::vec3 target_coords;
+};
+struct Scene {
+    std::vector<RenderableObject> Objects;
+    CameraObject Camera;
+    TransformHierarchy Transforms;
+};
+// pushed once per frame; model matrices come from the DrawList storage buffer
+struct CameraUniformData {
+    glm::mat4 view;
+    glm::mat4 proj;
+};
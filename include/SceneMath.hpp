@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Scene.hpp"
+#include "TransformHierarchy.hpp"
+
+// Methods for Transforming Model, View, and Projection Matrices before passing to Vertex Shader. Models only change
+// their local TRS in the scene's TransformHierarchy; UpdateTransforms() rebuilds the matrices once per frame.
+// Positive angles turn clockwise looking down the axis, as the hand-built matrices these replaced did.
+void TranslateModel(TransformHierarchy& transforms, TransformHandle node, glm::vec3 tr);
+void RotateModelInPlace(TransformHierarchy& transforms, TransformHandle node, float angle, glm::vec3 axis);
+void RotateModelAboutOrigin(TransformHierarchy& transforms, TransformHandle node, float angle, glm::vec3 axis);
+void ScaleModel(TransformHierarchy& transforms, TransformHandle node, glm::vec3 scalars);
+void ResetModel(TransformHierarchy& transforms, TransformHandle node);
+// Copies the world matrices UpdateTransforms() rewrote into the objects that use them.
+void ApplyWorldTransforms(const TransformHierarchy& transforms, std::vector<RenderableObject>& objects);
+
+glm::vec3& DollyCamera(CameraObject& cam, float distance);
+glm::vec3& RaiseOrLowerCamera(CameraObject& cam, float distance);
+glm::vec3& OrbitCameraLaterally(CameraObject& cam, float angle);
+glm::mat4& LookAt(CameraObject& cam, glm::vec3 center);
+glm::mat4& Project(CameraObject& cam, float vFov, float aspectRatio, float near, float far);
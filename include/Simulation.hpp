@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <thread>
+#include <vector>
+
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "TransformHierarchy.hpp"
+#include "TripleBuffer.hpp"
+
+// Fixed-timestep simulation on its own thread. Every step advances the simulation by exactly `step`, on a
+// monotonic clock, and publishes an immutable snapshot of the scene's moving state through a TripleBuffer. The
+// render thread never waits for it: each frame it takes the newest snapshot and draws between the last two it has
+// seen, so motion stays smooth whatever the frame rate and is one step behind the simulation.
+//
+// In lockstep mode there is no thread: the render thread calls Advance() once per frame, so every frame sees
+// exactly one step whatever the timing, which input recording and replay rely on.
+using SimulationClock = std::chrono::steady_clock;
+
+enum class SimulationMode {
+    Threaded,
+    Lockstep,
+};
+
+struct SceneSnapshot {
+    std::uint64_t tick = 0;
+    SimulationClock::time_point time; // scheduled time of the step that produced it
+    CameraObject camera;
+    std::vector<glm::vec3> translation; // local TRS per TransformHierarchy node
+    std::vector<glm::quat> rotation;
+    std::vector<glm::vec3> scale;
+};
+
+// Both split their per-node work across the pool, so the simulation and render threads can share one.
+void CaptureSnapshot(SceneSnapshot& snapshot, const CameraObject& camera, const TransformHierarchy& transforms,
+                     ThreadPool& pool);
+// Blends previous towards current by alpha in [0, 1] into the render thread's transforms (only nodes whose TRS
+// differ are marked dirty) and camera position. The view matrix is left for the caller to rebuild.
+void InterpolateSnapshots(const SceneSnapshot& previous, const SceneSnapshot& current, float alpha,
+                          CameraObject& camera, TransformHierarchy& transforms, ThreadPool& pool);
+// FNV-1a over the tick, camera and every node's TRS, bit for bit.
+std::uint64_t HashSnapshot(const SceneSnapshot& snapshot);
+
+class SimulationThread {
+public:
+    using StepFunction = std::function<void(float)>;             // advance by dt seconds
+    using CaptureFunction = std::function<void(SceneSnapshot&)>; // write the current state
+
+    // Captures the initial state on the calling thread, then starts stepping unless in lockstep.
+    SimulationThread(SimulationClock::duration step, StepFunction step_function, CaptureFunction capture,
+                     SimulationMode mode = SimulationMode::Threaded);
+    ~SimulationThread();
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    SimulationClock::duration Step() const {
+        return step;
+    }
+    SimulationMode Mode() const {
+        return mode;
+    }
+    // Lockstep only (std::logic_error otherwise): runs one step on the calling thread and publishes it. Returns the
+    // step's time, which is a fixed step after the last one's.
+    SimulationClock::time_point Advance();
+    // Render thread only: true if a newer snapshot than the last one returned by Latest() is available.
+    bool Acquire() {
+        return snapshots.Update();
+    }
+    const SceneSnapshot& Latest() const {
+        return snapshots.ReadBuffer();
+    }
+
+private:
+    void Run();
+    void StepAndPublish(SimulationClock::time_point time);
+
+    SimulationClock::duration step;
+    SimulationMode mode;
+    std::uint64_t tick = 0;                // the last published step's
+    SimulationClock::time_point last_time; // the initial snapshot's, then the last Advance()'s
+    StepFunction step_function;
+    CaptureFunction capture;
+    TripleBuffer<SceneSnapshot> snapshots;
+    std::atomic<bool> stopping{false};
+    std::thread thread; // last, so everything above exists before it starts
+};
+
+// The two newest snapshots the render thread has seen.
+struct SnapshotInterpolator {
+    SceneSnapshot previous;
+    SceneSnapshot current;
+    bool primed = false;
+};
+
+// Pulls in the newest snapshot, if any, and writes the blended state for `now` into camera and transforms.
+void InterpolateSimulation(SnapshotInterpolator& interpolator, SimulationThread& simulation,
+                           SimulationClock::time_point now, CameraObject& camera, TransformHierarchy& transforms,
+                           ThreadPool& pool);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+// CPU reference for the MVPInstanced.vert + SolidColorDepth.frag pipeline built in InitContext(): indexed triangle
+// lists, no face culling, color = (normal + 1) / 2 interpolated perspective-correctly, depth = 1 / clip.w written to
+// a D32 buffer cleared to 0 and tested with COMPAREOP_GREATER. Triangles are binned into screen tiles and the tiles
+// are rasterized in parallel, preserving submission order inside each tile.
+struct SoftwareFramebuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<glm::u8vec4> color; // RGBA8, row-major, top row first
+    std::vector<float> depth;
+};
+struct RasterTriangle {
+    float x[3];
+    float y[3];
+    float inv_w[3];
+    glm::vec3 color_over_w[3];
+    float inv_area;
+    float max_depth;
+    int min_x, min_y, max_x, max_y; // inclusive pixel bounds, clamped to the framebuffer
+};
+struct RasterBinEntry {
+    std::uint32_t order; // submission order of the source triangle
+    std::uint32_t slot;  // index into the binning thread's triangle list
+};
+struct SoftwareRasterizerStats {
+    std::size_t triangles_submitted = 0;
+    std::size_t triangles_rasterized = 0; // after near clipping, zero-area and off-screen rejection
+    std::size_t blocks_depth_rejected = 0;
+};
+struct SoftwareRasterizer {
+    SoftwareFramebuffer framebuffer;
+    ThreadPool* pool = nullptr;
+    int tiles_x = 0;
+    int tiles_y = 0;
+
+    // scratch kept between frames so steady-state renders do not reallocate
+    std::vector<glm::vec4> clip_positions;
+    std::vector<glm::vec3> vertex_colors;
+    std::vector<std::size_t> vertex_offsets;
+    std::vector<std::size_t> triangle_offsets;
+    std::vector<std::vector<RasterTriangle>> thread_triangles;
+    std::vector<std::vector<std::vector<RasterBinEntry>>> thread_bins; // [thread][tile]
+    std::vector<std::vector<std::size_t>> thread_merge_heads;
+    std::vector<float> block_min_depth;
+    std::vector<SoftwareRasterizerStats> thread_stats;
+};
+
+inline constexpr int kRasterTileSize = 64;
+inline constexpr int kRasterBlockSize = 8;
+
+SoftwareRasterizer CreateSoftwareRasterizer(int width, int height, ThreadPool& pool);
+SoftwareRasterizerStats RenderSceneSoftware(SoftwareRasterizer& rasterizer, const Scene& scene);
+bool WriteFramebufferPPM(const SoftwareFramebuffer& framebuffer, const std::string& path);
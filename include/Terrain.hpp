@@ -0,0 +1,144 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <compare>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "FrameStats.hpp"
+#include "GeometryHeap.hpp"
+#include "Scene.hpp"
+#include "UploadRing.hpp"
+#include "VertexQuantization.hpp"
+
+// Heightfield terrain streamed in square chunks around a point (the camera). Chunks are generated on the streamer's
+// own threads: heights from value-noise fBm, normals from central differences of the height function (so they match
+// across chunk edges), and one object-space error per LOD level. Every chunk has the same topology, so the index
+// levels (full grid, then every 2nd, 4th and 8th row and column) are uploaded once as a GeometryHeap index pattern
+// and chunks upload only their vertices. A skirt hangs below each chunk's edges, deep enough to hide the cracks
+// between neighbours drawn at different levels.
+//
+// Chunks become scene objects: Update() puts each finished chunk into a free slot of `objects` (or a new one at the
+// end) and empties the slot again when the chunk is evicted, so other objects' indices never change. Chunk objects
+// keep their bounds and LOD errors but drop their vertices once uploaded, and carry no CPU-side indices, only the
+// triangle count of each level.
+//
+// Update() is the only main-thread cost and is budgeted: at most max_pending chunks are queued or generating, at
+// most upload_budget_bytes of vertices are uploaded per frame (always at least one chunk, so progress is made), and
+// evicting is just freeing heap ranges.
+struct TerrainSettings {
+    float chunk_size = 16.0f;       // world units per side
+    std::uint32_t chunk_cells = 64; // quads per side; multiples of 8 get every LOD level
+    float load_radius = 96.0f;      // chunks whose centres are this close to the camera (in xz) are loaded
+    float evict_margin = 16.0f;     // and kept until they are this much further away
+    float base_height = -4.0f;
+    float height_scale = 3.0f;  // heights span base_height +- height_scale
+    float feature_size = 48.0f; // world units across the largest noise octave
+    std::uint32_t octaves = 5;
+    std::uint32_t seed = 1;
+    std::uint32_t upload_budget_bytes = 256 * 1024; // per frame
+    std::uint32_t max_pending = 8;
+};
+
+struct TerrainChunkCoord {
+    std::int32_t x = 0;
+    std::int32_t z = 0;
+    auto operator<=>(const TerrainChunkCoord&) const = default;
+};
+
+// Chunk timings kept for the report; enough for a stable p99 without growing with the length of the run.
+inline constexpr std::size_t kTerrainTimingSamples = 1024;
+
+struct TerrainStats {
+    std::size_t resident_chunks = 0;
+    std::size_t pending_chunks = 0;   // queued, generating or waiting for upload budget
+    std::uint64_t resident_bytes = 0; // GPU vertex bytes of resident chunks plus the shared index pattern
+    std::uint64_t generated = 0;
+    std::uint64_t evicted = 0;
+    std::uint64_t cancelled = 0; // left range before they were uploaded
+    std::uint64_t uploaded_bytes = 0;
+    std::uint64_t deferred_frames = 0; // frames that left finished chunks for a later frame's budget
+    // requested -> generated and requested -> uploaded, per chunk, sampled down to kTerrainTimingSamples
+    TimingReservoir generation_ms = CreateTimingReservoir(kTerrainTimingSamples);
+    TimingReservoir resident_ms = CreateTimingReservoir(kTerrainTimingSamples);
+};
+
+float TerrainHeight(const TerrainSettings& settings, float x, float z);
+std::uint32_t TerrainLodLevels(const TerrainSettings& settings);
+// Chunk-local geometry, origin at the chunk's minimum corner, with its model matrix and bounds set, one LOD level
+// per TerrainLodLevels() after the first, holding only its error, and the index pattern's triangles per level.
+RenderableObject CreateTerrainChunk(const TerrainSettings& settings, TerrainChunkCoord coord);
+// The index levels every chunk shares, with a vertices array of the chunk's size so the upload picks the index width.
+RenderableObject CreateTerrainIndexPattern(const TerrainSettings& settings);
+
+class TerrainStreamer {
+public:
+    // Chunks are generated for heaps storing `format`, quantized on the worker threads where needed.
+    TerrainStreamer(const TerrainSettings& settings, VertexFormat format, unsigned thread_count = 2);
+    // Drops queued chunks and waits for the ones generating. Uploaded chunks stay in the heap.
+    ~TerrainStreamer();
+    TerrainStreamer(const TerrainStreamer&) = delete;
+    TerrainStreamer& operator=(const TerrainStreamer&) = delete;
+
+    // Main thread, once per frame before culling, with the frame's command buffer: evicts chunks out of range,
+    // queues missing ones nearest first and uploads finished ones within the budget.
+    void Update(const glm::vec3& center, std::vector<RenderableObject>& objects, GeometryHeap& heap, UploadRing& ring,
+                SDL_GPUCommandBuffer* cmdbuf);
+    // Main thread.
+    TerrainStats Stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Request {
+        TerrainChunkCoord coord;
+        Clock::time_point requested;
+    };
+    struct GeneratedChunk {
+        Request request;
+        RenderableObject obj;
+        QuantizedMesh mesh; // for quantized heaps only
+        double generation_ms;
+    };
+    struct ResidentChunk {
+        std::uint32_t object;
+        GeometryHandle geometry;
+        std::uint64_t bytes;
+    };
+
+    void WorkerLoop();
+    bool InRange(TerrainChunkCoord coord, const glm::vec3& center, float radius) const;
+    void Evict(const glm::vec3& center, std::vector<RenderableObject>& objects, GeometryHeap& heap);
+    void QueueMissing(const glm::vec3& center);
+    void UploadFinished(const glm::vec3& center, std::vector<RenderableObject>& objects, GeometryHeap& heap,
+                        UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf);
+
+    TerrainSettings settings;
+    VertexFormat format;
+
+    // main thread only
+    GeometryHandle pattern = kNoGeometry;
+    std::uint64_t pattern_bytes = 0;
+    std::map<TerrainChunkCoord, ResidentChunk> resident;
+    std::set<TerrainChunkCoord> pending;  // queued, generating or in `finished`
+    std::vector<GeneratedChunk> finished; // taken from `generated`, waiting for upload budget
+    std::vector<std::uint32_t> free_objects;
+    std::vector<std::pair<float, TerrainChunkCoord>> missing; // QueueMissing() scratch: (distance squared, chunk)
+    TerrainStats stats;
+
+    std::mutex mutex;
+    std::condition_variable wake; // work queued or stopping
+    std::deque<Request> queue;
+    std::vector<GeneratedChunk> generated;
+    bool stopping = false;
+    std::vector<std::thread> workers; // last, so everything above exists before they start
+};
+
+void PrintTerrainReport(const TerrainStats& stats);
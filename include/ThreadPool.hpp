@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Work-stealing job system. Every thread that runs jobs has its own deque: it pushes and pops its own jobs at the
+// back (newest first, while their data is still in cache) and idle threads steal from the front of the others'
+// (oldest first, which for split ranges are the largest pieces). Jobs count down a JobCounter when they finish, so
+// a parent spawns its children against one counter and Wait()s on it; a waiting thread keeps running queued jobs,
+// its own and stolen ones, instead of blocking, so nested waits never starve the pool. A job that throws still
+// counts down; the first exception thrown by a counter's jobs is rethrown from Wait() once all of them have finished
+// (from ParallelFor() too), and any later ones are dropped.
+//
+// Threads outside the pool (main, simulation) join in whenever they call ParallelFor, Spawn or Wait, each under a
+// thread index of its own handed out on first use, lowest free first, and handed back when the thread exits. At most
+// kMaxExternalThreads live threads may use a pool at once (std::logic_error past that); the pool's own workers
+// follow them. No two threads share an index, so indices in [0, ThreadCount()) can pick per-thread scratch, but a
+// thread waiting inside a job may run more jobs under the same index, so scratch must not be held across a nested
+// ParallelFor or Wait.
+struct JobCounter {
+    std::atomic<std::size_t> pending{0};
+    std::atomic<bool> failed{false}; // set by the first job to throw, which then stores `error`
+    std::exception_ptr error;
+};
+
+// A non-owning reference to a callable, which must outlive it. Wrapping a lambda in one never allocates, where a
+// std::function would for any lambda capturing more than two pointers.
+template <class Signature>
+class FunctionRef;
+template <class R, class... Args>
+class FunctionRef<R(Args...)> {
+public:
+    template <class F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& callable) noexcept // NOLINT(google-explicit-constructor): takes lambdas as std::function does
+        : object(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+          invoke([](void* object, Args... args) -> R {
+              return std::invoke(*static_cast<std::remove_reference_t<F>*>(object), std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const {
+        return invoke(object, std::forward<Args>(args)...);
+    }
+
+private:
+    void* object;
+    R (*invoke)(void*, Args...);
+};
+
+class ThreadPool {
+public:
+    // (begin, end, thread_index) where thread_index is in [0, ThreadCount()); ParallelFor() blocks until every piece
+    // has run, so it only needs a reference to the caller's lambda
+    using RangeTask = FunctionRef<void(std::size_t, std::size_t, unsigned)>;
+    using JobTask = std::function<void(unsigned)>;
+
+    static constexpr unsigned kMaxExternalThreads = 4;
+
+    // A pool of N threads has N - 1 workers; the threads calling into it make up the rest.
+    explicit ThreadPool(unsigned thread_count = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned WorkerCount() const {
+        return static_cast<unsigned>(workers.size());
+    }
+    // Thread indices, not threads: workers plus the slots external threads may take.
+    unsigned ThreadCount() const {
+        return WorkerCount() + kMaxExternalThreads;
+    }
+
+    // Splits [0, count) in halves until pieces are at most `grain` items, spreading them as jobs, and blocks
+    // (helping) until all of them have run. Safe to call from any thread and from inside jobs.
+    void ParallelFor(std::size_t count, std::size_t grain, RangeTask task);
+
+    // Queues task on the calling thread's deque. The task must stay alive until Wait(counter) returns.
+    void Spawn(JobCounter& counter, const JobTask& task);
+    // Runs queued jobs until every job spawned against counter has finished, then rethrows the first exception any
+    // of them threw and resets the counter's error.
+    void Wait(JobCounter& counter);
+
+private:
+    struct Job {
+        const RangeTask* range = nullptr; // a range job when set, else task
+        const JobTask* task = nullptr;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        std::size_t grain = 1;
+        JobCounter* counter = nullptr;
+    };
+    static constexpr std::size_t kInitialQueueCapacity = 256;
+    // A ring over a power-of-two vector, grown when full and never shrunk, so steady-state pushes do not allocate
+    // the way a std::deque's blocks do.
+    struct alignas(64) JobQueue {
+        std::mutex mutex;
+        std::vector<Job> ring = std::vector<Job>(kInitialQueueCapacity);
+        std::size_t front = 0; // oldest job
+        std::size_t size = 0;
+    };
+
+    // The external indices in use. Threads hold a reference too, so one that outlives the pool can still hand its
+    // index back when it exits.
+    struct ExternalSlots {
+        std::mutex mutex;
+        std::array<bool, kMaxExternalThreads> taken{};
+    };
+    // One per thread: the external indices it holds in any pool, released by the destructor at thread exit.
+    struct HeldExternalSlots {
+        std::vector<std::pair<std::shared_ptr<ExternalSlots>, unsigned>> held;
+        HeldExternalSlots() = default;
+        ~HeldExternalSlots();
+        HeldExternalSlots(const HeldExternalSlots&) = delete;
+        HeldExternalSlots& operator=(const HeldExternalSlots&) = delete;
+    };
+
+    void WorkerLoop(unsigned thread_index);
+    // The calling thread's index, assigning an external slot on first use.
+    unsigned EnterThread();
+    void Push(unsigned thread_index, const Job& job);
+    bool PopOrSteal(unsigned thread_index, Job& job);
+    void Run(unsigned thread_index, Job job);
+
+    std::vector<std::unique_ptr<JobQueue>> queues; // one per thread index
+    std::atomic<std::size_t> queued{0};            // jobs sitting in any deque
+    std::atomic<unsigned> sleeping{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::shared_ptr<ExternalSlots> external_slots = std::make_shared<ExternalSlots>();
+
+    std::vector<std::thread> workers; // last, so everything above exists before they start
+};
+
+// Shared pool sized to the machine, created on first use.
+ThreadPool& GetThreadPool();
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+// Parent/child transforms with local translation, rotation (unit quaternion) and scale kept as flat SoA arrays.
+// Nodes stay in topological order: a node's parent always has a lower index, so one forward scan sees every parent
+// before its children. Setters only mark a node dirty. UpdateTransforms() then finds the dirty nodes and everything
+// below them, builds their local matrices in one branch-free batch kernel, and composes world matrices one depth
+// at a time, each depth split across the pool.
+using TransformHandle = std::uint32_t;
+inline constexpr TransformHandle kNoTransform = ~0u;
+
+struct TransformHierarchy {
+    std::vector<float> translation_x, translation_y, translation_z;
+    std::vector<float> rotation_x, rotation_y, rotation_z, rotation_w;
+    std::vector<float> scale_x, scale_y, scale_z;
+    std::vector<TransformHandle> parent; // kNoTransform for roots
+    std::vector<std::uint32_t> depth;    // roots are 0
+
+    std::vector<std::uint8_t> dirty;         // local TRS changed since the last update
+    std::vector<std::uint8_t> world_changed; // world matrix rewritten by the last update
+    std::vector<glm::mat4> world;
+
+    // scratch for UpdateTransforms(): the nodes being recomposed, grouped by depth, and their local matrices as
+    // rows 0..2 in the same order (row r, column c at local[r * 4 + c])
+    std::vector<TransformHandle> updated;
+    std::vector<std::uint32_t> depth_offsets;
+    std::vector<std::uint32_t> depth_cursors; // next free slot in each depth's run while sorting
+    std::array<std::vector<float>, 12> local;
+};
+
+// `parent` must already exist, which keeps the hierarchy in topological order.
+TransformHandle AddTransform(TransformHierarchy& transforms, TransformHandle parent = kNoTransform,
+                             glm::vec3 translation = glm::vec3{0.0f},
+                             glm::quat rotation = glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                             glm::vec3 scale = glm::vec3{1.0f});
+
+glm::vec3 GetTranslation(const TransformHierarchy& transforms, TransformHandle handle);
+glm::quat GetRotation(const TransformHierarchy& transforms, TransformHandle handle);
+glm::vec3 GetScale(const TransformHierarchy& transforms, TransformHandle handle);
+void SetTranslation(TransformHierarchy& transforms, TransformHandle handle, glm::vec3 translation);
+void SetRotation(TransformHierarchy& transforms, TransformHandle handle, glm::quat rotation);
+void SetScale(TransformHierarchy& transforms, TransformHandle handle, glm::vec3 scale);
+
+// The batch kernel: local = T * R * S for nodes[0..count), written to rows[r * 4 + c][0..count).
+void ComposeLocalMatrices(const TransformHierarchy& transforms, const TransformHandle* nodes, std::size_t count,
+                          const std::array<float*, 12>& rows);
+
+// Recomputes world matrices under every dirty node, clears the dirty flags and sets world_changed for the nodes
+// it rewrote.
+void UpdateTransforms(TransformHierarchy& transforms, ThreadPool& pool);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer, single-consumer hand-off of the newest value. The writer fills its back slot and
+// publishes it by swapping it with the shared middle slot; the reader swaps its front slot with the middle one only
+// when something new has been published. Neither side ever waits, and a slot is never touched by both at once, so
+// the value the reader holds stays unchanged until its next Update().
+template <typename T>
+class TripleBuffer {
+public:
+    // writer side
+    T& WriteBuffer() {
+        return slots[back];
+    }
+    void Publish() {
+        back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // reader side: true if ReadBuffer() now holds a value published since the last call
+    bool Update() {
+        if ((middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& ReadBuffer() const {
+        return slots[front];
+    }
+
+private:
+    static constexpr std::uint8_t kIndexMask = 0x3;
+    static constexpr std::uint8_t kFresh = 0x4;
+
+    std::array<T, 3> slots{};
+    std::atomic<std::uint8_t> middle{1}; // slot index, plus kFresh until the reader takes it
+    std::uint8_t back = 0;               // owned by the writer
+    std::uint8_t front = 2;              // owned by the reader
+};
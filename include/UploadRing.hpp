@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A persistent upload transfer buffer used as a ring. Any subsystem can reserve space during a frame with
+// WriteUpload(); FlushUploadRing() records everything written so far into one copy pass, merging consecutive writes
+// to the same destination buffer into single SDL_UploadToGPUBuffer calls. Each submitted frame hands its fence to
+// RetireUploadRingFrame() and the frame's bytes are reclaimed once that fence signals, so writers only ever wait when
+// every byte of the ring is still owned by the GPU (counted as a stall). If a single frame needs more than the whole
+// ring, the ring grows instead.
+//
+// The ring keeps the fence of every retired frame, uploads or not, until it signals, so it also knows how many frames
+// the GPU has yet to finish; WaitForUploadRingFrames() bounds that number for frame pacing.
+struct UploadRingStats {
+    std::uint64_t bytes_uploaded = 0;
+    std::uint64_t upload_calls = 0; // SDL_UploadToGPUBuffer calls after coalescing
+    std::uint64_t stalls = 0;       // waits on an in-flight frame's fence for space
+    std::uint64_t growths = 0;
+};
+struct PendingUpload {
+    SDL_GPUTransferBuffer* source;
+    std::uint32_t source_offset;
+    SDL_GPUBuffer* destination;
+    std::uint32_t destination_offset;
+    std::uint32_t size;
+    bool cycle;
+};
+// A transfer buffer the ring grew out of this frame, kept, and kept mapped if it was, until the next flush.
+struct OutgrownTransferBuffer {
+    SDL_GPUTransferBuffer* buffer;
+    bool mapped;
+};
+struct InFlightUploads {
+    SDL_GPUFence* fence;
+    std::uint64_t end; // ring position just past the frame's last write; frames without uploads end where they began
+};
+struct UploadRing {
+    SDL_GPUDevice* device = nullptr;
+    SDL_GPUTransferBuffer* transfer_buffer = nullptr;
+    std::uint32_t capacity = 0;
+    std::byte* mapped = nullptr;
+
+    // monotonically increasing positions; the physical offset is position % capacity
+    std::uint64_t write_position = 0;
+    std::uint64_t retired_position = 0;
+    std::uint64_t frame_start = 0;
+
+    std::vector<InFlightUploads> in_flight; // oldest first; a few frames, so popping the front is cheap
+    std::vector<PendingUpload> pending;
+    std::vector<OutgrownTransferBuffer> outgrown; // released once their pending uploads are recorded
+
+    UploadRingStats frame_stats; // since the last RetireUploadRingFrame()
+    UploadRingStats last_frame_stats;
+    UploadRingStats total_stats;
+};
+
+UploadRing CreateUploadRing(SDL_GPUDevice* device, std::uint32_t capacity);
+void DestroyUploadRing(UploadRing& ring);
+
+// Reserves `size` bytes that will be copied to destination at destination_offset on the next flush. The returned
+// pointer is valid until then, even if a later reservation grows the ring: the buffer it points into stays mapped
+// until the flush. With cycle set, a destination still in use by an earlier frame is swapped for a fresh
+// one instead of waited on; only use it for buffers whose whole used range is rewritten in the same flush.
+void* WriteUpload(UploadRing& ring, SDL_GPUBuffer* destination, std::uint32_t destination_offset, std::uint32_t size,
+                  bool cycle = false);
+void UploadBytes(UploadRing& ring, SDL_GPUBuffer* destination, std::uint32_t destination_offset, const void* data,
+                 std::uint32_t size, bool cycle = false);
+void FlushUploadRing(UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf);
+// Takes ownership of the fence of the command buffer the frame's uploads were flushed into (may be null).
+void RetireUploadRingFrame(UploadRing& ring, SDL_GPUFence* fence);
+// Retired frames whose fences have not been seen to signal, after reclaiming those that have.
+std::size_t UploadRingFramesInFlight(UploadRing& ring);
+// Waits, oldest first, until at most `max_frames` retired frames are still on the GPU. Not counted as a stall.
+void WaitForUploadRingFrames(UploadRing& ring, std::size_t max_frames);
+void PrintUploadRingReport(const UploadRingStats& stats, std::size_t frame_count);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+// Vertex normal generation over SoA position streams. A vertex -> triangle-corner adjacency (CSR) is built once, so
+// face normals can be computed per triangle and then gathered per vertex on any number of threads without atomics or
+// scattered writes. Area weighting sums raw face cross products (what CalculateVertexNormals() always did); angle
+// weighting scales unit face normals by the corner angle at each vertex.
+enum class NormalWeighting {
+    Area,
+    Angle,
+};
+struct VertexNormalEngine {
+    NormalWeighting weighting = NormalWeighting::Area;
+
+    // SoA copies of RenderableObject::vertices[i].pos
+    std::vector<float> pos_x;
+    std::vector<float> pos_y;
+    std::vector<float> pos_z;
+
+    // per-triangle weighted face normal, SoA
+    std::vector<float> face_x;
+    std::vector<float> face_y;
+    std::vector<float> face_z;
+    std::vector<float> corner_angles; // 3 per triangle, angle weighting only
+
+    // vertex v's corners are corners[corner_offsets[v] .. corner_offsets[v + 1]), encoded as triangle * 3 + corner
+    std::vector<std::uint32_t> corner_offsets;
+    std::vector<std::uint32_t> corners;
+
+    // scratch for partial updates
+    std::vector<std::uint32_t> dirty_triangles;
+    std::vector<std::uint32_t> dirty_vertices;
+    std::vector<std::uint8_t> triangle_marks;
+    std::vector<std::uint8_t> vertex_marks;
+};
+
+// Copies positions into SoA streams and builds the adjacency. Call again if the index buffer changes.
+void BuildVertexNormalEngine(VertexNormalEngine& engine, const RenderableObject& obj, NormalWeighting weighting);
+// Recomputes every normal into obj.normals.
+void ComputeVertexNormals(VertexNormalEngine& engine, RenderableObject& obj, ThreadPool& pool);
+// Refreshes the given vertices' positions from obj.vertices and recomputes only the normals they can affect.
+void UpdateVertexNormals(VertexNormalEngine& engine, RenderableObject& obj, std::span<const std::uint32_t> changed,
+                         ThreadPool& pool);
+// One-off area-weighted normals for obj, on the shared pool.
+RenderableObject& CalculateVertexNormals(RenderableObject& obj);
+// The outward normal of triangle (a, b, c) under the meshes' winding, scaled by twice its area: cross(c - a, b - a).
+// The vertex normals above point the same way.
+glm::vec3 FaceNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Scene.hpp"
+
+// Compact vertex encoding for the GPU, chosen once per run (VertexFormat::Quantized) and produced at import time:
+//  - positions: 16-bit UNORM per axis relative to the object's bounding box. The box->object transform is returned
+//    as `dequantize` and folded into the model matrix, so the shader uses the stored value unchanged;
+//  - normals: octahedral encoding in 2 x 16-bit SNORM. The (-1, -1) corner decodes to the same direction as (1, 1)
+//    and is reserved for zero-length normals, which decode to zero as they stay in the float path;
+//  - color: unchanged UBYTE4_NORM.
+// 16 bytes per vertex across both streams instead of 28.
+enum class VertexFormat {
+    Float,     // PositionAndColorVertex + VertexNormal
+    Quantized, // QuantizedVertex + PackedNormal
+};
+struct QuantizedVertex {
+    std::uint16_t position[4]; // USHORT4_NORM, w unused
+    glm::u8vec4 color;
+};
+struct PackedNormal {
+    std::int16_t x, y; // SHORT2_NORM, octahedral
+};
+static_assert(sizeof(QuantizedVertex) == 12 && sizeof(PackedNormal) == 4);
+inline constexpr PackedNormal kZeroPackedNormal{-32767, -32767};
+
+struct QuantizationReport {
+    float max_position_error = 0.0f; // object-space units
+    float max_normal_error = 0.0f;   // degrees
+    std::size_t float_bytes = 0;
+    std::size_t quantized_bytes = 0;
+};
+struct QuantizedMesh {
+    std::vector<QuantizedVertex> vertices;
+    std::vector<PackedNormal> normals;
+    glm::mat4 dequantize{1.0f};
+    QuantizationReport report;
+};
+
+std::uint32_t VertexStride(VertexFormat format);
+std::uint32_t NormalStride(VertexFormat format);
+
+PackedNormal EncodeOctahedral(glm::vec3 normal);
+glm::vec3 DecodeOctahedral(PackedNormal packed);
+
+// Objects without per-vertex normals get zero normals, matching the float upload path.
+QuantizedMesh QuantizeMesh(const RenderableObject& obj);
+void PrintQuantizationReport(std::string_view name, const QuantizationReport& report);
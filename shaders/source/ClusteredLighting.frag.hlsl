@@ -0,0 +1,52 @@
+cbuffer ClusterData : register(b0, space3) {
+    float2 viewport_size : packoffset(c0.x); // pixels
+    float depth_scale : packoffset(c0.z);    // slice = log(view depth) * depth_scale + depth_bias
+    float depth_bias : packoffset(c0.w);
+    uint4 cluster_counts : packoffset(c1);   // tiles x, tiles y, depth slices, lights
+    float4 ambient : packoffset(c2);
+}
+
+// Clustered forward shading; see include/ClusteredLighting.hpp. The pixel and its view depth pick a froxel, and only
+// that froxel's lights are summed. Each light fades smoothly to nothing at its radius.
+struct PointLight {
+    float4 position_radius; // view space
+    float4 color_intensity;
+};
+StructuredBuffer<PointLight> Lights : register(t0, space2);
+StructuredBuffer<uint2> ClusterRanges : register(t1, space2); // offset and count into LightIndices, per froxel
+StructuredBuffer<uint> LightIndices : register(t2, space2);
+
+struct FragBufOut {
+    float4 Color : SV_Target0;
+    float Depth: SV_Depth;
+};
+
+FragBufOut main(float4 Color : TEXCOORD0, float3 ViewPosition : TEXCOORD1, float3 ViewNormal : TEXCOORD2,
+                float4 Position : SV_Position) {
+    float depth = -ViewPosition.z;
+    uint slice = (uint)clamp(floor(log(max(depth, 1e-6f)) * depth_scale + depth_bias), 0.0f,
+                             (float)(cluster_counts.z - 1));
+    uint2 tile = min((uint2)(Position.xy / viewport_size * (float2)cluster_counts.xy), cluster_counts.xy - 1);
+    uint2 range = ClusterRanges[(slice * cluster_counts.y + tile.y) * cluster_counts.x + tile.x];
+
+    float3 normal = normalize(ViewNormal);
+    float3 lit = ambient.rgb;
+    for (uint i = 0; i < range.y; ++i) {
+        PointLight light = Lights[LightIndices[range.x + i]];
+        float3 to_light = light.position_radius.xyz - ViewPosition;
+        float distance = length(to_light);
+        float ratio = distance / light.position_radius.w;
+        float falloff = saturate(1.0f - ratio * ratio);
+        lit += light.color_intensity.rgb * (light.color_intensity.w * falloff * falloff *
+                                            saturate(dot(normal, to_light / max(distance, 1e-4f))));
+    }
+
+    // Reinhard, so many overlapping lights saturate instead of clipping
+    float3 color = Color.rgb * lit;
+
+    FragBufOut output;
+    output.Color = float4(color / (1.0f + color), 1.0f);
+    output.Depth = Position.w;
+
+    return output;
+}
@@ -0,0 +1,34 @@
+#pragma pack_matrix(row_major)
+
+cbuffer CameraData : register(b0, space1) {
+    float4x4 view_matrix : packoffset(c0);
+    float4x4 proj_matrix : packoffset(c4);
+}
+
+// One model matrix per scene object. Instances find theirs through ObjectIndex, a per-instance vertex attribute,
+// since first_instance does not show up in SV_InstanceID the same way on every backend.
+StructuredBuffer<float4x4> ModelMatrices : register(t0, space0);
+
+struct VS_Input {
+    float3 Position : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+    float3 Normal : TEXCOORD2;
+    uint ObjectIndex : TEXCOORD3;
+};
+
+struct VS_Output {
+    float4 Color : TEXCOORD0;
+    float4 Position : SV_Position;
+};
+
+VS_Output main(VS_Input input) {
+    VS_Output output;
+
+    output.Color = float4((input.Normal.xyz + float3(1.0f, 1.0f, 1.0f))  * 0.5f, 1.0f);
+
+    float4 affine_position = float4(input.Position, 1.0f);
+    float4x4 mvp_matrix = mul(mul(ModelMatrices[input.ObjectIndex], view_matrix), proj_matrix);
+    output.Position = mul(affine_position, mvp_matrix);
+
+    return output;
+}
\ No newline at end of file
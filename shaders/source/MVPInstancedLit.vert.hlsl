@@ -0,0 +1,41 @@
+#pragma pack_matrix(row_major)
+
+cbuffer CameraData : register(b0, space1) {
+    float4x4 view_matrix : packoffset(c0);
+    float4x4 proj_matrix : packoffset(c4);
+}
+
+// MVPInstanced.vert for ClusteredLighting.frag: the vertex colour goes on as albedo, along with the view-space
+// position and normal the lighting needs. Normals turn with the model's axes, normalized, which is exact for
+// rotations and uniform scales.
+StructuredBuffer<float4x4> ModelMatrices : register(t0, space0);
+
+struct VS_Input {
+    float3 Position : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+    float3 Normal : TEXCOORD2;
+    uint ObjectIndex : TEXCOORD3;
+};
+
+struct VS_Output {
+    float4 Color : TEXCOORD0;
+    float3 ViewPosition : TEXCOORD1;
+    float3 ViewNormal : TEXCOORD2;
+    float4 Position : SV_Position;
+};
+
+VS_Output main(VS_Input input) {
+    VS_Output output;
+
+    float4x4 model_matrix = ModelMatrices[input.ObjectIndex];
+    float3x3 model_axes = float3x3(normalize(model_matrix[0].xyz), normalize(model_matrix[1].xyz),
+                                   normalize(model_matrix[2].xyz));
+    float4 view_position = mul(mul(float4(input.Position, 1.0f), model_matrix), view_matrix);
+
+    output.Color = input.Color;
+    output.ViewPosition = view_position.xyz;
+    output.ViewNormal = mul(float4(mul(input.Normal, model_axes), 0.0f), view_matrix).xyz;
+    output.Position = mul(view_position, proj_matrix);
+
+    return output;
+}
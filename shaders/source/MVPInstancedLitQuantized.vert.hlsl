@@ -0,0 +1,52 @@
+#pragma pack_matrix(row_major)
+
+cbuffer CameraData : register(b0, space1) {
+    float4x4 view_matrix : packoffset(c0);
+    float4x4 proj_matrix : packoffset(c4);
+}
+
+// MVPInstancedLit.vert for VertexFormat::Quantized. The model matrix also scales the [0, 1] box onto the object, so
+// normalizing its axes is what keeps that scale out of the normals.
+StructuredBuffer<float4x4> ModelMatrices : register(t0, space0);
+
+struct VS_Input {
+    float4 Position : TEXCOORD0; // USHORT4_NORM
+    float4 Color : TEXCOORD1;
+    float2 Normal : TEXCOORD2;   // SHORT2_NORM, octahedral
+    uint ObjectIndex : TEXCOORD3;
+};
+
+struct VS_Output {
+    float4 Color : TEXCOORD0;
+    float3 ViewPosition : TEXCOORD1;
+    float3 ViewNormal : TEXCOORD2;
+    float4 Position : SV_Position;
+};
+
+float3 DecodeOctahedral(float2 encoded) {
+    // the (-1, -1) corner is reserved for zero-length normals; (1, 1) encodes the same direction
+    if (all(encoded == float2(-1.0f, -1.0f))) {
+        return float3(0.0f, 0.0f, 0.0f);
+    }
+    float3 n = float3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-n.z);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+VS_Output main(VS_Input input) {
+    VS_Output output;
+
+    float4x4 model_matrix = ModelMatrices[input.ObjectIndex];
+    float3x3 model_axes = float3x3(normalize(model_matrix[0].xyz), normalize(model_matrix[1].xyz),
+                                   normalize(model_matrix[2].xyz));
+    float4 view_position = mul(mul(float4(input.Position.xyz, 1.0f), model_matrix), view_matrix);
+
+    output.Color = input.Color;
+    output.ViewPosition = view_position.xyz;
+    output.ViewNormal = mul(float4(mul(DecodeOctahedral(input.Normal), model_axes), 0.0f), view_matrix).xyz;
+    output.Position = mul(view_position, proj_matrix);
+
+    return output;
+}
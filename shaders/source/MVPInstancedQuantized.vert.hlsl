@@ -0,0 +1,46 @@
+#pragma pack_matrix(row_major)
+
+cbuffer CameraData : register(b0, space1) {
+    float4x4 view_matrix : packoffset(c0);
+    float4x4 proj_matrix : packoffset(c4);
+}
+
+// Same as MVPInstanced.vert, but for VertexFormat::Quantized. Positions arrive in [0, 1] of the object's bounding
+// box; the box -> object transform is already part of the model matrix.
+StructuredBuffer<float4x4> ModelMatrices : register(t0, space0);
+
+struct VS_Input {
+    float4 Position : TEXCOORD0; // USHORT4_NORM
+    float4 Color : TEXCOORD1;
+    float2 Normal : TEXCOORD2;   // SHORT2_NORM, octahedral
+    uint ObjectIndex : TEXCOORD3;
+};
+
+struct VS_Output {
+    float4 Color : TEXCOORD0;
+    float4 Position : SV_Position;
+};
+
+float3 DecodeOctahedral(float2 encoded) {
+    // the (-1, -1) corner is reserved for zero-length normals; (1, 1) encodes the same direction
+    if (all(encoded == float2(-1.0f, -1.0f))) {
+        return float3(0.0f, 0.0f, 0.0f);
+    }
+    float3 n = float3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-n.z);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+VS_Output main(VS_Input input) {
+    VS_Output output;
+
+    output.Color = float4((DecodeOctahedral(input.Normal) + float3(1.0f, 1.0f, 1.0f)) * 0.5f, 1.0f);
+
+    float4 affine_position = float4(input.Position.xyz, 1.0f);
+    float4x4 mvp_matrix = mul(mul(ModelMatrices[input.ObjectIndex], view_matrix), proj_matrix);
+    output.Position = mul(affine_position, mvp_matrix);
+
+    return output;
+}
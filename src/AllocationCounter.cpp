@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <new>
+
+#include "AllocationCounter.hpp"
+
+#ifdef TBDGAME_PROFILER
+namespace {
+    std::atomic<std::uint64_t> allocation_count{0};
+
+    void* Allocate(const std::size_t bytes) noexcept {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(std::max<std::size_t>(bytes, 1));
+    }
+
+    void* AllocateAligned(const std::size_t bytes, const std::align_val_t alignment) noexcept {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+        return _aligned_malloc(std::max<std::size_t>(bytes, 1), align);
+#else
+        // aligned_alloc wants a whole number of alignments
+        return std::aligned_alloc(align, (std::max<std::size_t>(bytes, 1) + align - 1) / align * align);
+#endif
+    }
+
+    void FreeAligned(void* memory) noexcept {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+
+    void* OrThrow(void* memory) {
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+}
+
+void* operator new(const std::size_t bytes) {
+    return OrThrow(Allocate(bytes));
+}
+void* operator new[](const std::size_t bytes) {
+    return OrThrow(Allocate(bytes));
+}
+void* operator new(const std::size_t bytes, const std::nothrow_t&) noexcept {
+    return Allocate(bytes);
+}
+void* operator new[](const std::size_t bytes, const std::nothrow_t&) noexcept {
+    return Allocate(bytes);
+}
+void* operator new(const std::size_t bytes, const std::align_val_t alignment) {
+    return OrThrow(AllocateAligned(bytes, alignment));
+}
+void* operator new[](const std::size_t bytes, const std::align_val_t alignment) {
+    return OrThrow(AllocateAligned(bytes, alignment));
+}
+void* operator new(const std::size_t bytes, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateAligned(bytes, alignment);
+}
+void* operator new[](const std::size_t bytes, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateAligned(bytes, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, std::align_val_t) noexcept {
+    FreeAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    FreeAligned(memory);
+}
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    FreeAligned(memory);
+}
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    FreeAligned(memory);
+}
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    FreeAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    FreeAligned(memory);
+}
+
+std::uint64_t CountedAllocations() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+#else
+std::uint64_t CountedAllocations() {
+    return 0;
+}
+#endif
+
+void RecordFrameAllocations(AllocationStats& stats, const std::uint64_t allocations) {
+    ++stats.frames;
+    stats.allocating_frames += allocations > 0 ? 1 : 0;
+    stats.allocations += allocations;
+    stats.worst_frame = std::max(stats.worst_frame, allocations);
+}
+
+void PrintAllocationReport(const AllocationStats& stats, const std::size_t warmup_frames) {
+    if (!AllocationCountingBuiltIn()) {
+        std::cout << "Heap allocations: not counted in this build\n";
+        return;
+    }
+    std::cout << std::format("Heap allocations over {} frames after {} of warm-up:\n", stats.frames, warmup_frames);
+    std::cout << std::format("  frames allocating {}  allocations {}  worst frame {}\n", stats.allocating_frames,
+                             stats.allocations, stats.worst_frame);
+}
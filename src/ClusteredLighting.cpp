@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <glm/gtc/constants.hpp>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "ClusteredLighting.hpp"
+#include "FrameStats.hpp"
+
+namespace {
+    constexpr std::size_t kLightGrain = 256;
+
+    SDL_GPUBuffer* CreateStorageBuffer(SDL_GPUDevice* device, const std::uint32_t size) {
+        const auto info = SDL_GPUBufferCreateInfo{.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+                                                  .size = std::max<std::uint32_t>(size, 16)};
+        auto buffer = SDL_CreateGPUBuffer(device, &info);
+        if (buffer == nullptr) {
+            throw std::runtime_error(SDL_GetError());
+        }
+        return buffer;
+    }
+
+    // Rewritten whole every frame, so nothing is carried over when a buffer grows.
+    template <typename T>
+    void UploadStorageVector(UploadRing& ring, SDL_GPUDevice* device, SDL_GPUBuffer*& buffer,
+                             std::uint32_t& capacity, const std::vector<T>& data) {
+        if (buffer == nullptr || data.size() > capacity) {
+            capacity = std::max(static_cast<std::uint32_t>(data.size()), capacity * 2);
+            SDL_ReleaseGPUBuffer(device, buffer);
+            buffer = CreateStorageBuffer(device, capacity * static_cast<std::uint32_t>(sizeof(T)));
+        }
+        UploadBytes(ring, buffer, 0, data.data(), static_cast<std::uint32_t>(data.size() * sizeof(T)), true);
+    }
+
+    float SliceDepth(const ClusterSettings& settings, const std::uint32_t slice) {
+        if (slice == 0) {
+            return 0.0f;
+        }
+        const auto t = static_cast<float>(slice) / static_cast<float>(settings.depth_slices);
+        return settings.near_depth * std::pow(settings.far_depth / settings.near_depth, t);
+    }
+
+    std::uint32_t SliceOf(const ClusterUniformData& uniforms, const std::uint32_t slices, const float depth) {
+        if (depth <= 0.0f) {
+            return 0;
+        }
+        const auto slice = std::floor(std::log(depth) * uniforms.depth_scale + uniforms.depth_bias);
+        return static_cast<std::uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(slices - 1)));
+    }
+
+    // Screen tile of an NDC coordinate along an axis of `tiles`; `flip` counts from the top, as pixels do in y.
+    std::uint32_t TileOf(float ndc, const std::uint32_t tiles, const bool flip) {
+        if (flip) {
+            ndc = -ndc;
+        }
+        const auto tile = std::floor((ndc + 1.0f) * 0.5f * static_cast<float>(tiles));
+        return static_cast<std::uint32_t>(std::clamp(tile, 0.0f, static_cast<float>(tiles - 1)));
+    }
+
+    void BuildFroxelBoxes(LightClusters& clusters, const glm::vec2 focal) {
+        const auto& s = clusters.settings;
+        const auto froxel_count = s.tiles_x * s.tiles_y * s.depth_slices;
+        clusters.box_min.resize(froxel_count);
+        clusters.box_max.resize(froxel_count);
+        for (std::uint32_t z = 0; z < s.depth_slices; ++z) {
+            const auto near_depth = SliceDepth(s, z);
+            const auto far_depth = z + 1 == s.depth_slices ? s.far_depth : SliceDepth(s, z + 1);
+            for (std::uint32_t y = 0; y < s.tiles_y; ++y) {
+                // tiles count down from the top of the screen
+                const auto ndc_top = 1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(s.tiles_y);
+                const auto ndc_bottom = 1.0f - 2.0f * static_cast<float>(y + 1) / static_cast<float>(s.tiles_y);
+                for (std::uint32_t x = 0; x < s.tiles_x; ++x) {
+                    const auto ndc_left = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(s.tiles_x);
+                    const auto ndc_right = -1.0f + 2.0f * static_cast<float>(x + 1) / static_cast<float>(s.tiles_x);
+                    // the froxel's corners at both depths; view x = ndc x * depth / proj[0][0], likewise for y
+                    auto lo = glm::vec3{std::numeric_limits<float>::max()};
+                    auto hi = glm::vec3{std::numeric_limits<float>::lowest()};
+                    for (const auto depth : {near_depth, far_depth}) {
+                        for (const auto ndc_x : {ndc_left, ndc_right}) {
+                            for (const auto ndc_y : {ndc_bottom, ndc_top}) {
+                                const auto corner = glm::vec3{ndc_x * depth / focal.x, ndc_y * depth / focal.y, -depth};
+                                lo = glm::min(lo, corner);
+                                hi = glm::max(hi, corner);
+                            }
+                        }
+                    }
+                    const auto froxel = (z * s.tiles_y + y) * s.tiles_x + x;
+                    clusters.box_min[froxel] = lo;
+                    clusters.box_max[froxel] = hi;
+                }
+            }
+        }
+        clusters.box_focal = focal;
+    }
+}
+
+LightField CreateLightField(const std::uint32_t count, const float extent, const float radius,
+                            const std::uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> across(-0.5f * extent, 0.5f * extent);
+    std::uniform_real_distribution<float> height(0.2f, 2.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> rate(-0.6f, 0.6f);
+
+    LightField field{};
+    field.lights.reserve(count);
+    field.orbit_rates.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        // saturated colours, so overlapping lights stay distinguishable
+        const auto hue = unit(random) * glm::two_pi<float>();
+        const auto color = glm::vec3{std::cos(hue), std::cos(hue - 2.0944f), std::cos(hue + 2.0944f)} * 0.5f + 0.5f;
+        field.lights.push_back(PointLight{.position = glm::vec3{across(random), height(random), across(random)},
+                                          .radius = radius * (0.75f + 0.5f * unit(random)),
+                                          .color = color,
+                                          .intensity = 1.0f});
+        field.orbit_rates.push_back(rate(random));
+    }
+    return field;
+}
+
+void OrbitLights(LightField& field, const float dt) {
+    for (std::size_t i = 0; i < field.lights.size(); ++i) {
+        auto& position = field.lights[i].position;
+        const auto angle = field.orbit_rates[i] * dt;
+        const auto c = std::cos(angle);
+        const auto s = std::sin(angle);
+        position = glm::vec3{c * position.x + s * position.z, position.y, -s * position.x + c * position.z};
+    }
+}
+
+LightClusters CreateLightClusters(SDL_GPUDevice* device, const ClusterSettings& settings) {
+    if (settings.tiles_x == 0 || settings.tiles_y == 0 || settings.depth_slices == 0 ||
+        settings.near_depth <= 0.0f || settings.far_depth <= settings.near_depth) {
+        throw std::invalid_argument("ClusterSettings: empty grid or depth range");
+    }
+    LightClusters clusters{};
+    clusters.settings = settings;
+    clusters.device = device;
+    const auto froxel_count = settings.tiles_x * settings.tiles_y * settings.depth_slices;
+    clusters.ranges.resize(froxel_count);
+    clusters.froxel_lights.resize(froxel_count);
+
+    const auto depth_scale =
+        static_cast<float>(settings.depth_slices) / std::log(settings.far_depth / settings.near_depth);
+    clusters.uniforms = ClusterUniformData{
+        .viewport_size = glm::vec2{1.0f},
+        .depth_scale = depth_scale,
+        .depth_bias = -std::log(settings.near_depth) * depth_scale,
+        .counts = glm::uvec4{settings.tiles_x, settings.tiles_y, settings.depth_slices, 0},
+        .ambient = glm::vec4{settings.ambient, 0.0f},
+    };
+    return clusters;
+}
+
+void DestroyLightClusters(LightClusters& clusters) {
+    SDL_ReleaseGPUBuffer(clusters.device, clusters.light_buffer);
+    SDL_ReleaseGPUBuffer(clusters.device, clusters.range_buffer);
+    SDL_ReleaseGPUBuffer(clusters.device, clusters.index_buffer);
+    clusters.light_buffer = nullptr;
+    clusters.range_buffer = nullptr;
+    clusters.index_buffer = nullptr;
+}
+
+void BuildLightClusters(LightClusters& clusters, const std::vector<PointLight>& lights, const glm::mat4& view,
+                        const glm::mat4& proj, const glm::vec2 viewport_size, ThreadPool& pool) {
+    const auto start = FrameClock::now();
+    const auto& s = clusters.settings;
+    const auto focal = glm::vec2{proj[0][0], proj[1][1]};
+    if (focal != clusters.box_focal) {
+        BuildFroxelBoxes(clusters, focal);
+    }
+    auto& uniforms = clusters.uniforms;
+    uniforms.viewport_size = viewport_size;
+    uniforms.counts.w = static_cast<std::uint32_t>(lights.size());
+
+    // each light in view space and the block of froxels its sphere's bounds can reach
+    clusters.lights.resize(lights.size());
+    clusters.light_tiles.resize(lights.size());
+    clusters.light_slices.resize(lights.size());
+    pool.ParallelFor(lights.size(), kLightGrain, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i) {
+            const auto& light = lights[i];
+            const auto center = glm::vec3{view * glm::vec4{light.position, 1.0f}};
+            const auto r = light.radius;
+            clusters.lights[i] = GpuPointLight{glm::vec4{center, r}, glm::vec4{light.color, light.intensity}};
+
+            const auto depth = -center.z;
+            auto& slices = clusters.light_slices[i];
+            if (depth + r <= 0.0f || depth - r >= s.far_depth) {
+                slices = glm::uvec2{1, 0};
+                continue;
+            }
+            slices = glm::uvec2{SliceOf(uniforms, s.depth_slices, depth - r),
+                                SliceOf(uniforms, s.depth_slices, depth + r)};
+
+            // a sphere reaching the near depth can cover any part of the screen
+            auto& tiles = clusters.light_tiles[i];
+            if (depth - r <= s.near_depth) {
+                tiles = glm::uvec4{0, s.tiles_x - 1, 0, s.tiles_y - 1};
+                continue;
+            }
+            // extremes of x / depth and y / depth over the sphere's view-space box
+            const auto near = depth - r;
+            const auto far = depth + r;
+            const auto low = [&](const float v) { return v >= 0.0f ? v / far : v / near; };
+            const auto high = [&](const float v) { return v >= 0.0f ? v / near : v / far; };
+            const auto ndc_min = glm::vec2{low(center.x - r), low(center.y - r)} * focal;
+            const auto ndc_max = glm::vec2{high(center.x + r), high(center.y + r)} * focal;
+            if (ndc_max.x < -1.0f || ndc_min.x > 1.0f || ndc_max.y < -1.0f || ndc_min.y > 1.0f) {
+                slices = glm::uvec2{1, 0};
+                continue;
+            }
+            tiles = glm::uvec4{TileOf(ndc_min.x, s.tiles_x, false), TileOf(ndc_max.x, s.tiles_x, false),
+                               TileOf(ndc_max.y, s.tiles_y, true), TileOf(ndc_min.y, s.tiles_y, true)};
+        }
+    });
+
+    // one slice per job: every froxel list belongs to exactly one slice
+    const auto slice_froxels = s.tiles_x * s.tiles_y;
+    pool.ParallelFor(s.depth_slices, 1, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto z = static_cast<std::uint32_t>(begin); z < end; ++z) {
+            for (std::uint32_t f = 0; f < slice_froxels; ++f) {
+                clusters.froxel_lights[z * slice_froxels + f].clear();
+            }
+            for (std::uint32_t i = 0; i < lights.size(); ++i) {
+                const auto slices = clusters.light_slices[i];
+                if (z < slices.x || z > slices.y) {
+                    continue;
+                }
+                const auto tiles = clusters.light_tiles[i];
+                const auto& light = clusters.lights[i].position_radius;
+                const auto center = glm::vec3{light};
+                const auto radius_squared = light.w * light.w;
+                for (auto y = tiles.z; y <= tiles.w; ++y) {
+                    for (auto x = tiles.x; x <= tiles.y; ++x) {
+                        const auto froxel = (z * s.tiles_y + y) * s.tiles_x + x;
+                        const auto closest = glm::clamp(center, clusters.box_min[froxel], clusters.box_max[froxel]);
+                        const auto offset = closest - center;
+                        if (glm::dot(offset, offset) <= radius_squared) {
+                            clusters.froxel_lights[froxel].push_back(i);
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    // compact: offsets in froxel order, then every slice copies its lists in parallel
+    std::uint32_t total = 0;
+    auto& stats = clusters.frame_stats;
+    stats = ClusterStats{.froxels = clusters.froxel_lights.size()};
+    for (std::size_t froxel = 0; froxel < clusters.froxel_lights.size(); ++froxel) {
+        const auto count = static_cast<std::uint32_t>(clusters.froxel_lights[froxel].size());
+        clusters.ranges[froxel] = glm::uvec2{total, count};
+        total += count;
+        stats.occupied += count > 0 ? 1 : 0;
+        stats.max_lights = std::max(stats.max_lights, count);
+    }
+    clusters.light_indices.resize(total);
+    pool.ParallelFor(s.depth_slices, 1, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto froxel = begin * slice_froxels; froxel < end * slice_froxels; ++froxel) {
+            const auto& list = clusters.froxel_lights[froxel];
+            std::copy(list.begin(), list.end(), clusters.light_indices.begin() + clusters.ranges[froxel].x);
+        }
+    });
+
+    stats.assignments = total;
+    stats.lights = static_cast<std::uint64_t>(std::ranges::count_if(
+        clusters.light_slices, [](const glm::uvec2 slices) { return slices.x <= slices.y; }));
+    stats.build_ms = MillisecondsBetween(start, FrameClock::now());
+
+    auto& totals = clusters.total_stats;
+    totals.build_ms += stats.build_ms;
+    totals.froxels += stats.froxels;
+    totals.lights += stats.lights;
+    totals.assignments += stats.assignments;
+    totals.occupied += stats.occupied;
+    totals.max_lights = std::max(totals.max_lights, stats.max_lights);
+}
+
+void UploadLightClusters(LightClusters& clusters, UploadRing& ring) {
+    UploadStorageVector(ring, clusters.device, clusters.light_buffer, clusters.light_capacity, clusters.lights);
+    UploadStorageVector(ring, clusters.device, clusters.range_buffer, clusters.range_capacity, clusters.ranges);
+    UploadStorageVector(ring, clusters.device, clusters.index_buffer, clusters.index_capacity,
+                        clusters.light_indices);
+}
+
+void BindLightClusters(SDL_GPURenderPass* pass, SDL_GPUCommandBuffer* cmdbuf, const LightClusters& clusters) {
+    SDL_GPUBuffer* buffers[] = {clusters.light_buffer, clusters.range_buffer, clusters.index_buffer};
+    SDL_BindGPUFragmentStorageBuffers(pass, 0, buffers, 3);
+    SDL_PushGPUFragmentUniformData(cmdbuf, 0, &clusters.uniforms, sizeof(ClusterUniformData));
+}
+
+void PrintClusterReport(const ClusterStats& stats, const std::size_t frame_count) {
+    const auto frames = static_cast<double>(std::max<std::size_t>(frame_count, 1));
+    const auto froxels = static_cast<double>(std::max<std::uint64_t>(stats.froxels, 1));
+    const auto occupied = static_cast<double>(std::max<std::uint64_t>(stats.occupied, 1));
+    std::cout << std::format("Clustered lighting over {} frames ({} froxels):\n", frame_count,
+                             static_cast<std::uint64_t>(static_cast<double>(stats.froxels) / frames));
+    std::cout << std::format("  build {:.3f} ms/frame  lights in view/frame {:.1f}\n", stats.build_ms / frames,
+                             static_cast<double>(stats.lights) / frames);
+    std::cout << std::format("  lights/froxel {:.2f}  over occupied froxels {:.2f}  max {}\n",
+                             static_cast<double>(stats.assignments) / froxels,
+                             static_cast<double>(stats.assignments) / occupied, stats.max_lights);
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "DrawList.hpp"
+
+namespace {
+    // per PackDrawList() job; about what one core copies in a few tens of microseconds
+    constexpr std::size_t kPackBlockBytes = 256 * 1024;
+
+    SDL_GPUBuffer* CreateBuffer(SDL_GPUDevice* device, const SDL_GPUBufferUsageFlags usage, const std::uint32_t size) {
+        const auto info = SDL_GPUBufferCreateInfo{.usage = usage, .size = std::max<std::uint32_t>(size, 4)};
+        auto buffer = SDL_CreateGPUBuffer(device, &info);
+        if (buffer == nullptr) {
+            throw std::runtime_error(SDL_GetError());
+        }
+        return buffer;
+    }
+
+    // Contents are rewritten every frame, so nothing needs to be carried over when a buffer grows.
+    void EnsureCapacity(SDL_GPUDevice* device, SDL_GPUBuffer*& buffer, std::uint32_t& capacity,
+                        const std::size_t required, const SDL_GPUBufferUsageFlags usage,
+                        const std::uint32_t element_size) {
+        if (required <= capacity) {
+            return;
+        }
+        capacity = std::max(static_cast<std::uint32_t>(required), capacity * 2);
+        SDL_ReleaseGPUBuffer(device, buffer);
+        buffer = CreateBuffer(device, usage, capacity * element_size);
+    }
+
+    template <typename T>
+    std::byte* ReserveVector(UploadRing& ring, SDL_GPUBuffer* buffer, const std::vector<T>& data) {
+        return static_cast<std::byte*>(
+            WriteUpload(ring, buffer, 0, static_cast<std::uint32_t>(data.size() * sizeof(T)), true));
+    }
+}
+
+DrawBuffers CreateDrawBuffers(SDL_GPUDevice* device, const std::uint32_t object_capacity) {
+    DrawBuffers buffers{};
+    buffers.device = device;
+    EnsureCapacity(device, buffers.models, buffers.model_capacity, object_capacity,
+                   SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ, sizeof(glm::mat4));
+    EnsureCapacity(device, buffers.instances, buffers.instance_capacity, object_capacity, SDL_GPU_BUFFERUSAGE_VERTEX,
+                   sizeof(std::uint32_t));
+    EnsureCapacity(device, buffers.commands, buffers.command_capacity, object_capacity, SDL_GPU_BUFFERUSAGE_INDIRECT,
+                   sizeof(SDL_GPUIndexedIndirectDrawCommand));
+    return buffers;
+}
+
+void DestroyDrawBuffers(DrawBuffers& buffers) {
+    SDL_ReleaseGPUBuffer(buffers.device, buffers.models);
+    SDL_ReleaseGPUBuffer(buffers.device, buffers.instances);
+    SDL_ReleaseGPUBuffer(buffers.device, buffers.commands);
+    buffers = DrawBuffers{};
+}
+
+void BuildDrawList(DrawList& list, const GeometryHeap& heap, const std::vector<RenderableObject>& objects,
+                   const std::vector<std::uint32_t>& visible_objects, const std::vector<std::uint8_t>& object_lods) {
+    list.models.resize(objects.size());
+    list.instances.clear();
+    list.commands.clear();
+    list.batches.clear();
+    list.order.clear();
+
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        list.models[i] = objects[i].model * objects[i].vertex_transform;
+    }
+    for (const auto object : visible_objects) {
+        if (objects[object].geometry != kNoGeometry) {
+            list.order.push_back(object);
+        }
+    }
+
+    // by index width first so each batch is one contiguous run of commands, then by mesh and level so instances
+    // collapse
+    const auto index_size = [&](const std::uint32_t object) {
+        return heap.allocations[objects[object].geometry].index_size;
+    };
+    const auto lod = [&](const std::uint32_t object) -> std::uint32_t {
+        return object < object_lods.size() ? object_lods[object] : 0;
+    };
+    std::sort(list.order.begin(), list.order.end(), [&](const std::uint32_t a, const std::uint32_t b) {
+        if (index_size(a) != index_size(b)) {
+            return index_size(a) < index_size(b);
+        }
+        if (objects[a].geometry != objects[b].geometry) {
+            return objects[a].geometry < objects[b].geometry;
+        }
+        if (lod(a) != lod(b)) {
+            return lod(a) < lod(b);
+        }
+        return a < b;
+    });
+
+    for (const auto object : list.order) {
+        const auto geometry = objects[object].geometry;
+        const bool same_mesh = !list.instances.empty() && objects[list.instances.back()].geometry == geometry &&
+                               lod(list.instances.back()) == lod(object);
+        if (same_mesh) {
+            ++list.commands.back().num_instances;
+        }
+        else {
+            auto command = GeometryDrawCommand(heap, geometry, lod(object));
+            command.first_instance = static_cast<std::uint32_t>(list.instances.size());
+            list.commands.push_back(command);
+
+            if (list.batches.empty() || list.batches.back().index_size != index_size(object)) {
+                list.batches.push_back(
+                    DrawBatch{index_size(object), static_cast<std::uint32_t>(list.commands.size() - 1), 0});
+            }
+            ++list.batches.back().command_count;
+        }
+        list.instances.push_back(object);
+    }
+}
+
+void PackDrawList(const DrawList& list, const std::array<std::byte*, 3>& targets, ThreadPool& pool) {
+    const std::array<const void*, 3> sources{list.models.data(), list.instances.data(), list.commands.data()};
+    const std::array<std::size_t, 3> sizes{list.models.size() * sizeof(glm::mat4),
+                                           list.instances.size() * sizeof(std::uint32_t),
+                                           list.commands.size() * sizeof(SDL_GPUIndexedIndirectDrawCommand)};
+    // blocks are numbered across all three arrays, so one loop spreads them over the pool
+    std::array<std::size_t, 4> first_block{};
+    for (std::size_t i = 0; i < 3; ++i) {
+        const auto blocks = targets[i] != nullptr ? (sizes[i] + kPackBlockBytes - 1) / kPackBlockBytes : 0;
+        first_block[i + 1] = first_block[i] + blocks;
+    }
+    pool.ParallelFor(first_block[3], 1, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto block = begin; block < end; ++block) {
+            const auto array = static_cast<std::size_t>(
+                std::upper_bound(first_block.begin() + 1, first_block.end(), block) - first_block.begin() - 1);
+            const auto offset = (block - first_block[array]) * kPackBlockBytes;
+            std::memcpy(targets[array] + offset, static_cast<const std::byte*>(sources[array]) + offset,
+                        std::min(kPackBlockBytes, sizes[array] - offset));
+        }
+    });
+}
+
+void UploadDrawList(DrawBuffers& buffers, UploadRing& ring, const DrawList& list, ThreadPool& pool) {
+    EnsureCapacity(buffers.device, buffers.models, buffers.model_capacity, list.models.size(),
+                   SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ, sizeof(glm::mat4));
+    EnsureCapacity(buffers.device, buffers.instances, buffers.instance_capacity, list.instances.size(),
+                   SDL_GPU_BUFFERUSAGE_VERTEX, sizeof(std::uint32_t));
+    EnsureCapacity(buffers.device, buffers.commands, buffers.command_capacity, list.commands.size(),
+                   SDL_GPU_BUFFERUSAGE_INDIRECT, sizeof(SDL_GPUIndexedIndirectDrawCommand));
+
+    // each region is filled before the next is reserved, so no ring pointer is held across a reservation that could
+    // grow the ring
+    PackDrawList(list, {ReserveVector(ring, buffers.models, list.models), nullptr, nullptr}, pool);
+    PackDrawList(list, {nullptr, ReserveVector(ring, buffers.instances, list.instances), nullptr}, pool);
+    PackDrawList(list, {nullptr, nullptr, ReserveVector(ring, buffers.commands, list.commands)}, pool);
+}
+
+void RecordDrawList(SDL_GPURenderPass* pass, const DrawBuffers& buffers, const DrawList& list,
+                    const GeometryHeap& heap) {
+    if (list.commands.empty()) {
+        return;
+    }
+
+    SDL_BindGPUVertexStorageBuffers(pass, 0, &buffers.models, 1);
+    const auto instance_bind = SDL_GPUBufferBinding{.buffer = buffers.instances, .offset = 0};
+    SDL_BindGPUVertexBuffers(pass, kInstanceBufferSlot, &instance_bind, 1);
+
+    for (const auto& batch : list.batches) {
+        const auto index_bind = SDL_GPUBufferBinding{.buffer = GeometryIndexBuffer(heap, batch.index_size), .offset = 0};
+        SDL_BindGPUIndexBuffer(pass, &index_bind, batch.index_size);
+        SDL_DrawGPUIndexedPrimitivesIndirect(pass, buffers.commands,
+                                             batch.first_command * sizeof(SDL_GPUIndexedIndirectDrawCommand),
+                                             batch.command_count);
+    }
+}
+
+std::uint64_t CountDrawListTriangles(const DrawList& list) {
+    std::uint64_t triangles = 0;
+    for (const auto& command : list.commands) {
+        triangles += static_cast<std::uint64_t>(command.num_indices / 3) * command.num_instances;
+    }
+    return triangles;
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <iostream>
+
+#include "FrameArena.hpp"
+
+LinearArena::LinearArena() : LinearArena(kFrameArenaInitialBytes) {}
+
+LinearArena::LinearArena(const std::size_t capacity)
+    : buffer(capacity > 0 ? std::make_unique<std::byte[]>(capacity) : nullptr), capacity(capacity) {}
+
+LinearArena::~LinearArena() {
+    for (const auto& spill : spills) {
+        std::pmr::new_delete_resource()->deallocate(spill.memory, spill.bytes, spill.alignment);
+    }
+}
+
+void LinearArena::Reset() {
+    if (!spills.empty()) {
+        for (const auto& spill : spills) {
+            std::pmr::new_delete_resource()->deallocate(spill.memory, spill.bytes, spill.alignment);
+        }
+        spills.clear();
+        capacity = std::bit_ceil(Used());
+        buffer = std::make_unique<std::byte[]>(capacity);
+    }
+    offset = 0;
+    spilled = 0;
+}
+
+void* LinearArena::do_allocate(const std::size_t bytes, const std::size_t alignment) {
+    const auto base = reinterpret_cast<std::uintptr_t>(buffer.get());
+    const auto aligned = (base + offset + alignment - 1) & ~(std::uintptr_t{alignment} - 1);
+    const auto end = aligned - base + bytes;
+    if (buffer != nullptr && end <= capacity) {
+        offset = end;
+        return reinterpret_cast<void*>(aligned);
+    }
+    auto* memory = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    spills.push_back(Spill{memory, bytes, alignment});
+    spilled += bytes;
+    return memory;
+}
+
+std::pmr::memory_resource& BeginArenaFrame(FrameArena& arena) {
+    arena.current = (arena.current + 1) % kFrameArenaCount;
+    auto& frame = arena.arenas[arena.current];
+    frame.Reset();
+    return frame;
+}
+
+void EndArenaFrame(FrameArena& arena) {
+    const auto& frame = arena.arenas[arena.current];
+    const auto used = static_cast<std::uint64_t>(frame.Used());
+    arena.frame_stats = FrameArenaStats{
+        .frames = 1,
+        .bytes = used,
+        .high_water = used,
+        .spilled_frames = frame.Spilled() > 0 ? 1u : 0u,
+    };
+
+    auto& total = arena.total_stats;
+    total.frames += 1;
+    total.bytes += used;
+    total.high_water = std::max(total.high_water, used);
+    total.spilled_frames += arena.frame_stats.spilled_frames;
+}
+
+void PrintFrameArenaReport(const FrameArenaStats& stats) {
+    const auto frames = static_cast<double>(std::max<std::uint64_t>(stats.frames, 1));
+    std::cout << std::format("Frame arena over {} frames:\n", stats.frames);
+    std::cout << std::format("  bytes/frame {:10.1f}  high water {} bytes  frames spilled to the heap {}\n",
+                             static_cast<double>(stats.bytes) / frames, stats.high_water, stats.spilled_frames);
+}
@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include "FrameCapture.hpp"
+#include "FrameStats.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    constexpr std::uint8_t kPngSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    constexpr std::size_t kStoredBlockBytes = 65535; // the most one uncompressed deflate block holds
+
+    constexpr auto kCrcTable = [] {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t n = 0; n < table.size(); ++n) {
+            auto c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    std::uint32_t Crc32(const std::uint8_t* data, const std::size_t size) {
+        auto crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; ++i) {
+            crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    std::uint32_t Adler32(const std::uint8_t* data, const std::size_t size) {
+        constexpr std::uint32_t kModulus = 65521;
+        constexpr std::size_t kRun = 5552; // the most bytes before the sums can overflow 32 bits
+        std::uint32_t a = 1;
+        std::uint32_t b = 0;
+        for (std::size_t begin = 0; begin < size; begin += kRun) {
+            const auto end = std::min(size, begin + kRun);
+            for (auto i = begin; i < end; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= kModulus;
+            b %= kModulus;
+        }
+        return (b << 16) | a;
+    }
+
+    void AppendBigEndian(std::vector<std::uint8_t>& out, const std::uint32_t value) {
+        out.insert(out.end(), {static_cast<std::uint8_t>(value >> 24), static_cast<std::uint8_t>(value >> 16),
+                               static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value)});
+    }
+
+    // Appends a chunk's length placeholder and type; EndPngChunk() fills the length in and appends the CRC.
+    std::size_t BeginPngChunk(std::vector<std::uint8_t>& out, const char (&type)[5]) {
+        const auto start = out.size();
+        AppendBigEndian(out, 0);
+        out.insert(out.end(), type, type + 4);
+        return start;
+    }
+
+    void EndPngChunk(std::vector<std::uint8_t>& out, const std::size_t start) {
+        const auto length = static_cast<std::uint32_t>(out.size() - start - 8);
+        for (int i = 0; i < 4; ++i) {
+            out[start + i] = static_cast<std::uint8_t>(length >> (24 - 8 * i));
+        }
+        AppendBigEndian(out, Crc32(out.data() + start + 4, length + 4));
+    }
+
+    // 8-bit RGB with every row unfiltered, in a zlib stream of stored blocks.
+    void EncodePng(std::vector<std::uint8_t>& out, std::vector<std::uint8_t>& scanlines, const std::uint8_t* pixels,
+                   const std::uint32_t width, const std::uint32_t height, const bool bgra) {
+        const auto row_bytes = 1 + std::size_t{width} * 3;
+        scanlines.resize(row_bytes * height);
+        for (std::uint32_t y = 0; y < height; ++y) {
+            auto* row = scanlines.data() + y * row_bytes;
+            const auto* source = pixels + std::size_t{y} * width * 4;
+            row[0] = 0;
+            for (std::uint32_t x = 0; x < width; ++x) {
+                row[1 + x * 3 + 0] = source[x * 4 + (bgra ? 2 : 0)];
+                row[1 + x * 3 + 1] = source[x * 4 + 1];
+                row[1 + x * 3 + 2] = source[x * 4 + (bgra ? 0 : 2)];
+            }
+        }
+
+        out.clear();
+        out.insert(out.end(), std::begin(kPngSignature), std::end(kPngSignature));
+        const auto header = BeginPngChunk(out, "IHDR");
+        AppendBigEndian(out, width);
+        AppendBigEndian(out, height);
+        out.insert(out.end(), {8, 2, 0, 0, 0}); // bit depth, RGB, deflate, adaptive filtering, no interlace
+        EndPngChunk(out, header);
+
+        const auto data = BeginPngChunk(out, "IDAT");
+        out.insert(out.end(), {0x78, 0x01});
+        for (std::size_t offset = 0; offset < scanlines.size(); offset += kStoredBlockBytes) {
+            const auto size = static_cast<std::uint16_t>(std::min(kStoredBlockBytes, scanlines.size() - offset));
+            const auto last = offset + size == scanlines.size();
+            out.insert(out.end(), {static_cast<std::uint8_t>(last ? 1 : 0), static_cast<std::uint8_t>(size),
+                                   static_cast<std::uint8_t>(size >> 8), static_cast<std::uint8_t>(~size),
+                                   static_cast<std::uint8_t>(~size >> 8)});
+            out.insert(out.end(), scanlines.begin() + static_cast<std::ptrdiff_t>(offset),
+                       scanlines.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        }
+        AppendBigEndian(out, Adler32(scanlines.data(), scanlines.size()));
+        EndPngChunk(out, data);
+
+        EndPngChunk(out, BeginPngChunk(out, "IEND"));
+    }
+
+    bool IsBgra(const SDL_GPUTextureFormat format) {
+        switch (format) {
+        case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+        case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB:
+            return false;
+        case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+        case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB:
+            return true;
+        default:
+            throw std::runtime_error(
+                std::format("frame capture: texture format {} is not 8-bit RGBA or BGRA", static_cast<int>(format)));
+        }
+    }
+}
+
+FrameCapture::FrameCapture(SDL_GPUDevice* device, const CaptureSettings& settings)
+    : device(device), settings(settings), readbacks(std::max(settings.ring_size, 1u)),
+      frames(std::max(settings.max_queued, 1u)) {
+    if (settings.interval == 0) {
+        throw std::invalid_argument("FrameCapture: the interval must be at least one frame");
+    }
+    if (settings.format == CaptureFormat::Png) {
+        std::error_code error;
+        std::filesystem::create_directories(settings.output, error);
+        if (error) {
+            throw std::runtime_error(std::format("{}: {}", settings.output.string(), error.message()));
+        }
+    }
+    else {
+        video.open(settings.output, std::ios::binary);
+        if (!video) {
+            throw std::runtime_error(std::format("{}: could not open for writing", settings.output.string()));
+        }
+    }
+    for (std::uint32_t i = 0; i < frames.size(); ++i) {
+        free_frames.push_back(i);
+    }
+    encoder = std::thread(&FrameCapture::EncoderLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+    try {
+        Flush();
+    }
+    catch (const std::exception& e) {
+        std::cerr << std::format("frame capture: {}\n", e.what()); // a destructor cannot throw; the frame is lost
+    }
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    encoder.join();
+    for (const auto& readback : readbacks) {
+        if (readback.buffer != nullptr) {
+            SDL_ReleaseGPUTransferBuffer(device, readback.buffer);
+        }
+    }
+}
+
+void FrameCapture::CaptureFrame(const RenderGraph& graph, const RenderResource source) {
+    PROFILE_ZONE("CaptureFrame");
+    const auto start = FrameClock::now();
+    const auto this_frame = frame++;
+    if (this_frame % settings.interval != 0) {
+        return;
+    }
+    ++stats.requested;
+
+    const auto free = std::ranges::find_if(readbacks, [](const Readback& r) { return r.fence == nullptr; });
+    if (free == readbacks.end()) {
+        ++stats.dropped_busy;
+        stats.render_thread_ms += MillisecondsBetween(start, FrameClock::now());
+        return;
+    }
+    auto& readback = *free;
+    readback.frame = this_frame;
+    readback.width = RenderTextureWidth(graph, source);
+    readback.height = RenderTextureHeight(graph, source);
+    readback.bgra = IsBgra(graph.resources[source].desc.format);
+
+    const auto bytes = readback.width * readback.height * 4;
+    if (readback.capacity < bytes) {
+        if (readback.buffer != nullptr) {
+            SDL_ReleaseGPUTransferBuffer(device, readback.buffer);
+        }
+        const auto info = SDL_GPUTransferBufferCreateInfo{.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD, .size = bytes};
+        readback.buffer = SDL_CreateGPUTransferBuffer(device, &info);
+        if (readback.buffer == nullptr) {
+            throw std::runtime_error(std::format("frame capture: {}", SDL_GetError()));
+        }
+        readback.capacity = bytes;
+    }
+
+    auto cmdbuf = SDL_AcquireGPUCommandBuffer(device);
+    auto copy_pass = SDL_BeginGPUCopyPass(cmdbuf);
+    const auto region = SDL_GPUTextureRegion{
+        .texture = GetRenderGraphTexture(graph, source), .w = readback.width, .h = readback.height, .d = 1};
+    const auto destination = SDL_GPUTextureTransferInfo{.transfer_buffer = readback.buffer};
+    SDL_DownloadFromGPUTexture(copy_pass, &region, &destination);
+    SDL_EndGPUCopyPass(copy_pass);
+    readback.fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+    if (readback.fence == nullptr) {
+        throw std::runtime_error(std::format("frame capture: {}", SDL_GetError()));
+    }
+    ++stats.captured;
+    stats.render_thread_ms += MillisecondsBetween(start, FrameClock::now());
+}
+
+void FrameCapture::Poll() {
+    PROFILE_ZONE("PollFrameCapture");
+    const auto start = FrameClock::now();
+    {
+        std::lock_guard lock(mutex);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    // fences signal in submission order, so the oldest readback is the one to check
+    while (auto* readback = OldestReadback()) {
+        if (!SDL_QueryGPUFence(device, readback->fence)) {
+            break;
+        }
+        TakeReadback(*readback, false);
+    }
+    stats.render_thread_ms += MillisecondsBetween(start, FrameClock::now());
+}
+
+void FrameCapture::Flush() {
+    PROFILE_ZONE("FlushFrameCapture");
+    // what is still on the GPU is written too, waiting for the encoder to make room rather than dropping it
+    while (auto* readback = OldestReadback()) {
+        SDL_WaitForGPUFences(device, true, &readback->fence, 1);
+        TakeReadback(*readback, true);
+    }
+    std::unique_lock lock(mutex);
+    wake.wait(lock, [this] { return free_frames.size() == frames.size(); });
+}
+
+CaptureStats FrameCapture::Stats() {
+    auto result = stats;
+    std::lock_guard lock(mutex);
+    result.written = written;
+    result.dropped_resized = dropped_resized;
+    result.bytes_written = bytes_written;
+    result.encode_ms = encode_ms;
+    result.video_width = video_width;
+    result.video_height = video_height;
+    return result;
+}
+
+FrameCapture::Readback* FrameCapture::OldestReadback() {
+    Readback* oldest = nullptr;
+    for (auto& readback : readbacks) {
+        if (readback.fence != nullptr && (oldest == nullptr || readback.frame < oldest->frame)) {
+            oldest = &readback;
+        }
+    }
+    return oldest;
+}
+
+void FrameCapture::TakeReadback(Readback& readback, const bool wait_for_encoder) {
+    const auto latency = frame - 1 - readback.frame;
+    stats.max_latency_frames = std::max(stats.max_latency_frames, latency);
+    stats.late += latency > kCaptureLateFrames ? 1 : 0;
+    SDL_ReleaseGPUFence(device, readback.fence);
+    readback.fence = nullptr;
+
+    std::uint32_t index = 0;
+    {
+        std::unique_lock lock(mutex);
+        if (wait_for_encoder) {
+            wake.wait(lock, [this] { return !free_frames.empty(); });
+        }
+        if (free_frames.empty()) {
+            ++stats.dropped_backlog;
+            return;
+        }
+        index = free_frames.back();
+        free_frames.pop_back();
+    }
+
+    // the encoder does not touch a frame until it is queued
+    auto& captured = frames[index];
+    captured.frame = readback.frame;
+    captured.width = readback.width;
+    captured.height = readback.height;
+    captured.bgra = readback.bgra;
+    captured.pixels.resize(std::size_t{readback.width} * readback.height * 4);
+    const auto* mapped = SDL_MapGPUTransferBuffer(device, readback.buffer, false);
+    if (mapped == nullptr) {
+        throw std::runtime_error(std::format("frame capture: {}", SDL_GetError()));
+    }
+    std::memcpy(captured.pixels.data(), mapped, captured.pixels.size());
+    SDL_UnmapGPUTransferBuffer(device, readback.buffer);
+
+    {
+        std::lock_guard lock(mutex);
+        queue.push_back(index);
+    }
+    wake.notify_all();
+}
+
+void FrameCapture::EncoderLoop() {
+    SetProfilerThreadName("capture encoder");
+    while (true) {
+        std::uint32_t index = 0;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            index = queue.front();
+            queue.erase(queue.begin());
+        }
+
+        const auto start = FrameClock::now();
+        std::uint64_t bytes = 0;
+        std::exception_ptr failure;
+        try {
+            PROFILE_ZONE("EncodeCapturedFrame");
+            bytes = Encode(frames[index]);
+        }
+        catch (const std::exception&) {
+            failure = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            free_frames.push_back(index);
+            encode_ms += MillisecondsBetween(start, FrameClock::now());
+            written += bytes > 0 ? 1 : 0;
+            bytes_written += bytes;
+            if (failure && !error) {
+                error = failure;
+            }
+        }
+        wake.notify_all();
+    }
+}
+
+std::uint64_t FrameCapture::Encode(const CapturedFrame& captured) {
+    if (settings.format == CaptureFormat::Png) {
+        EncodePng(encoded, scanlines, captured.pixels.data(), captured.width, captured.height, captured.bgra);
+        const auto path = settings.output / std::format("frame_{:05}.png", captured.frame);
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        if (!file) {
+            throw std::runtime_error(std::format("{}: could not write", path.string()));
+        }
+        return encoded.size();
+    }
+
+    if (video_width == 0) {
+        // only this thread writes the size, but Stats() reads it
+        std::lock_guard lock(mutex);
+        video_width = captured.width;
+        video_height = captured.height;
+    }
+    if (captured.width != video_width || captured.height != video_height) {
+        std::lock_guard lock(mutex);
+        ++dropped_resized;
+        return 0;
+    }
+    const auto* pixels = captured.pixels.data();
+    if (captured.bgra) {
+        encoded.assign(captured.pixels.begin(), captured.pixels.end());
+        for (std::size_t i = 0; i < encoded.size(); i += 4) {
+            std::swap(encoded[i], encoded[i + 2]);
+        }
+        pixels = encoded.data();
+    }
+    video.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(captured.pixels.size()));
+    if (!video) {
+        throw std::runtime_error(std::format("{}: write failed", settings.output.string()));
+    }
+    return captured.pixels.size();
+}
+
+void PrintCaptureReport(const CaptureStats& stats, const std::size_t frame_count) {
+    const auto frames = static_cast<double>(std::max<std::size_t>(frame_count, 1));
+    const auto written = static_cast<double>(std::max<std::uint64_t>(stats.written, 1));
+    std::cout << std::format("Frame capture over {} frames:\n", frame_count);
+    std::cout << std::format("  requested {}  captured {}  written {} ({:.1f} MB)\n", stats.requested, stats.captured,
+                             stats.written, static_cast<double>(stats.bytes_written) / (1024.0 * 1024.0));
+    std::cout << std::format("  dropped: {} readback slots busy, {} encoder behind, {} resized  late {} "
+                             "(max latency {} frames)\n",
+                             stats.dropped_busy, stats.dropped_backlog, stats.dropped_resized, stats.late,
+                             stats.max_latency_frames);
+    std::cout << std::format("  render thread {:.3f} ms/frame  encoder {:.2f} ms/frame written\n",
+                             stats.render_thread_ms / frames, stats.encode_ms / written);
+    if (stats.video_width > 0) {
+        std::cout << std::format("  raw video {}x{}: read it with -f rawvideo -pixel_format rgba -video_size {}x{}\n",
+                                 stats.video_width, stats.video_height, stats.video_width, stats.video_height);
+    }
+}
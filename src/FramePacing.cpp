@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include "FramePacing.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    SDL_GPUPresentMode ToSdlPresentMode(const PresentMode mode) {
+        switch (mode) {
+        case PresentMode::Mailbox:
+            return SDL_GPU_PRESENTMODE_MAILBOX;
+        case PresentMode::Immediate:
+            return SDL_GPU_PRESENTMODE_IMMEDIATE;
+        case PresentMode::Vsync:
+            break;
+        }
+        return SDL_GPU_PRESENTMODE_VSYNC;
+    }
+
+    // Frames the ring no longer has in flight have finished on the GPU; frames finish in submission order.
+    void RetireCompletedFrames(FramePacer& pacer, UploadRing& uploads) {
+        const auto on_gpu = UploadRingFramesInFlight(uploads);
+        const auto now = FrameClock::now();
+        while (pacer.in_flight.size() > on_gpu) {
+            const auto& frame = pacer.in_flight.front();
+            if (frame.presented && pacer.record_latency) {
+                pacer.latency_ms.push_back(MillisecondsBetween(frame.input_time, now));
+            }
+            pacer.in_flight.erase(pacer.in_flight.begin());
+        }
+    }
+}
+
+std::uint32_t FramesInFlight(const FramePacingSettings& settings) {
+    return settings.mode == PacingMode::LowLatency ? 1 : settings.frames_in_flight;
+}
+
+FramePacer CreateFramePacer(const FramePacingSettings& settings, const std::size_t frame_limit) {
+    if (settings.frames_in_flight < 1 || settings.frames_in_flight > kMaxFramesInFlight) {
+        throw std::invalid_argument(
+            std::format("frames in flight must be between 1 and {}, not {}", kMaxFramesInFlight,
+                        settings.frames_in_flight));
+    }
+    FramePacer pacer{.settings = settings};
+    pacer.in_flight.reserve(kMaxFramesInFlight + 1);
+    pacer.latency_ms.reserve(frame_limit);
+    pacer.record_latency = frame_limit > 0;
+    return pacer;
+}
+
+void ApplyFramePacing(SDL_GPUDevice* device, SDL_Window* window, const FramePacingSettings& settings) {
+    if (window == nullptr) {
+        return;
+    }
+    const auto present_mode = ToSdlPresentMode(settings.present_mode);
+    if (!SDL_WindowSupportsGPUPresentMode(device, window, present_mode)) {
+        throw std::runtime_error(
+            std::format("present mode {} is not supported here", PresentModeName(settings.present_mode)));
+    }
+    if (!SDL_SetGPUSwapchainParameters(device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, present_mode)) {
+        throw std::runtime_error(std::format("SDL_SetGPUSwapchainParameters failed: {}", SDL_GetError()));
+    }
+    // the swapchain's own limit, which its acquire waits on; BeginPacedFrame() enforces the same one earlier
+    if (!SDL_SetGPUAllowedFramesInFlight(device, FramesInFlight(settings))) {
+        throw std::runtime_error(std::format("SDL_SetGPUAllowedFramesInFlight failed: {}", SDL_GetError()));
+    }
+}
+
+void BeginPacedFrame(FramePacer& pacer, UploadRing& uploads) {
+    PROFILE_ZONE("BeginPacedFrame");
+    const auto start = FrameClock::now();
+    if (pacer.total_stats.frames == 0) {
+        pacer.first_frame = start;
+    }
+    WaitForUploadRingFrames(uploads, FramesInFlight(pacer.settings) - 1);
+    RetireCompletedFrames(pacer, uploads);
+    pacer.total_stats.wait_ms += MillisecondsBetween(start, FrameClock::now());
+}
+
+void MarkInputSampled(FramePacer& pacer) {
+    pacer.input_time = FrameClock::now();
+}
+
+void EndPacedFrame(FramePacer& pacer, UploadRing& uploads, const bool presented) {
+    pacer.in_flight.push_back(PacedFrame{pacer.input_time, presented});
+    ++pacer.total_stats.frames;
+    pacer.total_stats.skipped += presented ? 0 : 1;
+    RetireCompletedFrames(pacer, uploads);
+    pacer.last_frame = FrameClock::now();
+}
+
+const char* PresentModeName(const PresentMode mode) {
+    switch (mode) {
+    case PresentMode::Mailbox:
+        return "mailbox";
+    case PresentMode::Immediate:
+        return "immediate";
+    case PresentMode::Vsync:
+        break;
+    }
+    return "vsync";
+}
+
+const char* PacingModeName(const PacingMode mode) {
+    switch (mode) {
+    case PacingMode::Uncapped:
+        return "uncapped";
+    case PacingMode::LowLatency:
+        return "low latency";
+    case PacingMode::Throttled:
+        break;
+    }
+    return "throttled";
+}
+
+void PrintFramePacingReport(const FramePacer& pacer) {
+    const auto& stats = pacer.total_stats;
+    const auto frames = static_cast<double>(std::max<std::uint64_t>(stats.frames, 1));
+    const auto seconds = MillisecondsBetween(pacer.first_frame, pacer.last_frame) / 1000.0;
+    const auto& settings = pacer.settings;
+    std::cout << std::format("Frame pacing ({}, {}, {} frames in flight):\n", PresentModeName(settings.present_mode),
+                             PacingModeName(settings.mode), FramesInFlight(settings));
+    std::cout << std::format("  {} frames in {:.2f} s ({:.1f} fps)  skipped {}  waited {:.3f} ms/frame on the GPU\n",
+                             stats.frames, seconds, seconds > 0.0 ? static_cast<double>(stats.frames) / seconds : 0.0,
+                             stats.skipped, stats.wait_ms / frames);
+    if (!pacer.latency_ms.empty()) {
+        const auto latency = SummarizeTimings(pacer.latency_ms);
+        std::cout << std::format("  input->GPU done  min {:8.3f}  median {:8.3f}  p99 {:8.3f}\n", latency.min,
+                                 latency.median, latency.p99);
+    }
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "FrameStats.hpp"
+
+double MillisecondsBetween(const FrameClock::time_point start, const FrameClock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TimingSummary SummarizeTimings(std::vector<double> samples) {
+    if (samples.empty()) {
+        return TimingSummary{};
+    }
+    std::sort(samples.begin(), samples.end());
+
+    // nearest-rank percentiles, so p99 of a short run is still an observed sample
+    const auto rank = [&samples](const double percentile) {
+        const auto index = static_cast<std::size_t>(std::ceil(percentile * samples.size()));
+        return samples[std::clamp<std::size_t>(index, 1, samples.size()) - 1];
+    };
+    return TimingSummary{.min = samples.front(), .median = rank(0.5), .p99 = rank(0.99)};
+}
+
+TimingReservoir CreateTimingReservoir(const std::size_t capacity) {
+    TimingReservoir reservoir{.capacity = capacity};
+    reservoir.samples.reserve(capacity);
+    return reservoir;
+}
+
+void AddTimingSample(TimingReservoir& reservoir, const double sample) {
+    ++reservoir.seen;
+    if (reservoir.samples.size() < reservoir.capacity) {
+        reservoir.samples.push_back(sample);
+        return;
+    }
+    // every sample seen so far stays in with the same probability, capacity / seen
+    const auto slot = std::uniform_int_distribution<std::uint64_t>{0, reservoir.seen - 1}(reservoir.random);
+    if (slot < reservoir.capacity) {
+        reservoir.samples[slot] = sample;
+    }
+}
+
+void PrintFrameTimingReport(const FrameTimings& timings) {
+    const auto cpu = SummarizeTimings(timings.cpu_ms);
+    const auto submit = SummarizeTimings(timings.submit_ms);
+
+    std::cout << std::format("Frame timings over {} frames (ms):\n", timings.cpu_ms.size());
+    std::cout << std::format("  cpu               min {:8.3f}  median {:8.3f}  p99 {:8.3f}\n", cpu.min, cpu.median,
+                             cpu.p99);
+    if (!timings.submit_ms.empty()) {
+        std::cout << std::format("  submit->complete  min {:8.3f}  median {:8.3f}  p99 {:8.3f}\n", submit.min,
+                                 submit.median, submit.p99);
+    }
+}
+
+void WriteFrameTimingsCsv(const FrameTimings& timings, const std::filesystem::path& path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("{}: could not open for writing", path.string()));
+    }
+    file << "frame,cpu_ms,submit_ms\n";
+    for (std::size_t i = 0; i < timings.cpu_ms.size(); ++i) {
+        const auto submit_ms = i < timings.submit_ms.size() ? timings.submit_ms[i] : 0.0;
+        file << std::format("{},{:.4f},{:.4f}\n", i, timings.cpu_ms[i], submit_ms);
+    }
+    if (!file) {
+        throw std::runtime_error(std::format("{}: write failed", path.string()));
+    }
+}
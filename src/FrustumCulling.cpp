@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+
+#include "FrustumCulling.hpp"
+
+namespace {
+    constexpr std::size_t kBoundsGrain = 1024;
+    constexpr std::size_t kCullGrain = 4096;
+
+    glm::vec4 NormalizePlane(const glm::vec4 plane) {
+        const auto length = glm::length(glm::vec3{plane});
+        return length > 0.0f ? plane / length : plane;
+    }
+}
+
+void UpdateLocalBounds(RenderableObject& obj) {
+    if (obj.vertices.empty()) {
+        obj.local_box = BoundingBox{};
+        obj.local_sphere = BoundingSphere{};
+        return;
+    }
+
+    auto box = BoundingBox{obj.vertices[0].pos, obj.vertices[0].pos};
+    for (const auto& vertex : obj.vertices) {
+        box.min = glm::min(box.min, vertex.pos);
+        box.max = glm::max(box.max, vertex.pos);
+    }
+
+    // centred on the box, which is tighter than its half diagonal for most meshes
+    const auto center = (box.min + box.max) * 0.5f;
+    float radius_squared = 0.0f;
+    for (const auto& vertex : obj.vertices) {
+        const auto offset = vertex.pos - center;
+        radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+    }
+
+    obj.local_box = box;
+    obj.local_sphere = BoundingSphere{center, std::sqrt(radius_squared)};
+}
+
+FrustumPlanes ExtractFrustumPlanes(const glm::mat4& view_proj) {
+    // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const auto row = [&](const int i) {
+        return glm::vec4{view_proj[0][i], view_proj[1][i], view_proj[2][i], view_proj[3][i]};
+    };
+    const auto x = row(0), y = row(1), w = row(3);
+
+    return FrustumPlanes{{
+        NormalizePlane(w + x),
+        NormalizePlane(w - x),
+        NormalizePlane(w + y),
+        NormalizePlane(w - y),
+        NormalizePlane(w),
+    }};
+}
+
+void UpdateSceneBounds(SceneBounds& bounds, const std::vector<RenderableObject>& objects, ThreadPool& pool) {
+    const auto count = objects.size();
+    for (auto array : {&bounds.center_x, &bounds.center_y, &bounds.center_z, &bounds.extent_x, &bounds.extent_y,
+                       &bounds.extent_z, &bounds.sphere_x, &bounds.sphere_y, &bounds.sphere_z, &bounds.sphere_radius}) {
+        array->resize(count);
+    }
+
+    pool.ParallelFor(count, kBoundsGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i) {
+            const auto& obj = objects[i];
+            const auto& m = obj.model;
+
+            // Arvo: the world extent along each axis is the local extent projected through |M|
+            const auto local_center = (obj.local_box.min + obj.local_box.max) * 0.5f;
+            const auto local_extent = (obj.local_box.max - obj.local_box.min) * 0.5f;
+            const auto center = glm::vec3{m * glm::vec4{local_center, 1.0f}};
+            const auto extent = glm::abs(glm::vec3{m[0]}) * local_extent.x + glm::abs(glm::vec3{m[1]}) * local_extent.y +
+                                glm::abs(glm::vec3{m[2]}) * local_extent.z;
+            bounds.center_x[i] = center.x, bounds.center_y[i] = center.y, bounds.center_z[i] = center.z;
+            bounds.extent_x[i] = extent.x, bounds.extent_y[i] = extent.y, bounds.extent_z[i] = extent.z;
+
+            const auto sphere_center = glm::vec3{m * glm::vec4{obj.local_sphere.center, 1.0f}};
+            const auto max_scale = std::sqrt(std::max({glm::dot(glm::vec3{m[0]}, glm::vec3{m[0]}),
+                                                       glm::dot(glm::vec3{m[1]}, glm::vec3{m[1]}),
+                                                       glm::dot(glm::vec3{m[2]}, glm::vec3{m[2]})}));
+            bounds.sphere_x[i] = sphere_center.x, bounds.sphere_y[i] = sphere_center.y;
+            bounds.sphere_z[i] = sphere_center.z;
+            bounds.sphere_radius[i] = obj.local_sphere.radius * max_scale;
+        }
+    });
+}
+
+void CullScene(SceneBounds& bounds, const FrustumPlanes& frustum, ThreadPool& pool) {
+    const auto count = bounds.center_x.size();
+    bounds.visible.resize(count);
+
+    pool.ParallelFor(count, kCullGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i) {
+            bool inside = true;
+            for (const auto& plane : frustum.planes) {
+                // either volume entirely behind one plane is enough to reject
+                const auto sphere_distance = plane.x * bounds.sphere_x[i] + plane.y * bounds.sphere_y[i] +
+                                             plane.z * bounds.sphere_z[i] + plane.w;
+                const auto box_distance =
+                    plane.x * bounds.center_x[i] + plane.y * bounds.center_y[i] + plane.z * bounds.center_z[i] + plane.w;
+                const auto box_radius = std::abs(plane.x) * bounds.extent_x[i] +
+                                        std::abs(plane.y) * bounds.extent_y[i] + std::abs(plane.z) * bounds.extent_z[i];
+                inside = inside && sphere_distance >= -bounds.sphere_radius[i] && box_distance >= -box_radius;
+            }
+            bounds.visible[i] = inside ? 1 : 0;
+        }
+    });
+
+    bounds.visible_objects.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (bounds.visible[i] != 0) {
+            bounds.visible_objects.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    bounds.frame_stats.visible = bounds.visible_objects.size();
+    bounds.frame_stats.culled = count - bounds.visible_objects.size();
+    bounds.total_stats.visible += bounds.frame_stats.visible;
+    bounds.total_stats.culled += bounds.frame_stats.culled;
+}
+
+void PrintCullingReport(const CullingStats& stats, const std::size_t frame_count) {
+    const auto frames = static_cast<double>(std::max<std::size_t>(frame_count, 1));
+    std::cout << std::format("Frustum culling over {} frames:\n", frame_count);
+    std::cout << std::format("  visible/frame {:10.1f}  culled/frame {:10.1f}\n",
+                             static_cast<double>(stats.visible) / frames, static_cast<double>(stats.culled) / frames);
+}
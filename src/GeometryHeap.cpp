@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "GeometryHeap.hpp"
+
+namespace {
+    SDL_GPUBuffer* CreateBuffer(SDL_GPUDevice* device, const SDL_GPUBufferUsageFlags usage, const std::uint32_t size) {
+        const auto info = SDL_GPUBufferCreateInfo{.usage = usage, .size = std::max<std::uint32_t>(size, 4)};
+        auto buffer = SDL_CreateGPUBuffer(device, &info);
+        if (buffer == nullptr) {
+            throw std::runtime_error(SDL_GetError());
+        }
+        return buffer;
+    }
+
+    // Swaps `buffer` for a new one of new_size bytes holding the first copy_size bytes of the old one. SDL defers the
+    // old buffer's destruction until commands already referencing it have finished.
+    void ReallocateBuffer(SDL_GPUDevice* device, SDL_GPUCopyPass* copy_pass, SDL_GPUBuffer*& buffer,
+                          const SDL_GPUBufferUsageFlags usage, const std::uint32_t copy_size,
+                          const std::uint32_t new_size) {
+        auto resized = CreateBuffer(device, usage, new_size);
+        if (copy_size > 0) {
+            const auto source = SDL_GPUBufferLocation{.buffer = buffer, .offset = 0};
+            const auto destination = SDL_GPUBufferLocation{.buffer = resized, .offset = 0};
+            SDL_CopyGPUBufferToBuffer(copy_pass, &source, &destination, copy_size, false);
+        }
+        SDL_ReleaseGPUBuffer(device, buffer);
+        buffer = resized;
+    }
+
+    // Growth copies must be recorded after any ring writes already aimed at the old buffers, so the ring is flushed
+    // before the first reallocation in an upload.
+    struct GrowthPass {
+        UploadRing& ring;
+        SDL_GPUCommandBuffer* cmdbuf;
+        SDL_GPUCopyPass* copy_pass = nullptr;
+
+        SDL_GPUCopyPass* Begin() {
+            if (copy_pass == nullptr) {
+                FlushUploadRing(ring, cmdbuf);
+                copy_pass = SDL_BeginGPUCopyPass(cmdbuf);
+            }
+            return copy_pass;
+        }
+        void End() {
+            if (copy_pass != nullptr) {
+                SDL_EndGPUCopyPass(copy_pass);
+                copy_pass = nullptr;
+            }
+        }
+    };
+
+    std::uint32_t GrownCapacity(const RangeAllocator& allocator, const std::uint32_t count) {
+        return std::max(allocator.capacity * 2, allocator.capacity + count);
+    }
+
+    void GrowRangeAllocator(RangeAllocator& allocator, const std::uint32_t new_capacity) {
+        const auto tail = GeometryRange{allocator.capacity, new_capacity - allocator.capacity};
+        allocator.capacity = new_capacity;
+
+        auto& ranges = allocator.free_ranges;
+        if (!ranges.empty() && ranges.back().offset + ranges.back().count == tail.offset) {
+            ranges.back().count += tail.count;
+        }
+        else {
+            ranges.push_back(tail);
+        }
+    }
+
+    std::uint32_t AllocateVertices(GeometryHeap& heap, GrowthPass& growth, const std::uint32_t count) {
+        if (auto offset = AllocateRange(heap.vertices, count)) {
+            return *offset;
+        }
+        const auto old_capacity = heap.vertices.capacity;
+        const auto new_capacity = GrownCapacity(heap.vertices, count);
+        ReallocateBuffer(heap.device, growth.Begin(), heap.vertex_buffer, SDL_GPU_BUFFERUSAGE_VERTEX,
+                         old_capacity * heap.vertex_stride, new_capacity * heap.vertex_stride);
+        ReallocateBuffer(heap.device, growth.Begin(), heap.normal_buffer, SDL_GPU_BUFFERUSAGE_VERTEX,
+                         old_capacity * heap.normal_stride, new_capacity * heap.normal_stride);
+        GrowRangeAllocator(heap.vertices, new_capacity);
+        return *AllocateRange(heap.vertices, count);
+    }
+
+    std::uint32_t AllocateIndices(GeometryHeap& heap, GrowthPass& growth,
+                                  const SDL_GPUIndexElementSize index_size, const std::uint32_t count) {
+        const bool wide = index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT;
+        auto& allocator = wide ? heap.indices32 : heap.indices16;
+        auto& buffer = wide ? heap.index32_buffer : heap.index16_buffer;
+        const std::uint32_t element_size = wide ? 4 : 2;
+
+        if (auto offset = AllocateRange(allocator, count)) {
+            return *offset;
+        }
+        const auto new_capacity = GrownCapacity(allocator, count);
+        ReallocateBuffer(heap.device, growth.Begin(), buffer, SDL_GPU_BUFFERUSAGE_INDEX,
+                         allocator.capacity * element_size, new_capacity * element_size);
+        GrowRangeAllocator(allocator, new_capacity);
+        return *AllocateRange(allocator, count);
+    }
+
+    // Moves one pool's live ranges, in offset order, to its front and records the copies that do the same to the
+    // data. `ranges` is sorted in place.
+    void PackPool(RangeAllocator& allocator, std::vector<GeometryRange*>& ranges, std::vector<GeometryMove>& moves) {
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const GeometryRange* a, const GeometryRange* b) { return a->offset < b->offset; });
+        moves.clear();
+        std::uint32_t cursor = 0;
+        for (auto* range : ranges) {
+            if (range->count == 0) {
+                range->offset = cursor;
+                continue;
+            }
+            auto* last = moves.empty() ? nullptr : &moves.back();
+            if (last != nullptr && last->source + last->count == range->offset) {
+                last->count += range->count;
+            }
+            else {
+                moves.push_back(GeometryMove{range->offset, cursor, range->count});
+            }
+            range->offset = cursor;
+            cursor += range->count;
+        }
+
+        allocator.free_ranges.clear();
+        if (cursor < allocator.capacity) {
+            allocator.free_ranges.push_back(GeometryRange{cursor, allocator.capacity - cursor});
+        }
+        allocator.used = cursor;
+    }
+
+    // Swaps each of a pool's buffers for a fresh one of the same size holding the moved ranges.
+    void CopyPool(GeometryHeap& heap, SDL_GPUCopyPass* copy_pass, const RangeAllocator& allocator,
+                  const std::initializer_list<std::pair<SDL_GPUBuffer**, std::uint32_t>> buffers,
+                  const SDL_GPUBufferUsageFlags usage, const std::vector<GeometryMove>& moves) {
+        for (const auto& [buffer, element_size] : buffers) {
+            auto compacted = CreateBuffer(heap.device, usage, allocator.capacity * element_size);
+            for (const auto& move : moves) {
+                const auto source = SDL_GPUBufferLocation{.buffer = *buffer, .offset = move.source * element_size};
+                const auto destination =
+                    SDL_GPUBufferLocation{.buffer = compacted, .offset = move.destination * element_size};
+                SDL_CopyGPUBufferToBuffer(copy_pass, &source, &destination, move.count * element_size, false);
+            }
+            SDL_ReleaseGPUBuffer(heap.device, *buffer);
+            *buffer = compacted;
+        }
+    }
+
+    // `allocation` arrives with its LOD layout, if any; a single level spanning every index otherwise
+    GeometryAllocation AllocateGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                        const std::uint32_t vertex_count, const std::uint32_t index_count,
+                                        const SDL_GPUIndexElementSize index_size, GeometryAllocation allocation = {}) {
+        GrowthPass growth{ring, cmdbuf};
+        allocation.index_size = index_size;
+        allocation.live = true;
+        if (allocation.lod_count == 1) {
+            allocation.lods[0] = GeometryRange{0, index_count};
+        }
+        allocation.vertices = GeometryRange{AllocateVertices(heap, growth, vertex_count), vertex_count};
+        allocation.indices = GeometryRange{AllocateIndices(heap, growth, index_size, index_count), index_count};
+        growth.End();
+        return allocation;
+    }
+
+    GeometryHandle StoreAllocation(GeometryHeap& heap, const GeometryAllocation& allocation) {
+        if (!heap.free_handles.empty()) {
+            const auto handle = heap.free_handles.back();
+            heap.free_handles.pop_back();
+            heap.allocations[handle] = allocation;
+            return handle;
+        }
+        heap.allocations.push_back(allocation);
+        return static_cast<GeometryHandle>(heap.allocations.size() - 1);
+    }
+
+    void WriteIndices(const GeometryHeap& heap, UploadRing& ring, const GeometryAllocation& allocation,
+                      const RenderableObject& obj) {
+        const std::uint32_t element_size = allocation.index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT ? 4 : 2;
+        if (auto cursor = WriteUpload(ring, GeometryIndexBuffer(heap, allocation.index_size),
+                                      allocation.indices.offset * element_size,
+                                      allocation.indices.count * element_size)) {
+            PackIndices(cursor, allocation, obj);
+        }
+    }
+}
+
+GeometryAllocation LayoutGeometry(const RenderableObject& obj) {
+    GeometryAllocation layout{};
+    const auto vertex_count = static_cast<std::uint32_t>(obj.vertices.size());
+    layout.vertices = GeometryRange{0, vertex_count};
+    layout.index_size =
+        vertex_count > kMax16BitVertices ? SDL_GPU_INDEXELEMENTSIZE_32BIT : SDL_GPU_INDEXELEMENTSIZE_16BIT;
+
+    // obj.indices followed by each of obj.lods
+    const auto levels = std::min<std::size_t>(obj.lods.size() + 1, kMaxLodLevels);
+    std::uint32_t cursor = 0;
+    for (std::size_t level = 0; level < levels; ++level) {
+        const auto& indices = level == 0 ? obj.indices : obj.lods[level - 1].indices;
+        layout.lods[level] = GeometryRange{cursor, static_cast<std::uint32_t>(indices.size() * 3)};
+        cursor += layout.lods[level].count;
+    }
+    layout.lod_count = static_cast<std::uint32_t>(levels);
+    layout.indices = GeometryRange{0, cursor};
+    return layout;
+}
+
+void PackIndices(void* destination, const GeometryAllocation& layout, const RenderableObject& obj) {
+    const std::uint32_t element_size = layout.index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT ? 4 : 2;
+    auto cursor = destination;
+    for (std::uint32_t level = 0; level < layout.lod_count; ++level) {
+        const auto& indices = level == 0 ? obj.indices : obj.lods[level - 1].indices;
+        const auto bytes = layout.lods[level].count * element_size;
+        if (element_size == 4) {
+            memcpy(cursor, indices.data(), bytes);
+            cursor = static_cast<std::byte*>(cursor) + bytes;
+            continue;
+        }
+        auto narrow = static_cast<std::uint16_t*>(cursor);
+        for (const auto& triangle : indices) {
+            *narrow++ = static_cast<std::uint16_t>(triangle[0]);
+            *narrow++ = static_cast<std::uint16_t>(triangle[1]);
+            *narrow++ = static_cast<std::uint16_t>(triangle[2]);
+        }
+        cursor = narrow;
+    }
+}
+
+std::optional<std::uint32_t> AllocateRange(RangeAllocator& allocator, const std::uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    // first fit keeps live data packed towards the front of the buffer
+    for (auto it = allocator.free_ranges.begin(); it != allocator.free_ranges.end(); ++it) {
+        if (it->count < count) {
+            continue;
+        }
+        const auto offset = it->offset;
+        it->offset += count;
+        it->count -= count;
+        if (it->count == 0) {
+            allocator.free_ranges.erase(it);
+        }
+        allocator.used += count;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+void FreeRange(RangeAllocator& allocator, const GeometryRange range) {
+    if (range.count == 0) {
+        return;
+    }
+    auto& ranges = allocator.free_ranges;
+    auto next = std::lower_bound(ranges.begin(), ranges.end(), range.offset,
+                                 [](const GeometryRange& r, const std::uint32_t offset) { return r.offset < offset; });
+    next = ranges.insert(next, range);
+    allocator.used -= range.count;
+
+    // coalesce with the following and then the preceding neighbour
+    if (next + 1 != ranges.end() && next->offset + next->count == (next + 1)->offset) {
+        next->count += (next + 1)->count;
+        ranges.erase(next + 1);
+    }
+    if (next != ranges.begin() && (next - 1)->offset + (next - 1)->count == next->offset) {
+        (next - 1)->count += next->count;
+        ranges.erase(next);
+    }
+}
+
+float RangeFragmentation(const RangeAllocator& allocator) {
+    if (allocator.capacity == 0) {
+        return 0.0f;
+    }
+    std::uint32_t largest = 0;
+    for (const auto& range : allocator.free_ranges) {
+        largest = std::max(largest, range.count);
+    }
+    return static_cast<float>(allocator.capacity - allocator.used - largest) / static_cast<float>(allocator.capacity);
+}
+
+GeometryHeap CreateGeometryHeap(SDL_GPUDevice* device, const std::uint32_t vertex_capacity,
+                                const std::uint32_t index_capacity, const VertexFormat format) {
+    GeometryHeap heap{};
+    heap.device = device;
+    heap.format = format;
+    heap.vertex_stride = VertexStride(format);
+    heap.normal_stride = NormalStride(format);
+    heap.vertex_buffer = CreateBuffer(device, SDL_GPU_BUFFERUSAGE_VERTEX, vertex_capacity * heap.vertex_stride);
+    heap.normal_buffer = CreateBuffer(device, SDL_GPU_BUFFERUSAGE_VERTEX, vertex_capacity * heap.normal_stride);
+    heap.index16_buffer = CreateBuffer(device, SDL_GPU_BUFFERUSAGE_INDEX, index_capacity * 2);
+    heap.index32_buffer = CreateBuffer(device, SDL_GPU_BUFFERUSAGE_INDEX, index_capacity * 4);
+
+    for (auto [allocator, capacity] : {std::pair{&heap.vertices, vertex_capacity},
+                                       std::pair{&heap.indices16, index_capacity},
+                                       std::pair{&heap.indices32, index_capacity}}) {
+        allocator->capacity = capacity;
+        allocator->free_ranges.push_back(GeometryRange{0, capacity});
+    }
+    return heap;
+}
+
+void DestroyGeometryHeap(GeometryHeap& heap) {
+    SDL_ReleaseGPUBuffer(heap.device, heap.vertex_buffer);
+    SDL_ReleaseGPUBuffer(heap.device, heap.normal_buffer);
+    SDL_ReleaseGPUBuffer(heap.device, heap.index16_buffer);
+    SDL_ReleaseGPUBuffer(heap.device, heap.index32_buffer);
+    heap = GeometryHeap{};
+}
+
+GeometryHandle UploadGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                              const RenderableObject& obj) {
+    if (heap.format != VertexFormat::Float) {
+        throw std::logic_error("UploadGeometry: heap stores quantized vertices, use UploadQuantizedGeometry");
+    }
+    const auto layout = LayoutGeometry(obj);
+    const auto vertex_count = layout.vertices.count;
+    const auto allocation =
+        AllocateGeometry(heap, ring, cmdbuf, vertex_count, layout.indices.count, layout.index_size, layout);
+
+    UploadBytes(ring, heap.vertex_buffer, allocation.vertices.offset * heap.vertex_stride, obj.vertices.data(),
+                vertex_count * heap.vertex_stride);
+
+    const auto normal_bytes = vertex_count * heap.normal_stride;
+    if (auto normals =
+            WriteUpload(ring, heap.normal_buffer, allocation.vertices.offset * heap.normal_stride, normal_bytes)) {
+        if (obj.normals.size() == obj.vertices.size()) {
+            memcpy(normals, obj.normals.data(), normal_bytes);
+        }
+        else {
+            memset(normals, 0, normal_bytes);
+        }
+    }
+
+    WriteIndices(heap, ring, allocation, obj);
+    return StoreAllocation(heap, allocation);
+}
+
+GeometryHandle UploadQuantizedGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                       const RenderableObject& obj, const QuantizedMesh& mesh) {
+    if (heap.format != VertexFormat::Quantized) {
+        throw std::logic_error("UploadQuantizedGeometry: heap stores float vertices");
+    }
+    const auto vertex_count = static_cast<std::uint32_t>(mesh.vertices.size());
+    const auto layout = LayoutGeometry(obj);
+    const auto allocation =
+        AllocateGeometry(heap, ring, cmdbuf, vertex_count, layout.indices.count, layout.index_size, layout);
+
+    UploadBytes(ring, heap.vertex_buffer, allocation.vertices.offset * heap.vertex_stride, mesh.vertices.data(),
+                vertex_count * heap.vertex_stride);
+    UploadBytes(ring, heap.normal_buffer, allocation.vertices.offset * heap.normal_stride, mesh.normals.data(),
+                vertex_count * heap.normal_stride);
+
+    WriteIndices(heap, ring, allocation, obj);
+    return StoreAllocation(heap, allocation);
+}
+
+GeometryHandle UploadIndexPattern(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                  const RenderableObject& pattern) {
+    const auto layout = LayoutGeometry(pattern);
+    auto allocation = AllocateGeometry(heap, ring, cmdbuf, 0, layout.indices.count, layout.index_size, layout);
+    WriteIndices(heap, ring, allocation, pattern);
+    return StoreAllocation(heap, allocation);
+}
+
+GeometryHandle UploadPatternGeometry(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                     const RenderableObject& obj, const GeometryHandle pattern,
+                                     const QuantizedMesh* mesh) {
+    const bool quantized = heap.format == VertexFormat::Quantized;
+    if (quantized && mesh == nullptr) {
+        throw std::logic_error("UploadPatternGeometry: quantized heaps need the quantized mesh");
+    }
+    const auto vertex_count = static_cast<std::uint32_t>(obj.vertices.size());
+    auto allocation = AllocateGeometry(heap, ring, cmdbuf, vertex_count, 0, heap.allocations.at(pattern).index_size);
+    const auto& shared = heap.allocations.at(pattern);
+    allocation.indices = shared.indices;
+    allocation.lods = shared.lods;
+    allocation.lod_count = shared.lod_count;
+    allocation.index_pattern = pattern;
+
+    if (quantized) {
+        UploadBytes(ring, heap.vertex_buffer, allocation.vertices.offset * heap.vertex_stride, mesh->vertices.data(),
+                    vertex_count * heap.vertex_stride);
+        UploadBytes(ring, heap.normal_buffer, allocation.vertices.offset * heap.normal_stride, mesh->normals.data(),
+                    vertex_count * heap.normal_stride);
+    }
+    else {
+        UploadBytes(ring, heap.vertex_buffer, allocation.vertices.offset * heap.vertex_stride, obj.vertices.data(),
+                    vertex_count * heap.vertex_stride);
+        UploadBytes(ring, heap.normal_buffer, allocation.vertices.offset * heap.normal_stride, obj.normals.data(),
+                    vertex_count * heap.normal_stride);
+    }
+    return StoreAllocation(heap, allocation);
+}
+
+GeometryHandle UploadMappedMesh(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf,
+                                const MappedMesh& mesh) {
+    if (heap.format != VertexFormat::Float) {
+        throw std::logic_error("UploadMappedMesh: mesh files hold float vertices");
+    }
+    const auto index_size = mesh.index_size == 4 ? SDL_GPU_INDEXELEMENTSIZE_32BIT : SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    const auto allocation = AllocateGeometry(heap, ring, cmdbuf, mesh.vertex_count, mesh.index_count, index_size);
+
+    // sections are already in GPU layout: one copy each, from the mapping into the ring
+    UploadBytes(ring, heap.vertex_buffer, allocation.vertices.offset * heap.vertex_stride, mesh.vertices.data(),
+                static_cast<std::uint32_t>(mesh.vertices.size_bytes()));
+    UploadBytes(ring, heap.normal_buffer, allocation.vertices.offset * heap.normal_stride, mesh.normals.data(),
+                static_cast<std::uint32_t>(mesh.normals.size_bytes()));
+    UploadBytes(ring, GeometryIndexBuffer(heap, index_size), allocation.indices.offset * mesh.index_size,
+                mesh.indices.data(), static_cast<std::uint32_t>(mesh.indices.size_bytes()));
+
+    return StoreAllocation(heap, allocation);
+}
+
+void FreeGeometry(GeometryHeap& heap, const GeometryHandle handle) {
+    auto& allocation = heap.allocations.at(handle);
+    if (!allocation.live) {
+        return;
+    }
+    FreeRange(heap.vertices, allocation.vertices);
+    if (allocation.index_pattern == kNoGeometry) {
+        FreeRange(allocation.index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT ? heap.indices32 : heap.indices16,
+                  allocation.indices);
+    }
+    allocation = GeometryAllocation{};
+    heap.free_handles.push_back(handle);
+}
+
+float GeometryHeapFragmentation(const GeometryHeap& heap) {
+    return std::max({RangeFragmentation(heap.vertices), RangeFragmentation(heap.indices16),
+                     RangeFragmentation(heap.indices32)});
+}
+
+void PackGeometryHeap(GeometryHeap& heap) {
+    auto& compaction = heap.compaction;
+    auto& ranges = compaction.ranges;
+
+    ranges.clear();
+    for (auto& allocation : heap.allocations) {
+        if (allocation.live) {
+            ranges.push_back(&allocation.vertices);
+        }
+    }
+    PackPool(heap.vertices, ranges, compaction.vertices);
+
+    for (const auto index_size : {SDL_GPU_INDEXELEMENTSIZE_16BIT, SDL_GPU_INDEXELEMENTSIZE_32BIT}) {
+        ranges.clear();
+        for (auto& allocation : heap.allocations) {
+            if (allocation.live && allocation.index_pattern == kNoGeometry && allocation.index_size == index_size) {
+                ranges.push_back(&allocation.indices);
+            }
+        }
+        const bool wide = index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT;
+        PackPool(wide ? heap.indices32 : heap.indices16, ranges, wide ? compaction.indices32 : compaction.indices16);
+    }
+
+    // borrowed index ranges follow their pattern
+    for (auto& allocation : heap.allocations) {
+        if (allocation.live && allocation.index_pattern != kNoGeometry) {
+            allocation.indices = heap.allocations[allocation.index_pattern].indices;
+        }
+    }
+    ++heap.compactions;
+}
+
+void CompactGeometryHeap(GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf) {
+    // pending ring writes target the buffers being replaced, at the offsets the ranges had before packing
+    FlushUploadRing(ring, cmdbuf);
+    PackGeometryHeap(heap);
+
+    const auto& compaction = heap.compaction;
+    auto copy_pass = SDL_BeginGPUCopyPass(cmdbuf);
+    CopyPool(heap, copy_pass, heap.vertices,
+             {{&heap.vertex_buffer, heap.vertex_stride}, {&heap.normal_buffer, heap.normal_stride}},
+             SDL_GPU_BUFFERUSAGE_VERTEX, compaction.vertices);
+    CopyPool(heap, copy_pass, heap.indices16, {{&heap.index16_buffer, 2}}, SDL_GPU_BUFFERUSAGE_INDEX,
+             compaction.indices16);
+    CopyPool(heap, copy_pass, heap.indices32, {{&heap.index32_buffer, 4}}, SDL_GPU_BUFFERUSAGE_INDEX,
+             compaction.indices32);
+    SDL_EndGPUCopyPass(copy_pass);
+}
+
+SDL_GPUIndexedIndirectDrawCommand GeometryDrawCommand(const GeometryHeap& heap, const GeometryHandle handle,
+                                                      const std::uint32_t lod) {
+    const auto& allocation = heap.allocations.at(handle);
+    const auto& level = allocation.lods[std::min(lod, allocation.lod_count - 1)];
+    return SDL_GPUIndexedIndirectDrawCommand{
+        .num_indices = level.count,
+        .num_instances = 1,
+        .first_index = allocation.indices.offset + level.offset,
+        .vertex_offset = static_cast<std::int32_t>(allocation.vertices.offset),
+        .first_instance = 0,
+    };
+}
+
+SDL_GPUBuffer* GeometryIndexBuffer(const GeometryHeap& heap, const SDL_GPUIndexElementSize index_size) {
+    return index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT ? heap.index32_buffer : heap.index16_buffer;
+}
@@ -0,0 +1,13 @@
+#include "Hashing.hpp"
+
+namespace {
+    constexpr std::uint64_t kFnvPrime = 0x100000001b3ull;
+}
+
+std::uint64_t HashBytes(std::uint64_t hash, const void* data, const std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+    return hash;
+}
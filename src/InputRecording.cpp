@@ -0,0 +1,48 @@
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "InputRecording.hpp"
+
+void WriteInputRecording(const std::filesystem::path& path, const InputRecording& recording) {
+    InputFileHeader header{};
+    header.frame_count = static_cast<std::uint32_t>(recording.frames.size());
+    header.simulation_rate = recording.simulation_rate;
+    header.state_hash = recording.state_hash;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("{}: could not open for writing", path.string()));
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(recording.frames.data()),
+               static_cast<std::streamsize>(recording.frames.size() * sizeof(InputFrame)));
+    if (!file) {
+        throw std::runtime_error(std::format("{}: write failed", path.string()));
+    }
+}
+
+InputRecording ReadInputRecording(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error(std::format("{}: could not open", path.string()));
+    }
+    InputFileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != kInputFileMagic) {
+        throw std::runtime_error(std::format("{}: not an input recording", path.string()));
+    }
+    if (header.version != kInputFileVersion) {
+        throw std::runtime_error(
+            std::format("{}: version {}, expected {}", path.string(), header.version, kInputFileVersion));
+    }
+
+    InputRecording recording{.simulation_rate = header.simulation_rate, .state_hash = header.state_hash};
+    recording.frames.resize(header.frame_count);
+    file.read(reinterpret_cast<char*>(recording.frames.data()),
+              static_cast<std::streamsize>(recording.frames.size() * sizeof(InputFrame)));
+    if (!file) {
+        throw std::runtime_error(std::format("{}: truncated, expected {} frames", path.string(), header.frame_count));
+    }
+    return recording;
+}
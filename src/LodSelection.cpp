@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+
+#include "LodSelection.hpp"
+
+namespace {
+    constexpr std::size_t kSelectGrain = 1024;
+
+    std::size_t TriangleCount(const RenderableObject& obj, const std::uint32_t level) {
+        if (!obj.level_triangles.empty()) {
+            return obj.level_triangles[std::min<std::size_t>(level, obj.level_triangles.size() - 1)];
+        }
+        return level == 0 ? obj.indices.size() : obj.lods[level - 1].indices.size();
+    }
+}
+
+void SelectLods(LodSelector& selector, const std::vector<RenderableObject>& objects, const SceneBounds& bounds,
+                const CameraObject& camera, ThreadPool& pool, const LodSelectionSettings& settings) {
+    selector.levels.resize(objects.size(), 0);
+    const auto& visible = bounds.visible_objects;
+    // pixels per world unit at distance 1
+    const auto pixel_scale = camera.proj[1][1] * settings.viewport_height * 0.5f;
+    const auto finer_threshold = settings.max_pixel_error * (1.0f + settings.hysteresis);
+    const auto coarser_threshold = settings.max_pixel_error / (1.0f + settings.hysteresis);
+
+    pool.ParallelFor(visible.size(), kSelectGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (auto v = begin; v < end; ++v) {
+            const auto i = visible[v];
+            const auto& obj = objects[i];
+            const auto level_count =
+                static_cast<std::uint32_t>(std::min<std::size_t>(obj.lods.size() + 1, kMaxLodLevels));
+            auto level = std::min<std::uint32_t>(selector.levels[i], level_count - 1);
+
+            const auto offset = glm::vec3{bounds.sphere_x[i], bounds.sphere_y[i], bounds.sphere_z[i]} -
+                                camera.camera_coords;
+            const auto distance = glm::length(offset);
+            if (level_count == 1 || obj.local_sphere.radius <= 0.0f || distance <= bounds.sphere_radius[i]) {
+                selector.levels[i] = 0;
+                continue;
+            }
+
+            // projected sphere radius in pixels, per unit of object-space error
+            const auto pixels_per_error = bounds.sphere_radius[i] * pixel_scale / (distance * obj.local_sphere.radius);
+            const auto pixel_error = [&](const std::uint32_t l) {
+                return l == 0 ? 0.0f : obj.lods[l - 1].error * pixels_per_error;
+            };
+            while (level > 0 && pixel_error(level) > finer_threshold) {
+                --level;
+            }
+            while (level + 1 < level_count && pixel_error(level + 1) <= coarser_threshold) {
+                ++level;
+            }
+            selector.levels[i] = static_cast<std::uint8_t>(level);
+        }
+    });
+
+    selector.frame_stats = LodStats{};
+    for (const auto i : visible) {
+        const auto level = selector.levels[i];
+        ++selector.frame_stats.objects[level];
+        selector.frame_stats.triangles += TriangleCount(objects[i], level);
+        selector.frame_stats.full_triangles += TriangleCount(objects[i], 0);
+    }
+    for (std::size_t level = 0; level < kMaxLodLevels; ++level) {
+        selector.total_stats.objects[level] += selector.frame_stats.objects[level];
+    }
+    selector.total_stats.triangles += selector.frame_stats.triangles;
+    selector.total_stats.full_triangles += selector.frame_stats.full_triangles;
+}
+
+void PrintLodSelectionReport(const LodStats& stats, const std::size_t frame_count) {
+    const auto frames = static_cast<double>(std::max<std::size_t>(frame_count, 1));
+    std::cout << std::format("LOD selection over {} frames:\n", frame_count);
+    std::cout << "  objects/frame";
+    for (std::size_t level = 0; level < kMaxLodLevels; ++level) {
+        std::cout << std::format("  LOD{} {:8.1f}", level, static_cast<double>(stats.objects[level]) / frames);
+    }
+    std::cout << "\n";
+    std::cout << std::format("  triangles/frame {:12.1f} of {:12.1f} at full detail\n",
+                             static_cast<double>(stats.triangles) / frames,
+                             static_cast<double>(stats.full_triangles) / frames);
+}
@@ -0,0 +1,22 @@
+#include "MeshAdjacency.hpp"
+
+void BuildTriangleAdjacency(TriangleAdjacency& adjacency, const std::vector<TriangleIndices>& indices,
+                            const std::size_t vertex_count) {
+    auto& offsets = adjacency.offsets;
+    offsets.assign(vertex_count + 1, 0);
+    for (const auto& triangle : indices) {
+        ++offsets[triangle[0] + 1];
+        ++offsets[triangle[1] + 1];
+        ++offsets[triangle[2] + 1];
+    }
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    adjacency.triangles.resize(indices.size() * 3);
+    adjacency.cursor.assign(offsets.begin(), offsets.end() - 1);
+    for (std::size_t t = 0; t < indices.size(); ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            adjacency.triangles[adjacency.cursor[indices[t][corner]]++] = static_cast<std::uint32_t>(t);
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "GeometryHeap.hpp"
+#include "MeshFile.hpp"
+
+namespace {
+    std::uint64_t AlignUp(const std::uint64_t value, const std::uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    bool SectionFits(const MeshFileSection& section, const std::uint64_t expected_size, const std::size_t file_size) {
+        return section.size == expected_size && section.offset % kMeshSectionAlignment == 0 &&
+               section.offset <= file_size && section.size <= file_size - section.offset;
+    }
+
+    template <typename Index>
+    bool IndicesInRange(const std::byte* indices, const std::uint32_t count, const std::uint32_t vertex_count) {
+        for (std::uint32_t i = 0; i < count; ++i) {
+            Index index;
+            std::memcpy(&index, indices + std::size_t{i} * sizeof(Index), sizeof(Index));
+            if (index >= vertex_count) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void WriteMeshFile(const std::filesystem::path& path, const RenderableObject& obj) {
+    if (obj.normals.size() != obj.vertices.size()) {
+        throw std::runtime_error(std::format("{}: mesh has no per-vertex normals", path.string()));
+    }
+
+    MeshFileHeader header{};
+    header.vertex_count = static_cast<std::uint32_t>(obj.vertices.size());
+    header.index_count = static_cast<std::uint32_t>(obj.indices.size() * 3);
+    header.index_size = header.vertex_count > kMax16BitVertices ? 4 : 2;
+
+    header.vertices = {AlignUp(sizeof(MeshFileHeader), kMeshSectionAlignment),
+                       std::uint64_t{header.vertex_count} * sizeof(PositionAndColorVertex)};
+    header.normals = {AlignUp(header.vertices.offset + header.vertices.size, kMeshSectionAlignment),
+                      std::uint64_t{header.vertex_count} * sizeof(VertexNormal)};
+    header.indices = {AlignUp(header.normals.offset + header.normals.size, kMeshSectionAlignment),
+                      std::uint64_t{header.index_count} * header.index_size};
+
+    for (int axis = 0; axis < 3; ++axis) {
+        header.box_min[axis] = obj.local_box.min[axis];
+        header.box_max[axis] = obj.local_box.max[axis];
+        header.sphere_center[axis] = obj.local_sphere.center[axis];
+    }
+    header.sphere_radius = obj.local_sphere.radius;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("{}: could not open for writing", path.string()));
+    }
+    const auto write_at = [&](const std::uint64_t offset, const void* data, const std::uint64_t size) {
+        static constexpr char padding[kMeshSectionAlignment] = {};
+        file.write(padding, static_cast<std::streamsize>(offset - static_cast<std::uint64_t>(file.tellp())));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_at(header.vertices.offset, obj.vertices.data(), header.vertices.size);
+    write_at(header.normals.offset, obj.normals.data(), header.normals.size);
+    if (header.index_size == 4) {
+        write_at(header.indices.offset, obj.indices.data(), header.indices.size);
+    }
+    else {
+        std::vector<std::uint16_t> narrow;
+        narrow.reserve(header.index_count);
+        for (const auto& triangle : obj.indices) {
+            narrow.push_back(static_cast<std::uint16_t>(triangle[0]));
+            narrow.push_back(static_cast<std::uint16_t>(triangle[1]));
+            narrow.push_back(static_cast<std::uint16_t>(triangle[2]));
+        }
+        write_at(header.indices.offset, narrow.data(), header.indices.size);
+    }
+
+    if (!file) {
+        throw std::runtime_error(std::format("{}: write failed", path.string()));
+    }
+}
+
+MappedMesh MapMeshFile(const std::filesystem::path& path) {
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::format("{}: {}", path.string(), std::strerror(errno)));
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(MeshFileHeader))) {
+        close(fd);
+        throw std::runtime_error(std::format("{}: not a mesh file", path.string()));
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(std::format("{}: mmap failed: {}", path.string(), std::strerror(errno)));
+    }
+    // sections are read once, front to back, on their way into the upload ring
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    MappedMesh mesh{};
+    mesh.mapping = mapping;
+    mesh.mapping_size = size;
+
+    const auto base = static_cast<const std::byte*>(mapping);
+    const auto& header = *reinterpret_cast<const MeshFileHeader*>(base);
+    const bool valid = header.magic == kMeshFileMagic && header.version == kMeshFileVersion &&
+                       (header.index_size == 2 || header.index_size == 4) && header.index_count % 3 == 0 &&
+                       SectionFits(header.vertices, std::uint64_t{header.vertex_count} * sizeof(PositionAndColorVertex),
+                                   size) &&
+                       SectionFits(header.normals, std::uint64_t{header.vertex_count} * sizeof(VertexNormal), size) &&
+                       SectionFits(header.indices, std::uint64_t{header.index_count} * header.index_size, size);
+    if (!valid) {
+        UnmapMeshFile(mesh);
+        throw std::runtime_error(std::format("{}: unsupported or corrupt mesh file", path.string()));
+    }
+    // an out-of-range index would read past the object's vertex range in the shared heap buffers
+    const auto indices = base + header.indices.offset;
+    const bool indices_valid =
+        header.index_size == 2 ? IndicesInRange<std::uint16_t>(indices, header.index_count, header.vertex_count)
+                               : IndicesInRange<std::uint32_t>(indices, header.index_count, header.vertex_count);
+    if (!indices_valid) {
+        const auto vertex_count = header.vertex_count; // the header goes with the mapping
+        UnmapMeshFile(mesh);
+        throw std::runtime_error(std::format("{}: index out of range of {} vertices", path.string(), vertex_count));
+    }
+
+    mesh.vertex_count = header.vertex_count;
+    mesh.index_count = header.index_count;
+    mesh.index_size = header.index_size;
+    mesh.vertices = {reinterpret_cast<const PositionAndColorVertex*>(base + header.vertices.offset),
+                     header.vertex_count};
+    mesh.normals = {reinterpret_cast<const VertexNormal*>(base + header.normals.offset), header.vertex_count};
+    mesh.indices = {indices, header.indices.size};
+    mesh.box = BoundingBox{{header.box_min[0], header.box_min[1], header.box_min[2]},
+                           {header.box_max[0], header.box_max[1], header.box_max[2]}};
+    mesh.sphere = BoundingSphere{{header.sphere_center[0], header.sphere_center[1], header.sphere_center[2]},
+                                 header.sphere_radius};
+    return mesh;
+}
+
+void UnmapMeshFile(MappedMesh& mesh) {
+    if (mesh.mapping != nullptr) {
+        munmap(mesh.mapping, mesh.mapping_size);
+    }
+    mesh = MappedMesh{};
+}
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <vector>
+
+#include "MeshAdjacency.hpp"
+#include "MeshOptimizer.hpp"
+#include "VertexNormals.hpp"
+
+namespace {
+    constexpr std::uint32_t kNever = ~0u;
+
+    // FIFO post-transform cache: a vertex is resident if fewer than cache_size misses happened since it was loaded.
+    struct FifoCache {
+        std::vector<std::uint32_t> loaded_at;
+        std::uint32_t cache_size;
+        std::uint32_t misses = 0;
+
+        FifoCache(const std::size_t vertex_count, const std::uint32_t size)
+            : loaded_at(vertex_count, kNever), cache_size(size) {
+        }
+        void Reset() {
+            std::fill(loaded_at.begin(), loaded_at.end(), kNever);
+            misses = 0;
+        }
+        // returns the number of misses for the triangle
+        std::uint32_t Access(const TriangleIndices& triangle) {
+            std::uint32_t triangle_misses = 0;
+            for (int corner = 0; corner < 3; ++corner) {
+                const auto v = triangle[corner];
+                if (loaded_at[v] == kNever || misses - loaded_at[v] >= cache_size) {
+                    loaded_at[v] = misses++;
+                    ++triangle_misses;
+                }
+            }
+            return triangle_misses;
+        }
+    };
+
+    struct Cluster {
+        std::uint32_t begin;
+        std::uint32_t end;
+        float sort_key;
+    };
+}
+
+VertexCacheStats AnalyzeVertexCache(const RenderableObject& obj, const std::uint32_t cache_size) {
+    if (obj.indices.empty()) {
+        return VertexCacheStats{};
+    }
+
+    FifoCache cache(obj.vertices.size(), cache_size);
+    std::vector<std::uint8_t> referenced(obj.vertices.size(), 0);
+    std::uint32_t referenced_count = 0;
+    for (const auto& triangle : obj.indices) {
+        cache.Access(triangle);
+        for (int corner = 0; corner < 3; ++corner) {
+            referenced_count += referenced[triangle[corner]] == 0 ? 1 : 0;
+            referenced[triangle[corner]] = 1;
+        }
+    }
+    return VertexCacheStats{static_cast<float>(cache.misses) / static_cast<float>(obj.indices.size()),
+                            static_cast<float>(cache.misses) / static_cast<float>(referenced_count)};
+}
+
+void OptimizeVertexCache(RenderableObject& obj, const std::uint32_t cache_size) {
+    const auto vertex_count = static_cast<std::uint32_t>(obj.vertices.size());
+    TriangleAdjacency adjacency;
+    BuildTriangleAdjacency(adjacency, obj.indices, vertex_count);
+
+    std::vector<std::uint32_t> live_triangles(vertex_count);
+    for (std::uint32_t v = 0; v < vertex_count; ++v) {
+        live_triangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+    std::vector<std::uint32_t> cache_time(vertex_count, 0);
+    std::vector<std::uint8_t> emitted(obj.indices.size(), 0);
+    std::vector<std::uint32_t> dead_end;
+    std::vector<std::uint32_t> candidates;
+    std::vector<TriangleIndices> reordered;
+    reordered.reserve(obj.indices.size());
+
+    std::uint32_t timestamp = cache_size + 1;
+    std::uint32_t scan_cursor = 0;
+    auto fanning = vertex_count > 0 ? 0u : kNever;
+    while (fanning != kNever) {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (auto a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a) {
+            const auto t = adjacency.triangles[a];
+            if (emitted[t] != 0) {
+                continue;
+            }
+            emitted[t] = 1;
+            reordered.push_back(obj.indices[t]);
+            for (int corner = 0; corner < 3; ++corner) {
+                const auto v = obj.indices[t][corner];
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live_triangles[v];
+                if (timestamp - cache_time[v] > cache_size) {
+                    cache_time[v] = timestamp++;
+                }
+            }
+        }
+
+        // next fan: the candidate that stays in cache longest while still having work, else a dead-end fallback
+        auto next = kNever;
+        std::int64_t best_priority = -1;
+        for (const auto v : candidates) {
+            if (live_triangles[v] == 0) {
+                continue;
+            }
+            std::int64_t priority = 0;
+            if (timestamp - cache_time[v] + 2 * live_triangles[v] <= cache_size) {
+                priority = timestamp - cache_time[v];
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = v;
+            }
+        }
+        while (next == kNever && !dead_end.empty()) {
+            const auto v = dead_end.back();
+            dead_end.pop_back();
+            if (live_triangles[v] > 0) {
+                next = v;
+            }
+        }
+        while (next == kNever && scan_cursor < vertex_count) {
+            if (live_triangles[scan_cursor] > 0) {
+                next = scan_cursor;
+            }
+            ++scan_cursor;
+        }
+        fanning = next;
+    }
+
+    obj.indices = std::move(reordered);
+}
+
+float OptimizeOverdraw(RenderableObject& obj, const float threshold) {
+    const auto triangle_count = static_cast<std::uint32_t>(obj.indices.size());
+    if (triangle_count == 0) {
+        return 0.0f;
+    }
+    FifoCache cache(obj.vertices.size(), kVertexCacheSize);
+
+    // hard boundaries: a triangle that misses on all three vertices starts a new strip of cache-ordered work
+    std::vector<std::uint32_t> hard_boundaries;
+    for (std::uint32_t t = 0; t < triangle_count; ++t) {
+        if (cache.Access(obj.indices[t]) == 3) {
+            hard_boundaries.push_back(t);
+        }
+    }
+    hard_boundaries.push_back(triangle_count);
+
+    // soft boundaries: inside each hard cluster, cut wherever the running ACMR is already within threshold of the
+    // cluster's own, so the extra misses caused by reordering at that cut stay small
+    std::vector<Cluster> clusters;
+    for (std::size_t h = 0; h + 1 < hard_boundaries.size(); ++h) {
+        const auto begin = hard_boundaries[h];
+        const auto end = hard_boundaries[h + 1];
+
+        cache.Reset();
+        for (auto t = begin; t < end; ++t) {
+            cache.Access(obj.indices[t]);
+        }
+        const auto cluster_acmr = static_cast<float>(cache.misses) / static_cast<float>(end - begin);
+
+        cache.Reset();
+        auto start = begin;
+        for (auto t = begin; t < end; ++t) {
+            cache.Access(obj.indices[t]);
+            const auto running_acmr = static_cast<float>(cache.misses) / static_cast<float>(t - start + 1);
+            if (t + 1 < end && running_acmr <= cluster_acmr * threshold) {
+                clusters.push_back(Cluster{start, t + 1, 0.0f});
+                start = t + 1;
+                cache.Reset();
+            }
+        }
+        clusters.push_back(Cluster{start, end, 0.0f});
+    }
+
+    // area-weighted centroids and normals; clusters facing away from the mesh centre go first
+    const auto face = [&](const TriangleIndices& triangle, glm::vec3& centroid, float& area) {
+        const auto a = obj.vertices[triangle[0]].pos, b = obj.vertices[triangle[1]].pos, c = obj.vertices[triangle[2]].pos;
+        const auto normal = FaceNormal(a, b, c);
+        area = glm::length(normal);
+        centroid = (a + b + c) / 3.0f;
+        return normal;
+    };
+    glm::vec3 mesh_centroid{0.0f};
+    float mesh_area = 0.0f;
+    for (const auto& triangle : obj.indices) {
+        glm::vec3 centroid;
+        float area;
+        face(triangle, centroid, area);
+        mesh_centroid += centroid * area;
+        mesh_area += area;
+    }
+    mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : glm::vec3{0.0f};
+
+    for (auto& cluster : clusters) {
+        glm::vec3 centroid_sum{0.0f}, normal_sum{0.0f};
+        float area_sum = 0.0f;
+        for (auto t = cluster.begin; t < cluster.end; ++t) {
+            glm::vec3 centroid;
+            float area;
+            normal_sum += face(obj.indices[t], centroid, area);
+            centroid_sum += centroid * area;
+            area_sum += area;
+        }
+        const auto normal_length = glm::length(normal_sum);
+        if (area_sum > 0.0f && normal_length > 0.0f) {
+            cluster.sort_key = glm::dot(centroid_sum / area_sum - mesh_centroid, normal_sum / normal_length);
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.sort_key > b.sort_key; });
+
+    std::vector<TriangleIndices> reordered;
+    reordered.reserve(triangle_count);
+    for (const auto& cluster : clusters) {
+        reordered.insert(reordered.end(), obj.indices.begin() + cluster.begin, obj.indices.begin() + cluster.end);
+    }
+    obj.indices = std::move(reordered);
+    return clusters.front().sort_key;
+}
+
+void OptimizeVertexFetch(RenderableObject& obj) {
+    const auto vertex_count = static_cast<std::uint32_t>(obj.vertices.size());
+    std::vector<std::uint32_t> remap(vertex_count, kNever);
+    std::uint32_t next = 0;
+    for (auto& triangle : obj.indices) {
+        for (int corner = 0; corner < 3; ++corner) {
+            auto& v = triangle[corner];
+            if (remap[v] == kNever) {
+                remap[v] = next++;
+            }
+            v = remap[v];
+        }
+    }
+    for (std::uint32_t v = 0; v < vertex_count; ++v) {
+        if (remap[v] == kNever) {
+            remap[v] = next++;
+        }
+    }
+
+    const bool has_normals = obj.normals.size() == obj.vertices.size();
+    std::vector<PositionAndColorVertex> vertices(vertex_count);
+    std::vector<VertexNormal> normals(has_normals ? vertex_count : 0);
+    for (std::uint32_t v = 0; v < vertex_count; ++v) {
+        vertices[remap[v]] = obj.vertices[v];
+        if (has_normals) {
+            normals[remap[v]] = obj.normals[v];
+        }
+    }
+    obj.vertices = std::move(vertices);
+    if (has_normals) {
+        obj.normals = std::move(normals);
+    }
+}
+
+MeshOptimizationStats OptimizeMesh(RenderableObject& obj) {
+    MeshOptimizationStats stats{};
+    stats.before = AnalyzeVertexCache(obj);
+    OptimizeVertexCache(obj);
+    stats.front_facing = OptimizeOverdraw(obj);
+    OptimizeVertexFetch(obj);
+    stats.after = AnalyzeVertexCache(obj);
+    return stats;
+}
+
+void PrintMeshOptimizationReport(const std::string_view name, const MeshOptimizationStats& stats) {
+    std::cout << std::format("  {:<8} ACMR {:5.3f} -> {:5.3f}  ATVR {:5.3f} -> {:5.3f}  first cluster facing {:+.3f}\n",
+                             name, stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr,
+                             stats.front_facing);
+}
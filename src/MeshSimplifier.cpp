@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+#include "MeshAdjacency.hpp"
+#include "MeshSimplifier.hpp"
+
+namespace {
+    constexpr double kBorderWeight = 10.0;
+    // a collapse may tilt a neighbouring triangle by up to ~87 degrees, but not flip it
+    constexpr float kMinNormalCosine = 0.05f;
+
+    // Symmetric 4x4 plane quadric plus the total weight of the planes in it.
+    struct Quadric {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+        double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+        double a22 = 0.0, a23 = 0.0;
+        double a33 = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(const glm::dvec3 n, const double d, const double w) {
+            a00 += w * n.x * n.x, a01 += w * n.x * n.y, a02 += w * n.x * n.z, a03 += w * n.x * d;
+            a11 += w * n.y * n.y, a12 += w * n.y * n.z, a13 += w * n.y * d;
+            a22 += w * n.z * n.z, a23 += w * n.z * d;
+            a33 += w * d * d;
+            weight += w;
+        }
+        void Add(const Quadric& q) {
+            a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+            a11 += q.a11, a12 += q.a12, a13 += q.a13;
+            a22 += q.a22, a23 += q.a23;
+            a33 += q.a33;
+            weight += q.weight;
+        }
+        // weighted mean squared distance from p to the planes
+        double Error(const glm::vec3 p) const {
+            const double x = p.x, y = p.y, z = p.z;
+            const auto sum = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                             2.0 * (a03 * x + a13 * y + a23 * z) + a33;
+            return weight > 0.0 ? std::abs(sum) / weight : 0.0;
+        }
+    };
+
+    enum class VertexKind : std::uint8_t {
+        Interior,
+        Border, // on exactly two open edges
+        Locked, // seam, corner of several borders, or non-manifold
+    };
+
+    struct Collapse {
+        std::uint32_t from;
+        std::uint32_t to;
+        double error;
+    };
+
+    // edges between position ids, sorted, so membership is a binary search
+    struct EdgeTopology {
+        std::vector<std::uint64_t> border;       // used by one triangle
+        std::vector<std::uint64_t> non_manifold; // used by three or more
+    };
+
+    std::uint64_t EdgeKey(const std::uint32_t a, const std::uint32_t b) {
+        return a < b ? (std::uint64_t{a} << 32) | b : (std::uint64_t{b} << 32) | a;
+    }
+
+    // Vertices at bit-identical positions share a position id: the lowest vertex index among them.
+    std::vector<std::uint32_t> WeldPositions(const RenderableObject& obj) {
+        const auto count = static_cast<std::uint32_t>(obj.vertices.size());
+        std::vector<std::uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](const std::uint32_t a, const std::uint32_t b) {
+            const auto& pa = obj.vertices[a].pos;
+            const auto& pb = obj.vertices[b].pos;
+            return std::tie(pa.x, pa.y, pa.z, a) < std::tie(pb.x, pb.y, pb.z, b);
+        });
+
+        std::vector<std::uint32_t> position(count);
+        for (std::uint32_t begin = 0, end = 0; begin < count; begin = end) {
+            while (end < count && obj.vertices[order[end]].pos == obj.vertices[order[begin]].pos) {
+                position[order[end++]] = order[begin];
+            }
+        }
+        return position;
+    }
+
+    EdgeTopology ClassifyEdges(const std::vector<TriangleIndices>& indices,
+                               const std::vector<std::uint32_t>& position) {
+        std::vector<std::uint64_t> edges;
+        edges.reserve(indices.size() * 3);
+        for (const auto& triangle : indices) {
+            for (int corner = 0; corner < 3; ++corner) {
+                edges.push_back(EdgeKey(position[triangle[corner]], position[triangle[(corner + 1) % 3]]));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        EdgeTopology topology;
+        for (std::size_t begin = 0, end = 0; begin < edges.size(); begin = end) {
+            while (end < edges.size() && edges[end] == edges[begin]) {
+                ++end;
+            }
+            if (end - begin == 1) {
+                topology.border.push_back(edges[begin]);
+            }
+            else if (end - begin > 2) {
+                topology.non_manifold.push_back(edges[begin]);
+            }
+        }
+        return topology;
+    }
+
+    bool IsBorderEdge(const EdgeTopology& topology, const std::uint32_t a, const std::uint32_t b) {
+        return std::binary_search(topology.border.begin(), topology.border.end(), EdgeKey(a, b));
+    }
+
+    std::vector<VertexKind> ClassifyVertices(const std::vector<std::uint32_t>& position, const EdgeTopology& topology) {
+        const auto count = position.size();
+        std::vector<std::uint32_t> wedges(count, 0);
+        std::vector<std::uint32_t> border_edges(count, 0);
+        std::vector<std::uint8_t> non_manifold(count, 0);
+        for (std::size_t v = 0; v < count; ++v) {
+            ++wedges[position[v]];
+        }
+        for (const auto edge : topology.border) {
+            ++border_edges[edge >> 32];
+            ++border_edges[edge & 0xFFFFFFFFu];
+        }
+        for (const auto edge : topology.non_manifold) {
+            non_manifold[edge >> 32] = 1;
+            non_manifold[edge & 0xFFFFFFFFu] = 1;
+        }
+
+        std::vector<VertexKind> kinds(count, VertexKind::Locked);
+        for (std::size_t v = 0; v < count; ++v) {
+            const auto p = position[v];
+            if (wedges[p] > 1 || non_manifold[p] != 0) {
+                continue;
+            }
+            if (border_edges[p] == 0) {
+                kinds[v] = VertexKind::Interior;
+            }
+            else if (border_edges[p] == 2) {
+                kinds[v] = VertexKind::Border;
+            }
+        }
+        return kinds;
+    }
+
+    std::vector<Quadric> BuildQuadrics(const RenderableObject& obj, const std::vector<TriangleIndices>& indices,
+                                       const std::vector<std::uint32_t>& position, const EdgeTopology& topology) {
+        std::vector<Quadric> quadrics(obj.vertices.size());
+        for (const auto& triangle : indices) {
+            const glm::dvec3 corners[3] = {glm::dvec3{obj.vertices[triangle[0]].pos},
+                                           glm::dvec3{obj.vertices[triangle[1]].pos},
+                                           glm::dvec3{obj.vertices[triangle[2]].pos}};
+            const auto cross = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            const auto length = glm::length(cross);
+            if (length == 0.0) {
+                continue;
+            }
+            const auto normal = cross / length;
+            for (int corner = 0; corner < 3; ++corner) {
+                quadrics[position[triangle[corner]]].AddPlane(normal, -glm::dot(normal, corners[0]), length * 0.5);
+            }
+
+            // open edges also get a plane through the edge, perpendicular to the surface, so borders hold their shape
+            for (int corner = 0; corner < 3; ++corner) {
+                const auto a = position[triangle[corner]], b = position[triangle[(corner + 1) % 3]];
+                if (!IsBorderEdge(topology, a, b)) {
+                    continue;
+                }
+                const auto edge = corners[(corner + 1) % 3] - corners[corner];
+                const auto border_cross = glm::cross(edge, normal);
+                const auto border_length = glm::length(border_cross);
+                if (border_length == 0.0) {
+                    continue;
+                }
+                const auto border_normal = border_cross / border_length;
+                const auto distance = -glm::dot(border_normal, corners[corner]);
+                const auto weight = glm::dot(edge, edge) * kBorderWeight;
+                quadrics[a].AddPlane(border_normal, distance, weight);
+                quadrics[b].AddPlane(border_normal, distance, weight);
+            }
+        }
+        return quadrics;
+    }
+
+    bool CanCollapse(const std::vector<VertexKind>& kinds, const std::vector<std::uint32_t>& position,
+                     const EdgeTopology& topology, const std::uint32_t from, const std::uint32_t to) {
+        switch (kinds[from]) {
+        case VertexKind::Interior:
+            return true;
+        case VertexKind::Border:
+            return kinds[to] != VertexKind::Interior && IsBorderEdge(topology, position[from], position[to]);
+        default:
+            return false;
+        }
+    }
+
+    // Rejects the collapse if any triangle around `from` that survives it would flip; counts the ones that don't.
+    bool KeepsOrientation(const RenderableObject& obj, const std::vector<TriangleIndices>& indices,
+                          const TriangleAdjacency& adjacency, const std::uint32_t from, const std::uint32_t to,
+                          std::size_t& removed) {
+        removed = 0;
+        for (auto a = adjacency.offsets[from]; a < adjacency.offsets[from + 1]; ++a) {
+            const auto& triangle = indices[adjacency.triangles[a]];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                ++removed;
+                continue;
+            }
+            glm::vec3 corners[3] = {obj.vertices[triangle[0]].pos, obj.vertices[triangle[1]].pos,
+                                    obj.vertices[triangle[2]].pos};
+            const auto before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            for (int corner = 0; corner < 3; ++corner) {
+                corners[corner] = triangle[corner] == from ? obj.vertices[to].pos : corners[corner];
+            }
+            const auto after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            const auto before_length = glm::length(before);
+            if (before_length > 0.0f &&
+                glm::dot(before, after) <= kMinNormalCosine * before_length * glm::length(after)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+LodLevel SimplifyMesh(const RenderableObject& obj, const std::vector<TriangleIndices>& indices,
+                      const std::size_t target_triangle_count, const float max_error) {
+    LodLevel level{indices, 0.0f};
+    auto& result = level.indices;
+    if (result.size() <= target_triangle_count) {
+        return level;
+    }
+
+    const auto vertex_count = obj.vertices.size();
+    const auto position = WeldPositions(obj);
+    auto topology = ClassifyEdges(result, position);
+    const auto kinds = ClassifyVertices(position, topology);
+    auto quadrics = BuildQuadrics(obj, result, position, topology);
+
+    const auto error_limit = static_cast<double>(max_error) * static_cast<double>(max_error);
+    double max_applied = 0.0;
+    std::vector<Collapse> collapses;
+    TriangleAdjacency adjacency;
+    std::vector<std::uint32_t> remap(vertex_count);
+    std::vector<std::uint8_t> touched(vertex_count);
+
+    while (result.size() > target_triangle_count) {
+        BuildTriangleAdjacency(adjacency, result, vertex_count);
+
+        // Each directed edge once: interior edges appear in both directions across their two triangles, and a
+        // consistently wound border reaches every border vertex through the border edge that leaves it.
+        collapses.clear();
+        for (const auto& triangle : result) {
+            for (int corner = 0; corner < 3; ++corner) {
+                const auto a = triangle[corner], b = triangle[(corner + 1) % 3];
+                if (CanCollapse(kinds, position, topology, a, b)) {
+                    collapses.push_back(Collapse{a, b, quadrics[position[a]].Error(obj.vertices[b].pos)});
+                }
+            }
+        }
+        // only the cheapest few are needed: most collapses are skipped for touching an earlier one's one-ring
+        const auto cheaper = [](const Collapse& a, const Collapse& b) { return a.error < b.error; };
+        const auto candidates = std::min(collapses.size(), (result.size() - target_triangle_count) * 4);
+        std::nth_element(collapses.begin(), collapses.begin() + candidates, collapses.end(), cheaper);
+        collapses.resize(candidates);
+        std::sort(collapses.begin(), collapses.end(), cheaper);
+
+        // a collapse freezes the one-ring it changes for the rest of the pass, so every orientation check above
+        // sees positions that are still current
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), 0);
+        auto remaining = result.size();
+        std::size_t applied = 0;
+        for (const auto& collapse : collapses) {
+            if (collapse.error > error_limit || remaining <= target_triangle_count) {
+                break;
+            }
+            std::size_t removed = 0;
+            if (touched[collapse.from] != 0 || touched[collapse.to] != 0 ||
+                !KeepsOrientation(obj, result, adjacency, collapse.from, collapse.to, removed)) {
+                continue;
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[position[collapse.to]].Add(quadrics[position[collapse.from]]);
+            for (auto a = adjacency.offsets[collapse.from]; a < adjacency.offsets[collapse.from + 1]; ++a) {
+                const auto& triangle = result[adjacency.triangles[a]];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+            max_applied = std::max(max_applied, collapse.error);
+            remaining -= removed;
+            ++applied;
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        // remap in place, dropping the triangles that collapsed, without changing the order of the rest
+        std::size_t kept = 0;
+        for (const auto& triangle : result) {
+            const auto mapped = TriangleIndices{remap[triangle[0]], remap[triangle[1]], remap[triangle[2]]};
+            if (mapped[0] != mapped[1] && mapped[1] != mapped[2] && mapped[0] != mapped[2]) {
+                result[kept++] = mapped;
+            }
+        }
+        result.resize(kept);
+
+        // only border collapses change the border: the collapsed edge disappears and its neighbour moves
+        auto& border = topology.border;
+        std::size_t border_kept = 0;
+        for (const auto edge : border) {
+            const auto a = position[remap[edge >> 32]], b = position[remap[edge & 0xFFFFFFFFu]];
+            if (a != b) {
+                border[border_kept++] = EdgeKey(a, b);
+            }
+        }
+        border.resize(border_kept);
+        std::sort(border.begin(), border.end());
+    }
+
+    level.error = static_cast<float>(std::sqrt(max_applied));
+    return level;
+}
+
+void BuildLodChain(RenderableObject& obj, const LodChainSettings& settings) {
+    obj.lods.clear();
+    obj.lods.reserve(kMaxLodLevels - 1);
+    const auto* parent = &obj.indices;
+    float parent_error = 0.0f;
+    while (obj.lods.size() + 1 < kMaxLodLevels && parent->size() > settings.min_triangles) {
+        const auto target = std::max(static_cast<std::size_t>(static_cast<float>(parent->size()) * settings.reduction),
+                                     settings.min_triangles);
+        auto level = SimplifyMesh(obj, *parent, target, std::numeric_limits<float>::max());
+        if (static_cast<float>(level.indices.size()) > static_cast<float>(parent->size()) * settings.min_reduction) {
+            break;
+        }
+        level.error += parent_error;
+        parent_error = level.error;
+        obj.lods.push_back(std::move(level));
+        parent = &obj.lods.back().indices;
+    }
+}
+
+void BuildLodChains(std::vector<RenderableObject>& objects, ThreadPool& pool, const LodChainSettings& settings) {
+    pool.ParallelFor(objects.size(), 1, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i) {
+            BuildLodChain(objects[i], settings);
+        }
+    });
+}
+
+void PrintLodChainReport(const std::string_view name, const RenderableObject& obj) {
+    std::cout << std::format("  {:<8} LOD0 {:>8} tris", name, obj.indices.size());
+    for (std::size_t level = 0; level < obj.lods.size(); ++level) {
+        std::cout << std::format("  LOD{} {:>8} tris (error {:.3g})", level + 1, obj.lods[level].indices.size(),
+                                 obj.lods[level].error);
+    }
+    std::cout << "\n";
+}
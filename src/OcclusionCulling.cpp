@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include "FrameStats.hpp"
+#include "OcclusionCulling.hpp"
+
+namespace {
+    constexpr float kNearClipW = 1e-5f;
+    constexpr float kMinOccluderDepth = 1e-3f;
+    constexpr std::size_t kTestGrain = 256;
+
+    float EdgeFunction(const float ax, const float ay, const float bx, const float by, const float px,
+                       const float py) {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    }
+
+    // Sutherland-Hodgman against w > kNearClipW; x, y and depth are left to the texel bounds, as for the scene.
+    int ClipToNearPlane(const glm::vec4 (&in)[3], glm::vec4 (&out)[4]) {
+        int count = 0;
+        for (int i = 0; i < 3; ++i) {
+            const auto& a = in[i];
+            const auto& b = in[(i + 1) % 3];
+            const bool a_inside = a.w > kNearClipW;
+            const bool b_inside = b.w > kNearClipW;
+            if (a_inside) {
+                out[count++] = a;
+            }
+            if (a_inside != b_inside) {
+                out[count++] = a + (b - a) * ((kNearClipW - a.w) / (b.w - a.w));
+            }
+        }
+        return count;
+    }
+
+    void SetupTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2, const int width,
+                       const int height, OccluderTriangle& tri) {
+        tri.min_y = 1;
+        tri.max_y = 0;
+        const glm::vec4* verts[3] = {&v0, &v1, &v2};
+        for (int i = 0; i < 3; ++i) {
+            const auto inv_w = 1.0f / verts[i]->w;
+            tri.x[i] = (verts[i]->x * inv_w * 0.5f + 0.5f) * static_cast<float>(width);
+            tri.y[i] = (0.5f - verts[i]->y * inv_w * 0.5f) * static_cast<float>(height);
+            tri.inv_w[i] = inv_w;
+        }
+
+        auto area = EdgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+        if (area == 0.0f || !std::isfinite(area)) {
+            return;
+        }
+        // occluders hide what is behind them from either side
+        if (area < 0.0f) {
+            std::swap(tri.x[1], tri.x[2]);
+            std::swap(tri.y[1], tri.y[2]);
+            std::swap(tri.inv_w[1], tri.inv_w[2]);
+            area = -area;
+        }
+        tri.inv_area = 1.0f / area;
+
+        tri.min_x = std::max(0, static_cast<int>(std::floor(std::min({tri.x[0], tri.x[1], tri.x[2]}) - 0.5f)));
+        tri.min_y = std::max(0, static_cast<int>(std::floor(std::min({tri.y[0], tri.y[1], tri.y[2]}) - 0.5f)));
+        tri.max_x = std::min(width - 1, static_cast<int>(std::ceil(std::max({tri.x[0], tri.x[1], tri.x[2]}) - 0.5f)));
+        tri.max_y = std::min(height - 1, static_cast<int>(std::ceil(std::max({tri.y[0], tri.y[1], tri.y[2]}) - 0.5f)));
+        if (tri.min_x > tri.max_x) {
+            tri.max_y = tri.min_y - 1;
+        }
+    }
+
+    // The occluders with the largest bounding spheres for their view depth, in no particular order.
+    void PickOccluders(OcclusionCuller& culler, const std::vector<RenderableObject>& objects, const SceneBounds& bounds,
+                       const glm::mat4& view_proj) {
+        const auto& settings = culler.settings;
+        culler.candidates.clear();
+        for (const auto i : bounds.visible_objects) {
+            const auto& obj = objects[i];
+            if (obj.vertices.empty() || obj.indices.empty() || obj.indices.size() > settings.max_occluder_triangles) {
+                continue;
+            }
+            // clip w is the view depth
+            const auto depth = view_proj[0][3] * bounds.sphere_x[i] + view_proj[1][3] * bounds.sphere_y[i] +
+                               view_proj[2][3] * bounds.sphere_z[i] + view_proj[3][3];
+            const auto size = bounds.sphere_radius[i] / std::max(depth, kMinOccluderDepth);
+            if (size >= settings.min_occluder_size) {
+                culler.candidates.emplace_back(size, i);
+            }
+        }
+
+        const auto count = std::min<std::size_t>(culler.candidates.size(), settings.max_occluders);
+        std::nth_element(culler.candidates.begin(), culler.candidates.begin() + count, culler.candidates.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+        culler.occluders.clear();
+        for (std::size_t k = 0; k < count; ++k) {
+            culler.occluders.push_back(culler.candidates[k].second);
+            culler.is_occluder[culler.candidates[k].second] = 1;
+        }
+    }
+
+    // One job per occluder: its vertices into clip space, its triangles near-clipped into its two slots each.
+    void SetupOccluders(OcclusionCuller& culler, const std::vector<RenderableObject>& objects,
+                        const glm::mat4& view_proj, ThreadPool& pool) {
+        auto& vertex_offsets = culler.vertex_offsets;
+        auto& triangle_offsets = culler.triangle_offsets;
+        vertex_offsets.assign(1, 0);
+        triangle_offsets.assign(1, 0);
+        for (const auto i : culler.occluders) {
+            vertex_offsets.push_back(vertex_offsets.back() + objects[i].vertices.size());
+            triangle_offsets.push_back(triangle_offsets.back() + 2 * objects[i].indices.size());
+        }
+        culler.clip_positions.resize(vertex_offsets.back());
+        culler.triangles.resize(triangle_offsets.back());
+
+        pool.ParallelFor(culler.occluders.size(), 1, [&](const std::size_t begin, const std::size_t end, unsigned) {
+            for (auto k = begin; k < end; ++k) {
+                const auto& obj = objects[culler.occluders[k]];
+                const auto mvp = view_proj * obj.model;
+                auto* clip = &culler.clip_positions[vertex_offsets[k]];
+                for (std::size_t v = 0; v < obj.vertices.size(); ++v) {
+                    clip[v] = mvp * glm::vec4{obj.vertices[v].pos, 1.0f};
+                }
+
+                auto* triangles = &culler.triangles[triangle_offsets[k]];
+                for (std::size_t t = 0; t < obj.indices.size(); ++t) {
+                    const auto& indices = obj.indices[t];
+                    const glm::vec4 corners[3] = {clip[indices[0]], clip[indices[1]], clip[indices[2]]};
+                    glm::vec4 clipped[4];
+                    const auto clipped_count = ClipToNearPlane(corners, clipped);
+                    for (int half = 0; half < 2; ++half) {
+                        auto& tri = triangles[2 * t + half];
+                        if (half + 2 < clipped_count) {
+                            SetupTriangle(clipped[0], clipped[half + 1], clipped[half + 2], culler.settings.width,
+                                          culler.settings.height, tri);
+                        }
+                        else {
+                            tri.min_y = 1;
+                            tri.max_y = 0;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // Rows [row_begin, row_end) of every triangle, keeping the nearest depth in each texel.
+    void RasterizeBand(OcclusionCuller& culler, const int row_begin, const int row_end) {
+        const auto width = culler.settings.width;
+        for (const auto& tri : culler.triangles) {
+            const auto y_begin = std::max(tri.min_y, row_begin);
+            const auto y_end = std::min(tri.max_y + 1, row_end);
+            if (y_begin >= y_end) {
+                continue;
+            }
+
+            // edge functions at the first texel of the row and their step per texel; vertex i's weight is the edge
+            // opposite it
+            float step_x[3];
+            float step_y[3];
+            float row_origin[3];
+            const float px = static_cast<float>(tri.min_x) + 0.5f;
+            const float py = static_cast<float>(y_begin) + 0.5f;
+            for (int i = 0; i < 3; ++i) {
+                const int a = (i + 1) % 3;
+                const int b = (i + 2) % 3;
+                row_origin[i] = EdgeFunction(tri.x[a], tri.y[a], tri.x[b], tri.y[b], px, py);
+                step_x[i] = -(tri.y[b] - tri.y[a]);
+                step_y[i] = tri.x[b] - tri.x[a];
+            }
+
+            for (int y = y_begin; y < y_end; ++y) {
+                auto* depth_row = &culler.depth[static_cast<std::size_t>(y) * width];
+                for (int x = tri.min_x; x <= tri.max_x; x += kOcclusionLanes) {
+                    const auto dx = static_cast<float>(x - tri.min_x);
+
+                    // fixed-width lanes the compiler turns into SIMD; edges are inclusive, so meshes stay watertight
+                    float depth[kOcclusionLanes];
+                    for (int lane = 0; lane < kOcclusionLanes; ++lane) {
+                        const auto lane_x = dx + static_cast<float>(lane);
+                        const auto w0 = row_origin[0] + step_x[0] * lane_x;
+                        const auto w1 = row_origin[1] + step_x[1] * lane_x;
+                        const auto w2 = row_origin[2] + step_x[2] * lane_x;
+                        const bool covered = (w0 >= 0.0f) & (w1 >= 0.0f) & (w2 >= 0.0f);
+                        const auto d = (w0 * tri.inv_w[0] + w1 * tri.inv_w[1] + w2 * tri.inv_w[2]) * tri.inv_area;
+                        depth[lane] = covered ? d : 0.0f;
+                    }
+
+                    const auto lane_count = std::min(kOcclusionLanes, tri.max_x + 1 - x);
+                    for (int lane = 0; lane < lane_count; ++lane) {
+                        depth_row[x + lane] = std::max(depth_row[x + lane], depth[lane]);
+                    }
+                }
+                for (int i = 0; i < 3; ++i) {
+                    row_origin[i] += step_y[i];
+                }
+            }
+        }
+    }
+
+    // True when every texel under the object's projected box holds something nearer than the box's nearest corner.
+    bool IsOccluded(const OcclusionCuller& culler, const SceneBounds& bounds, const std::uint32_t i,
+                    const glm::mat4& view_proj) {
+        const auto width = culler.settings.width;
+        const auto height = culler.settings.height;
+        const auto center = glm::vec3{bounds.center_x[i], bounds.center_y[i], bounds.center_z[i]};
+        const auto extent = glm::vec3{bounds.extent_x[i], bounds.extent_y[i], bounds.extent_z[i]};
+
+        auto min_x = static_cast<float>(width);
+        auto min_y = static_cast<float>(height);
+        auto max_x = 0.0f;
+        auto max_y = 0.0f;
+        auto nearest = 0.0f;
+        for (int corner = 0; corner < 8; ++corner) {
+            const auto offset = glm::vec3{(corner & 1) != 0 ? 1.0f : -1.0f, (corner & 2) != 0 ? 1.0f : -1.0f,
+                                          (corner & 4) != 0 ? 1.0f : -1.0f};
+            const auto clip = view_proj * glm::vec4{center + extent * offset, 1.0f};
+            if (clip.w <= kNearClipW) {
+                return false;
+            }
+            const auto inv_w = 1.0f / clip.w;
+            const auto x = (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(width);
+            const auto y = (0.5f - clip.y * inv_w * 0.5f) * static_cast<float>(height);
+            min_x = std::min(min_x, x), max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y), max_y = std::max(max_y, y);
+            nearest = std::max(nearest, inv_w);
+        }
+
+        // every texel the rectangle touches
+        const auto x_begin = std::max(0, static_cast<int>(std::floor(min_x)));
+        const auto y_begin = std::max(0, static_cast<int>(std::floor(min_y)));
+        const auto x_end = std::min(width, static_cast<int>(std::floor(max_x)) + 1);
+        const auto y_end = std::min(height, static_cast<int>(std::floor(max_y)) + 1);
+        if (x_begin >= x_end || y_begin >= y_end) {
+            return false;
+        }
+        for (int y = y_begin; y < y_end; ++y) {
+            const auto* depth_row = &culler.depth[static_cast<std::size_t>(y) * width];
+            for (int x = x_begin; x < x_end; ++x) {
+                if (!(depth_row[x] > nearest)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+OcclusionCuller CreateOcclusionCuller(const OcclusionSettings& settings) {
+    if (settings.width <= 0 || settings.height <= 0) {
+        throw std::invalid_argument("OcclusionSettings: empty depth buffer");
+    }
+    OcclusionCuller culler{.settings = settings};
+    culler.depth.resize(static_cast<std::size_t>(settings.width) * settings.height);
+    return culler;
+}
+
+void CullOccludedObjects(OcclusionCuller& culler, const std::vector<RenderableObject>& objects, SceneBounds& bounds,
+                         const glm::mat4& view_proj, ThreadPool& pool) {
+    auto& stats = culler.frame_stats;
+    stats = OcclusionStats{};
+
+    const auto raster_start = FrameClock::now();
+    culler.is_occluder.assign(objects.size(), 0);
+    PickOccluders(culler, objects, bounds, view_proj);
+    SetupOccluders(culler, objects, view_proj, pool);
+    std::fill(culler.depth.begin(), culler.depth.end(), 0.0f);
+    const auto bands = (culler.settings.height + kOcclusionBandHeight - 1) / kOcclusionBandHeight;
+    pool.ParallelFor(bands, 1, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto band = begin; band < end; ++band) {
+            const auto row_begin = static_cast<int>(band) * kOcclusionBandHeight;
+            RasterizeBand(culler, row_begin, std::min(row_begin + kOcclusionBandHeight, culler.settings.height));
+        }
+    });
+    stats.raster_ms = MillisecondsBetween(raster_start, FrameClock::now());
+    stats.occluders = culler.occluders.size();
+    stats.occluder_triangles = static_cast<std::uint64_t>(std::ranges::count_if(
+        culler.triangles, [](const OccluderTriangle& tri) { return tri.min_y <= tri.max_y; }));
+
+    // occluders are drawn by definition, and nothing can hide behind an empty buffer
+    const auto test_start = FrameClock::now();
+    auto& visible = bounds.visible_objects;
+    stats.tested = visible.size() - culler.occluders.size();
+    if (!culler.occluders.empty()) {
+        pool.ParallelFor(visible.size(), kTestGrain, [&](const std::size_t begin, const std::size_t end, unsigned) {
+            for (auto k = begin; k < end; ++k) {
+                const auto i = visible[k];
+                if (culler.is_occluder[i] == 0 && IsOccluded(culler, bounds, i, view_proj)) {
+                    bounds.visible[i] = 0;
+                }
+            }
+        });
+        const auto hidden = std::ranges::remove_if(visible, [&](const auto i) { return bounds.visible[i] == 0; });
+        stats.culled = static_cast<std::uint64_t>(hidden.size());
+        visible.erase(hidden.begin(), hidden.end());
+    }
+    stats.test_ms = MillisecondsBetween(test_start, FrameClock::now());
+
+    auto& total = culler.total_stats;
+    total.raster_ms += stats.raster_ms;
+    total.test_ms += stats.test_ms;
+    total.occluders += stats.occluders;
+    total.occluder_triangles += stats.occluder_triangles;
+    total.tested += stats.tested;
+    total.culled += stats.culled;
+}
+
+void PrintOcclusionReport(const OcclusionStats& stats, const std::size_t frame_count) {
+    const auto frames = static_cast<double>(std::max<std::size_t>(frame_count, 1));
+    const auto tested = static_cast<double>(std::max<std::uint64_t>(stats.tested, 1));
+    std::cout << std::format("Occlusion culling over {} frames:\n", frame_count);
+    std::cout << std::format("  occluders/frame {:.1f} ({:.0f} triangles)  raster {:.3f} ms/frame  test {:.3f} "
+                             "ms/frame\n",
+                             static_cast<double>(stats.occluders) / frames,
+                             static_cast<double>(stats.occluder_triangles) / frames, stats.raster_ms / frames,
+                             stats.test_ms / frames);
+    std::cout << std::format("  culled/frame {:.1f} of {:.1f} tested ({:.1f}%)\n",
+                             static_cast<double>(stats.culled) / frames, static_cast<double>(stats.tested) / frames,
+                             100.0 * static_cast<double>(stats.culled) / tested);
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "Hashing.hpp"
+#include "PipelineCache.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    // SDL's GPU structs spell out their padding members, so their bytes are their values
+    template <typename T>
+    std::uint64_t HashValue(const std::uint64_t hash, const T& value) {
+        return HashBytes(hash, &value, sizeof(T));
+    }
+    template <typename T>
+    std::uint64_t HashValues(const std::uint64_t hash, const std::vector<T>& values) {
+        return HashBytes(HashValue(hash, values.size()), values.data(), values.size() * sizeof(T));
+    }
+
+    std::uint64_t HashShader(std::uint64_t hash, const ShaderDesc& shader) {
+        hash = HashBytes(HashValue(hash, shader.name.size()), shader.name.data(), shader.name.size());
+        for (const auto value : {static_cast<std::uint32_t>(shader.stage), shader.num_samplers,
+                                 shader.num_storage_textures, shader.num_storage_buffers, shader.num_uniform_buffers}) {
+            hash = HashValue(hash, value);
+        }
+        return hash;
+    }
+
+    std::uint64_t HashDesc(const PipelineDesc& desc) {
+        auto hash = HashShader(HashShader(kFnvOffsetBasis, desc.vertex), desc.fragment);
+        hash = HashValue(hash, desc.primitive_type);
+        hash = HashValue(hash, desc.rasterizer_state);
+        hash = HashValue(hash, desc.multisample_state);
+        hash = HashValue(hash, desc.depth_stencil_state);
+        hash = HashValues(hash, desc.vertex_buffers);
+        hash = HashValues(hash, desc.vertex_attributes);
+        hash = HashValues(hash, desc.color_targets);
+        hash = HashValue(hash, desc.has_depth_stencil_target);
+        return HashValue(hash, desc.depth_stencil_format);
+    }
+
+    struct SDLFree {
+        void operator()(void* data) const {
+            SDL_free(data);
+        }
+    };
+    struct ShaderFile {
+        std::unique_ptr<void, SDLFree> data;
+        std::size_t size = 0;
+    };
+
+    ShaderFile LoadShaderFile(const std::filesystem::path& path) {
+        ShaderFile file{};
+        file.data.reset(SDL_LoadFile(path.string().c_str(), &file.size));
+        return file;
+    }
+
+    SDL_GPUShader* CreateShader(SDL_GPUDevice* device, const ShaderDesc& shader, const ShaderFile& file,
+                                const SDL_GPUShaderFormat format, const char* entrypoint) {
+        SDL_GPUShaderCreateInfo info{};
+        info.code_size = file.size;
+        info.code = static_cast<const Uint8*>(file.data.get());
+        info.entrypoint = entrypoint;
+        info.format = format;
+        info.stage = shader.stage;
+        info.num_samplers = shader.num_samplers;
+        info.num_storage_textures = shader.num_storage_textures;
+        info.num_storage_buffers = shader.num_storage_buffers;
+        info.num_uniform_buffers = shader.num_uniform_buffers;
+        return SDL_CreateGPUShader(device, &info);
+    }
+
+    // The shaders are only needed until the pipeline exists.
+    SDL_GPUGraphicsPipeline* CreatePipeline(SDL_GPUDevice* device, const PipelineDesc& desc,
+                                            SDL_GPUShader* vertex_shader, SDL_GPUShader* fragment_shader) {
+        SDL_GPUGraphicsPipelineCreateInfo info{};
+        info.vertex_shader = vertex_shader;
+        info.fragment_shader = fragment_shader;
+        info.vertex_input_state.vertex_buffer_descriptions = desc.vertex_buffers.data();
+        info.vertex_input_state.num_vertex_buffers = static_cast<Uint32>(desc.vertex_buffers.size());
+        info.vertex_input_state.vertex_attributes = desc.vertex_attributes.data();
+        info.vertex_input_state.num_vertex_attributes = static_cast<Uint32>(desc.vertex_attributes.size());
+        info.primitive_type = desc.primitive_type;
+        info.rasterizer_state = desc.rasterizer_state;
+        info.multisample_state = desc.multisample_state;
+        info.depth_stencil_state = desc.depth_stencil_state;
+        info.target_info.color_target_descriptions = desc.color_targets.data();
+        info.target_info.num_color_targets = static_cast<Uint32>(desc.color_targets.size());
+        info.target_info.depth_stencil_format = desc.depth_stencil_format;
+        info.target_info.has_depth_stencil_target = desc.has_depth_stencil_target;
+        return SDL_CreateGPUGraphicsPipeline(device, &info);
+    }
+}
+
+PipelineCache::PipelineCache(SDL_GPUDevice* device, std::filesystem::path directory, const SDL_GPUShaderFormat format,
+                             const char* entrypoint, const unsigned thread_count)
+    : device(device), directory(std::move(directory)), format(format),
+      extension(format == SDL_GPU_SHADERFORMAT_MSL ? ".msl" : ".spv"), entrypoint(entrypoint),
+      last_watch(std::chrono::steady_clock::now()) {
+    workers.reserve(std::max(thread_count, 1u));
+    for (unsigned i = 0; i < std::max(thread_count, 1u); ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& entry : entries) {
+        if (entry->pipeline != nullptr) {
+            SDL_ReleaseGPUGraphicsPipeline(device, entry->pipeline);
+        }
+        if (entry->pending != nullptr) {
+            SDL_ReleaseGPUGraphicsPipeline(device, entry->pending);
+        }
+    }
+}
+
+PipelineHandle PipelineCache::Request(const PipelineDesc& desc) {
+    std::lock_guard lock(mutex);
+    ++stats.requests;
+    const auto desc_hash = HashDesc(desc);
+    if (const auto found = by_desc.find(desc_hash); found != by_desc.end()) {
+        ++stats.hits;
+        return found->second;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->desc = desc;
+    entry->files = {directory / (desc.vertex.name + extension), directory / (desc.fragment.name + extension)};
+    const auto handle = static_cast<PipelineHandle>(entries.size());
+    entries.push_back(std::move(entry));
+    by_desc.emplace(desc_hash, handle);
+    Enqueue(handle);
+    return handle;
+}
+
+SDL_GPUGraphicsPipeline* PipelineCache::Get(const PipelineHandle handle) const {
+    std::lock_guard lock(mutex);
+    return entries[handle]->pipeline;
+}
+
+SDL_GPUGraphicsPipeline* PipelineCache::Wait(const PipelineHandle handle) {
+    std::unique_lock lock(mutex);
+    const auto& entry = *entries[handle];
+    finished.wait(lock, [&] { return entry.built; });
+    if (entry.pipeline == nullptr) {
+        throw std::runtime_error(entry.error);
+    }
+    return entry.pipeline;
+}
+
+void PipelineCache::Poll() {
+    std::lock_guard lock(mutex);
+    for (const auto& error : reload_errors) {
+        std::cerr << std::format("Shader reload failed, keeping the previous pipeline: {}\n", error);
+    }
+    reload_errors.clear();
+
+    for (const auto& entry : entries) {
+        if (entry->pending == nullptr) {
+            continue;
+        }
+        // SDL defers the release until command buffers already submitted with the old pipeline have finished
+        if (entry->pipeline != nullptr) {
+            SDL_ReleaseGPUGraphicsPipeline(device, entry->pipeline);
+        }
+        entry->pipeline = std::exchange(entry->pending, nullptr);
+        entry->content_hash = entry->pending_hash;
+        ++stats.reloads;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_watch < kWatchInterval) {
+        return;
+    }
+    last_watch = now;
+    for (PipelineHandle handle = 0; handle < entries.size(); ++handle) {
+        const auto& entry = *entries[handle];
+        if (!entry.built || entry.building) {
+            continue;
+        }
+        for (std::size_t i = 0; i < entry.files.size(); ++i) {
+            // a file being replaced can briefly be missing; it is picked up on a later poll
+            std::error_code error;
+            const auto write_time = std::filesystem::last_write_time(entry.files[i], error);
+            if (!error && write_time != entry.write_times[i]) {
+                Enqueue(handle);
+                break;
+            }
+        }
+    }
+}
+
+PipelineCacheStats PipelineCache::Stats() const {
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+void PipelineCache::Enqueue(const PipelineHandle handle) {
+    entries[handle]->building = true;
+    queue.push_back(handle);
+    wake.notify_one();
+}
+
+void PipelineCache::WorkerLoop() {
+    SetProfilerThreadName("pipeline build");
+    while (true) {
+        PipelineHandle handle = 0;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            handle = queue.front();
+            queue.pop_front();
+        }
+        Build(handle);
+    }
+}
+
+void PipelineCache::Build(const PipelineHandle handle) {
+    PROFILE_ZONE("BuildPipeline");
+    const auto start = std::chrono::steady_clock::now();
+
+    // entries are never removed and their desc and files never change, so those are read unlocked
+    Entry* entry = nullptr;
+    bool first_build = false;
+    std::uint64_t current_hash = 0;
+    {
+        std::lock_guard lock(mutex);
+        entry = entries[handle].get();
+        first_build = !entry->built;
+        current_hash = entry->content_hash;
+    }
+
+    // stamped before reading, so a write landing mid-build triggers another rebuild
+    std::array<std::filesystem::file_time_type, 2> write_times{};
+    std::array<ShaderFile, 2> files;
+    std::string error;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::error_code time_error;
+        write_times[i] = std::filesystem::last_write_time(entry->files[i], time_error);
+        files[i] = LoadShaderFile(entry->files[i]);
+        if (files[i].data == nullptr && error.empty()) {
+            error = std::format("{}: {}", entry->files[i].string(), SDL_GetError());
+        }
+    }
+
+    auto hash = HashDesc(entry->desc);
+    bool unchanged = false;
+    SDL_GPUGraphicsPipeline* pipeline = nullptr;
+    if (error.empty()) {
+        for (const auto& file : files) {
+            hash = HashBytes(hash, file.data.get(), file.size);
+        }
+        unchanged = !first_build && hash == current_hash;
+    }
+    if (error.empty() && !unchanged) {
+        auto* vertex_shader = CreateShader(device, entry->desc.vertex, files[0], format, entrypoint);
+        auto* fragment_shader = CreateShader(device, entry->desc.fragment, files[1], format, entrypoint);
+        if (vertex_shader != nullptr && fragment_shader != nullptr) {
+            pipeline = CreatePipeline(device, entry->desc, vertex_shader, fragment_shader);
+        }
+        if (pipeline == nullptr) {
+            error = std::format("{} + {}: {}", entry->desc.vertex.name, entry->desc.fragment.name, SDL_GetError());
+        }
+        if (vertex_shader != nullptr) {
+            SDL_ReleaseGPUShader(device, vertex_shader);
+        }
+        if (fragment_shader != nullptr) {
+            SDL_ReleaseGPUShader(device, fragment_shader);
+        }
+    }
+    const auto build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard lock(mutex);
+    entry->write_times = write_times;
+    entry->building = false;
+    stats.build_ms += build_ms;
+    if (unchanged) {
+        ++stats.hits;
+    }
+    else {
+        ++stats.misses;
+    }
+    if (pipeline != nullptr && first_build) {
+        entry->pipeline = pipeline;
+        entry->content_hash = hash;
+    }
+    else if (pipeline != nullptr) {
+        if (entry->pending != nullptr) {
+            SDL_ReleaseGPUGraphicsPipeline(device, entry->pending);
+        }
+        entry->pending = pipeline;
+        entry->pending_hash = hash;
+    }
+    else if (!error.empty()) {
+        ++stats.failures;
+        entry->error = error;
+        if (!first_build) {
+            reload_errors.push_back(error);
+        }
+    }
+    entry->built = true;
+    finished.notify_all();
+}
+
+void PrintPipelineCacheReport(const PipelineCacheStats& stats, const double startup_ms) {
+    std::cout << std::format("Pipeline cache: {} requests, {} hits, {} misses, {} failed, {} reloaded\n",
+                             stats.requests, stats.hits, stats.misses, stats.failures, stats.reloads);
+    std::cout << std::format("  {:.1f} ms building on background threads, startup {:.1f} ms\n", stats.build_ms,
+                             startup_ms);
+}
@@ -0,0 +1,208 @@
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+#include "FrustumCulling.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "ProceduralScenes.hpp"
+#include "SceneMath.hpp"
+#include "VertexNormals.hpp"
+#include "glm/ext/matrix_transform.hpp"
+
+namespace {
+    // Copies of `mesh` spaced `spacing` apart on a square grid around the origin.
+    Scene CreateFieldScene(RenderableObject mesh, const std::uint32_t count, const float spacing) {
+        OptimizeMesh(mesh);
+        BuildLodChain(mesh);
+
+        const auto side = static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        const auto half = static_cast<float>(side - 1) * spacing * 0.5f;
+        Scene scene{};
+        scene.Objects.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            auto& obj = scene.Objects.emplace_back(mesh);
+            obj.transform = AddTransform(scene.Transforms);
+            const auto x = static_cast<float>(i % side) * spacing - half;
+            const auto z = static_cast<float>(i / side) * spacing - half;
+            SetTranslation(scene.Transforms, obj.transform, glm::vec3{x, 0.0f, z});
+        }
+        UpdateTransforms(scene.Transforms, GetThreadPool());
+        ApplyWorldTransforms(scene.Transforms, scene.Objects);
+
+        // far enough back that the near half of the field is in view and the far half is culled or coarse
+        scene.Camera = CreateCamera();
+        scene.Camera.camera_coords = glm::vec3{0.0f, half * 0.5f + 4.0f, half + 4.0f};
+        scene.Camera.view = LookAt(scene.Camera, scene.Camera.target_coords);
+        return scene;
+    }
+}
+
+RenderableObject CreateCube() {
+    RenderableObject cube{};
+    cube.vertices.reserve(8);
+    cube.vertices.push_back(PositionAndColorVertex{{-1.0f, -1.0f, -1.0f}, {255, 255, 255, 255}}); // 0
+    cube.vertices.push_back(PositionAndColorVertex{{-1.0f, -1.0f, 1.0f}, {255, 255, 255, 255}}); // 1
+    cube.vertices.push_back(PositionAndColorVertex{{-1.0f, 1.0f, -1.0f}, {255, 255, 255, 255}}); // 2
+    cube.vertices.push_back(PositionAndColorVertex{{-1.0f, 1.0f, 1.0f}, {255, 255, 255, 255}}); // 3
+    cube.vertices.push_back(PositionAndColorVertex{{1.0f, -1.0f, -1.0f}, {255, 255, 255, 255}}); // 4
+    cube.vertices.push_back(PositionAndColorVertex{{1.0f, -1.0f, 1.0f}, {255, 255, 255, 255}}); // 5
+    cube.vertices.push_back(PositionAndColorVertex{{1.0f, 1.0f, -1.0f}, {255, 255, 255, 255}}); // 6
+    cube.vertices.push_back(PositionAndColorVertex{{1.0f, 1.0f, 1.0f}, {255, 255, 255, 255}}); // 7
+
+    cube.indices.reserve(12);
+    cube.indices.emplace_back(0, 2, 3);
+    cube.indices.emplace_back(3, 1, 0);
+    cube.indices.emplace_back(3, 2, 6);
+    cube.indices.emplace_back(6, 7, 3);
+    cube.indices.emplace_back(1, 3, 7);
+    cube.indices.emplace_back(7, 5, 1);
+    cube.indices.emplace_back(1, 5, 4);
+    cube.indices.emplace_back(4, 0, 1);
+    cube.indices.emplace_back(7, 6, 4);
+    cube.indices.emplace_back(4, 5, 7);
+    cube.indices.emplace_back(0, 4, 6);
+    cube.indices.emplace_back(6, 2, 0);
+
+    CalculateVertexNormals(cube);
+    UpdateLocalBounds(cube);
+
+    cube.model = glm::identity<glm::mat4>();
+    return cube;
+}
+
+RenderableObject CreateFlatPlane() {
+    return CreateSubdividedPlane(7);
+}
+
+RenderableObject CreateSubdividedPlane(const std::uint32_t cells) {
+    RenderableObject floor{};
+    const auto side = cells + 1;
+    const auto half = static_cast<float>(cells) * 0.5f;
+    const auto step = 14.0f / static_cast<float>(cells);
+    floor.vertices.reserve(std::size_t{side} * side);
+    for (std::uint32_t i = 0; i < side; i++) {
+        for (std::uint32_t j = 0; j < side; j++) {
+            float x = (static_cast<float>(i) - half) * step;
+            float z = (static_cast<float>(j) - half) * step;
+            float y = -1.0f;
+            floor.vertices.push_back(PositionAndColorVertex{{x, y, z}, {255, 255, 255, 255}});
+        }
+    }
+    floor.indices.reserve(std::size_t{cells} * cells * 2);
+    for (std::uint32_t i = 0; i < cells; i++) {
+        for (std::uint32_t j = 0; j < cells; j++) {
+            const auto target = side * i + j;
+            floor.indices.emplace_back(target, target + 1, target + side);
+            floor.indices.emplace_back(target + 1, target + side, target + side + 1);
+        }
+    }
+
+    floor.model = glm::identity<glm::mat4>(); // no transform
+
+    CalculateVertexNormals(floor);
+    UpdateLocalBounds(floor);
+    return floor;
+}
+
+RenderableObject CreateGridMesh(const std::uint32_t cells) {
+    RenderableObject grid{};
+    const auto side = cells + 1;
+    grid.vertices.reserve(side * side);
+    grid.normals.reserve(side * side);
+    for (std::uint32_t i = 0; i < side; ++i) {
+        for (std::uint32_t j = 0; j < side; ++j) {
+            const auto x = static_cast<float>(i) - static_cast<float>(cells) * 0.5f;
+            const auto z = static_cast<float>(j) - static_cast<float>(cells) * 0.5f;
+            grid.vertices.push_back(PositionAndColorVertex{{x, 0.0f, z}, {255, 255, 255, 255}});
+            grid.normals.emplace_back(0.0f, 1.0f, 0.0f);
+        }
+    }
+    grid.indices.reserve(std::size_t{cells} * cells * 2);
+    for (std::uint32_t i = 0; i < cells; ++i) {
+        for (std::uint32_t j = 0; j < cells; ++j) {
+            const auto target = i * side + j;
+            grid.indices.emplace_back(target, target + 1, target + side);
+            grid.indices.emplace_back(target + 1, target + side + 1, target + side);
+        }
+    }
+
+    grid.model = glm::identity<glm::mat4>();
+    UpdateLocalBounds(grid);
+    return grid;
+}
+
+CameraObject CreateCamera() {
+    CameraObject cam{};
+
+    cam.camera_coords = {0.0f, 0.0f, 4.0f};
+    cam.target_coords = {0.0f, 0.0f, 0.0f};
+
+    cam.proj = Project(cam, glm::pi<float>() / 6, 1.0, 1.0, 0.0);
+    cam.view = LookAt(cam, cam.target_coords);
+
+    return cam;
+}
+
+Scene CreateCubeFieldScene(const std::uint32_t count) {
+    return CreateFieldScene(CreateCube(), count, 4.0f);
+}
+
+Scene CreatePlaneFieldScene(const std::uint32_t count, const std::uint32_t cells) {
+    return CreateFieldScene(CreateSubdividedPlane(cells), count, 16.0f);
+}
+
+Scene CreateInteriorScene(const std::uint32_t rooms) {
+    constexpr float kRoomWidth = 12.0f;
+    constexpr float kRoomDepth = 10.0f;
+    constexpr float kRoomHeight = 4.0f;
+    constexpr float kWallThickness = 0.25f;
+    constexpr float kDoorWidth = 2.0f;
+    constexpr std::uint32_t kCubesPerSide = 5;
+    constexpr float kCubeHalfSize = 0.4f;
+
+    auto cube = CreateCube();
+    OptimizeMesh(cube);
+    BuildLodChain(cube);
+
+    Scene scene{};
+    scene.Objects.reserve(std::size_t{rooms} * (kCubesPerSide * kCubesPerSide + 2));
+    // the cube spans [-1, 1] on every axis, so its scale is the half size
+    const auto add_box = [&](const glm::vec3 center, const glm::vec3 half_size) {
+        auto& obj = scene.Objects.emplace_back(cube);
+        obj.transform = AddTransform(scene.Transforms);
+        SetTranslation(scene.Transforms, obj.transform, center);
+        SetScale(scene.Transforms, obj.transform, half_size);
+    };
+
+    const auto floor_y = -1.0f;
+    for (std::uint32_t room = 0; room < rooms; ++room) {
+        const auto front_z = -static_cast<float>(room) * kRoomDepth;
+        for (std::uint32_t i = 0; i < kCubesPerSide * kCubesPerSide; ++i) {
+            const auto x = (static_cast<float>(i % kCubesPerSide) + 0.5f) / kCubesPerSide - 0.5f;
+            const auto z = (static_cast<float>(i / kCubesPerSide) + 0.5f) / kCubesPerSide;
+            add_box(glm::vec3{x * (kRoomWidth - 2.0f), floor_y + kCubeHalfSize, front_z - z * (kRoomDepth - 2.0f)},
+                    glm::vec3{kCubeHalfSize});
+        }
+
+        // the back wall, in two pieces either side of the doorway
+        const auto door_x = (room % 2 == 0 ? 0.25f : -0.25f) * kRoomWidth;
+        const auto wall_z = front_z - kRoomDepth;
+        const auto wall_y = floor_y + kRoomHeight * 0.5f;
+        const auto left = -kRoomWidth * 0.5f;
+        const auto right = kRoomWidth * 0.5f;
+        const auto door_left = door_x - kDoorWidth * 0.5f;
+        const auto door_right = door_x + kDoorWidth * 0.5f;
+        add_box(glm::vec3{(left + door_left) * 0.5f, wall_y, wall_z},
+                glm::vec3{(door_left - left) * 0.5f, kRoomHeight * 0.5f, kWallThickness * 0.5f});
+        add_box(glm::vec3{(door_right + right) * 0.5f, wall_y, wall_z},
+                glm::vec3{(right - door_right) * 0.5f, kRoomHeight * 0.5f, kWallThickness * 0.5f});
+    }
+    UpdateTransforms(scene.Transforms, GetThreadPool());
+    ApplyWorldTransforms(scene.Transforms, scene.Objects);
+
+    scene.Camera = CreateCamera();
+    scene.Camera.camera_coords = glm::vec3{0.0f, floor_y + 1.6f, 1.0f};
+    scene.Camera.target_coords = glm::vec3{0.0f, floor_y + 1.0f, -static_cast<float>(rooms) * kRoomDepth};
+    scene.Camera.view = LookAt(scene.Camera, scene.Camera.target_coords);
+    return scene;
+}
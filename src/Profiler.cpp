@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Profiler.hpp"
+
+#ifdef TBDGAME_PROFILER
+namespace profiler_detail {
+    std::atomic<bool> capturing{false};
+}
+
+namespace {
+    constexpr std::uint32_t kEventsPerThread = 1u << 16;
+
+    enum class EventKind : std::uint8_t {
+        Zone,
+        Counter,
+    };
+    struct ProfileEvent {
+        const char* name;
+        std::uint64_t start_ns;
+        std::uint64_t end_ns; // zones only
+        double value;         // counters only
+        EventKind kind;
+    };
+
+    // Written only by its own thread. The capture reads events [0, count) of buffers stamped with its generation.
+    struct ThreadBuffer {
+        std::unique_ptr<ProfileEvent[]> events = std::make_unique<ProfileEvent[]>(kEventsPerThread);
+        std::atomic<std::uint32_t> count{0};
+        std::atomic<std::uint32_t> dropped{0};
+        std::atomic<std::uint64_t> generation{0};
+        std::atomic<const char*> name{nullptr};
+        std::uint32_t index = 0;
+    };
+
+    std::atomic<std::uint64_t> capture_generation{0};
+    std::uint64_t capture_start_ns = 0;
+
+    // buffers outlive their threads, so a capture can still read what a finished thread recorded
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    thread_local ThreadBuffer* local_buffer = nullptr;
+
+    ThreadBuffer& LocalBuffer() {
+        if (local_buffer == nullptr) {
+            std::lock_guard lock(registry_mutex);
+            registry.push_back(std::make_unique<ThreadBuffer>());
+            registry.back()->index = static_cast<std::uint32_t>(registry.size() - 1);
+            local_buffer = registry.back().get();
+        }
+        return *local_buffer;
+    }
+
+    void Append(const ProfileEvent& event) {
+        auto& buffer = LocalBuffer();
+        const auto generation = capture_generation.load(std::memory_order_acquire);
+        if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+            buffer.count.store(0, std::memory_order_relaxed);
+            buffer.dropped.store(0, std::memory_order_relaxed);
+            buffer.generation.store(generation, std::memory_order_release);
+        }
+        const auto index = buffer.count.load(std::memory_order_relaxed);
+        if (index >= kEventsPerThread) {
+            buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        buffer.events[index] = event;
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    // trace timestamps are microseconds; keep the nanoseconds as decimals
+    std::string Microseconds(const std::uint64_t ns) {
+        return std::format("{}.{:03}", ns / 1000, ns % 1000);
+    }
+
+    std::string Escaped(const char* text) {
+        std::string escaped;
+        for (; *text != '\0'; ++text) {
+            if (*text == '"' || *text == '\\') {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(*text);
+        }
+        return escaped;
+    }
+}
+
+void profiler_detail::RecordZone(const char* name, const std::uint64_t start_ns, const std::uint64_t end_ns) {
+    Append(ProfileEvent{name, start_ns, end_ns, 0.0, EventKind::Zone});
+}
+
+void profiler_detail::RecordCounter(const char* name, const double value) {
+    Append(ProfileEvent{name, Now(), 0, value, EventKind::Counter});
+}
+
+bool ProfilerCapturing() {
+    return profiler_detail::capturing.load(std::memory_order_relaxed);
+}
+
+void BeginProfilerCapture() {
+    capture_generation.fetch_add(1, std::memory_order_acq_rel);
+    capture_start_ns = profiler_detail::Now();
+    profiler_detail::capturing.store(true, std::memory_order_release);
+}
+
+ProfilerCaptureStats EndProfilerCapture(const std::filesystem::path& path) {
+    profiler_detail::capturing.store(false, std::memory_order_release);
+    const auto generation = capture_generation.load(std::memory_order_acquire);
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("{}: could not open for writing", path.string()));
+    }
+
+    ProfilerCaptureStats stats{};
+    const char* separator = "\n";
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    std::lock_guard lock(registry_mutex);
+    for (const auto& buffer : registry) {
+        if (buffer->generation.load(std::memory_order_acquire) != generation) {
+            continue;
+        }
+        // a thread still finishing a zone from before the stop may append past this; those events are left out
+        const auto count = buffer->count.load(std::memory_order_acquire);
+        const auto tid = buffer->index;
+        const auto* name = buffer->name.load(std::memory_order_relaxed);
+        const auto thread_name = name != nullptr ? Escaped(name) : std::format("thread {}", tid);
+        // every event carries the same process and thread ids
+        const auto emit = [&](const std::string& fields) {
+            file << separator << std::format("{{\"pid\":1,\"tid\":{},{}}}", tid, fields);
+            separator = ",\n";
+        };
+        emit(std::format("\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{{\"name\":\"{}\"}}", thread_name));
+
+        for (std::uint32_t i = 0; i < count; ++i) {
+            const auto& event = buffer->events[i];
+            // zones opened before the capture started are clipped to it
+            const auto start = std::max(event.start_ns, capture_start_ns) - capture_start_ns;
+            if (event.kind == EventKind::Zone) {
+                const auto end = std::max(event.end_ns, capture_start_ns) - capture_start_ns;
+                emit(std::format("\"ph\":\"X\",\"name\":\"{}\",\"ts\":{},\"dur\":{}", Escaped(event.name),
+                                 Microseconds(start), Microseconds(end - start)));
+            }
+            else {
+                emit(std::format("\"ph\":\"C\",\"name\":\"{}\",\"ts\":{},\"args\":{{\"value\":{}}}",
+                                 Escaped(event.name), Microseconds(start), event.value));
+            }
+        }
+        stats.events += count;
+        stats.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        ++stats.threads;
+    }
+    file << "\n]}\n";
+    if (!file) {
+        throw std::runtime_error(std::format("{}: write failed", path.string()));
+    }
+    return stats;
+}
+
+void SetProfilerThreadName(const char* name) {
+    LocalBuffer().name.store(name, std::memory_order_relaxed);
+}
+#else
+bool ProfilerCapturing() {
+    return false;
+}
+
+void BeginProfilerCapture() {}
+
+ProfilerCaptureStats EndProfilerCapture(const std::filesystem::path&) {
+    return {};
+}
+
+void SetProfilerThreadName(const char*) {}
+#endif
+
+void PrintProfilerCaptureReport(const std::filesystem::path& path, const ProfilerCaptureStats& stats) {
+    if (!ProfilerBuiltIn()) {
+        std::cout << "Profiler capture skipped: this build has no profiler (TBDGAME_PROFILER is off in Release)\n";
+        return;
+    }
+    std::cout << std::format("Profiler capture: {} events from {} threads written to {}", stats.events, stats.threads,
+                             path.string());
+    if (stats.dropped > 0) {
+        std::cout << std::format(" ({} dropped: thread buffers full)", stats.dropped);
+    }
+    std::cout << "\n";
+}
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include "Profiler.hpp"
+#include "RenderGraph.hpp"
+
+namespace {
+    bool Contains(const std::span<const std::uint32_t> values, const std::uint32_t value) {
+        return std::ranges::find(values, value) != values.end();
+    }
+
+    bool FollowsBackbuffer(const RenderTextureDesc& desc) {
+        return desc.width == 0 || desc.height == 0;
+    }
+
+    std::uint32_t ScaledSize(const std::uint32_t size, const float scale) {
+        return std::max(1u, static_cast<std::uint32_t>(std::lround(static_cast<float>(size) * scale)));
+    }
+
+    std::uint32_t ResolvedWidth(const RenderGraph& graph, const RenderTextureDesc& desc) {
+        return FollowsBackbuffer(desc) ? ScaledSize(graph.backbuffer_width, desc.scale) : desc.width;
+    }
+
+    std::uint32_t ResolvedHeight(const RenderGraph& graph, const RenderTextureDesc& desc) {
+        return FollowsBackbuffer(desc) ? ScaledSize(graph.backbuffer_height, desc.scale) : desc.height;
+    }
+
+    std::uint64_t TextureBytes(const SDL_GPUTextureFormat format, const std::uint32_t width,
+                               const std::uint32_t height) {
+        return SDL_CalculateGPUTextureFormatSize(format, width, height, 1);
+    }
+
+    void ReleasePooledTextures(RenderGraph& graph, const auto& release) {
+        std::erase_if(graph.pool, [&](const PooledRenderTexture& pooled) {
+            if (!release(pooled)) {
+                return false;
+            }
+            SDL_ReleaseGPUTexture(graph.device, pooled.texture);
+            return true;
+        });
+    }
+
+    // Keeps every pass that writes an imported texture or has side effects, then every pass writing something a kept
+    // pass reads.
+    std::pmr::vector<bool> FindNeededPasses(const RenderGraph& graph) {
+        std::pmr::vector<bool> needed(graph.passes.size(), false, graph.frame_memory);
+        std::pmr::vector<std::uint32_t> pending(graph.frame_memory);
+        for (std::uint32_t i = 0; i < graph.passes.size(); ++i) {
+            const auto& pass = graph.passes[i];
+            const auto writes_import = std::ranges::any_of(
+                pass.writes, [&](const RenderResource r) { return graph.resources[r].imported != nullptr; });
+            if (pass.side_effects || writes_import) {
+                needed[i] = true;
+                pending.push_back(i);
+            }
+        }
+        while (!pending.empty()) {
+            const auto reader = pending.back();
+            pending.pop_back();
+            for (const auto resource : graph.passes[reader].reads) {
+                for (std::uint32_t writer = 0; writer < graph.passes.size(); ++writer) {
+                    if (!needed[writer] && Contains(graph.passes[writer].writes, resource)) {
+                        needed[writer] = true;
+                        pending.push_back(writer);
+                    }
+                }
+            }
+        }
+        return needed;
+    }
+
+    // Kahn's algorithm over the needed passes. A texture's writers run in the order they were added, and all of them
+    // before any pass that only reads it; among passes that are ready, the one added first goes first.
+    void OrderPasses(RenderGraph& graph, const std::pmr::vector<bool>& needed) {
+        const auto count = graph.passes.size();
+        std::pmr::vector<std::pmr::vector<std::uint32_t>> successors(count, graph.frame_memory);
+        std::pmr::vector<std::uint32_t> incoming(count, 0, graph.frame_memory);
+        const auto add_edge = [&](const std::uint32_t from, const std::uint32_t to) {
+            if (from != to && !Contains(successors[from], to)) {
+                successors[from].push_back(to);
+                ++incoming[to];
+            }
+        };
+
+        for (RenderResource resource = 0; resource < graph.resources.size(); ++resource) {
+            std::pmr::vector<std::uint32_t> writers(graph.frame_memory);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                if (needed[i] && Contains(graph.passes[i].writes, resource)) {
+                    if (!writers.empty()) {
+                        add_edge(writers.back(), i);
+                    }
+                    writers.push_back(i);
+                }
+            }
+            for (std::uint32_t i = 0; i < count; ++i) {
+                if (needed[i] && Contains(graph.passes[i].reads, resource) && !Contains(writers, i)) {
+                    for (const auto writer : writers) {
+                        add_edge(writer, i);
+                    }
+                }
+            }
+        }
+
+        auto& order = graph.order;
+        order.clear();
+        std::pmr::vector<bool> done(count, false, graph.frame_memory);
+        while (true) {
+            auto next = count;
+            for (std::uint32_t i = 0; i < count; ++i) {
+                if (needed[i] && !done[i] && incoming[i] == 0) {
+                    next = i;
+                    break;
+                }
+            }
+            if (next == count) {
+                break;
+            }
+            done[next] = true;
+            order.push_back(static_cast<std::uint32_t>(next));
+            for (const auto successor : successors[next]) {
+                --incoming[successor];
+            }
+        }
+        if (order.size() != static_cast<std::size_t>(std::ranges::count(needed, true))) {
+            throw std::logic_error("render graph: passes read and write each other's textures in a cycle");
+        }
+    }
+
+    // Gives each used transient texture, in order of first use, a pooled texture of the same shape whose current
+    // user's lifetime has ended, or a new one.
+    void AssignPooledTextures(RenderGraph& graph) {
+        std::pmr::vector<RenderResource> transients(graph.frame_memory);
+        for (RenderResource r = 0; r < graph.resources.size(); ++r) {
+            if (graph.resources[r].used && graph.resources[r].imported == nullptr) {
+                transients.push_back(r);
+            }
+        }
+        // creation order breaks ties, as a stable sort would without its temporary buffer
+        std::ranges::sort(transients, {},
+                          [&](const RenderResource r) { return std::pair{graph.resources[r].first_use, r}; });
+
+        auto& stats = graph.stats;
+        stats.transient_textures = static_cast<std::uint32_t>(transients.size());
+        for (const auto r : transients) {
+            auto& resource = graph.resources[r];
+            const auto width = ResolvedWidth(graph, resource.desc);
+            const auto height = ResolvedHeight(graph, resource.desc);
+            const auto fits = [&](const PooledRenderTexture& pooled) {
+                const auto free = pooled.last_frame != graph.frame || pooled.busy_until < resource.first_use;
+                return free && pooled.format == resource.desc.format && pooled.usage == resource.desc.usage &&
+                       pooled.width == width && pooled.height == height;
+            };
+
+            auto found = std::ranges::find_if(graph.pool, fits);
+            if (found == graph.pool.end()) {
+                const auto info = SDL_GPUTextureCreateInfo{
+                    .type = SDL_GPU_TEXTURETYPE_2D,
+                    .format = resource.desc.format,
+                    .usage = resource.desc.usage,
+                    .width = width,
+                    .height = height,
+                    .layer_count_or_depth = 1,
+                    .num_levels = 1,
+                    .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                };
+                auto texture = SDL_CreateGPUTexture(graph.device, &info);
+                if (texture == nullptr) {
+                    throw std::runtime_error(std::format("render graph texture {}: {}", resource.name, SDL_GetError()));
+                }
+                graph.pool.push_back(PooledRenderTexture{
+                    .format = resource.desc.format,
+                    .usage = resource.desc.usage,
+                    .width = width,
+                    .height = height,
+                    .follows_backbuffer = FollowsBackbuffer(resource.desc),
+                    .texture = texture,
+                    .bytes = TextureBytes(resource.desc.format, width, height),
+                    .last_frame = 0,
+                });
+                ++stats.textures_created;
+                found = graph.pool.end() - 1;
+            }
+
+            if (found->last_frame != graph.frame) {
+                found->last_frame = graph.frame;
+                ++stats.pooled_textures;
+                stats.transient_bytes += found->bytes;
+            }
+            found->busy_until = resource.last_use;
+            resource.physical = static_cast<std::uint32_t>(found - graph.pool.begin());
+            stats.unaliased_bytes += found->bytes;
+        }
+    }
+}
+
+RenderGraph CreateRenderGraph(SDL_GPUDevice* device, const std::uint32_t width, const std::uint32_t height) {
+    return RenderGraph{.device = device, .backbuffer_width = width, .backbuffer_height = height};
+}
+
+void DestroyRenderGraph(RenderGraph& graph) {
+    graph.passes.clear();
+    graph.resources.clear();
+    graph.order.clear();
+    ReleasePooledTextures(graph, [](const PooledRenderTexture&) { return true; });
+}
+
+bool SetRenderGraphBackbufferSize(RenderGraph& graph, const std::uint32_t width, const std::uint32_t height) {
+    if (width == graph.backbuffer_width && height == graph.backbuffer_height) {
+        return false;
+    }
+    graph.backbuffer_width = width;
+    graph.backbuffer_height = height;
+    ReleasePooledTextures(graph, [](const PooledRenderTexture& pooled) { return pooled.follows_backbuffer; });
+    ++graph.stats.resizes;
+    return true;
+}
+
+void ResetRenderGraph(RenderGraph& graph, std::pmr::memory_resource& frame_memory) {
+    graph.frame_memory = &frame_memory;
+    graph.passes.clear();
+    graph.resources.clear();
+    graph.order.clear();
+}
+
+RenderResource ImportRenderTexture(RenderGraph& graph, const char* name, SDL_GPUTexture* texture,
+                                   const RenderTextureDesc& desc) {
+    if (texture == nullptr) {
+        throw std::invalid_argument(std::format("render graph: imported texture {} is null", name));
+    }
+    graph.resources.push_back(RenderResourceNode{.name = name, .desc = desc, .imported = texture});
+    return static_cast<RenderResource>(graph.resources.size() - 1);
+}
+
+RenderResource CreateRenderTexture(RenderGraph& graph, const char* name, const RenderTextureDesc& desc) {
+    graph.resources.push_back(RenderResourceNode{.name = name, .desc = desc});
+    return static_cast<RenderResource>(graph.resources.size() - 1);
+}
+
+void AddRenderPassNode(RenderGraph& graph, const char* name, const std::span<const RenderResource> reads,
+                       const std::span<const RenderResource> writes, const RenderPassExecute execute,
+                       const bool side_effects) {
+    if (graph.frame_memory == nullptr) {
+        throw std::logic_error(std::format("render graph: pass {} added before ResetRenderGraph()", name));
+    }
+    const auto copy = [&](const std::span<const RenderResource> resources) {
+        auto* stored = std::pmr::polymorphic_allocator<RenderResource>(graph.frame_memory).allocate(resources.size());
+        std::ranges::copy(resources, stored);
+        return std::span<const RenderResource>(stored, resources.size());
+    };
+    graph.passes.push_back(RenderPassNode{.name = name,
+                                          .reads = copy(reads),
+                                          .writes = copy(writes),
+                                          .side_effects = side_effects,
+                                          .execute = execute});
+}
+
+void CompileRenderGraph(RenderGraph& graph) {
+    PROFILE_ZONE("CompileRenderGraph");
+    ++graph.frame;
+    ReleasePooledTextures(graph, [&](const PooledRenderTexture& pooled) {
+        return graph.frame - pooled.last_frame > kRenderGraphIdleFrames;
+    });
+
+    const auto needed = FindNeededPasses(graph);
+    OrderPasses(graph, needed);
+    for (std::uint32_t position = 0; position < graph.order.size(); ++position) {
+        const auto use = [&](const RenderResource r) {
+            auto& resource = graph.resources[r];
+            resource.first_use = resource.used ? std::min(resource.first_use, position) : position;
+            resource.last_use = resource.used ? std::max(resource.last_use, position) : position;
+            resource.used = true;
+        };
+        const auto& pass = graph.passes[graph.order[position]];
+        std::ranges::for_each(pass.reads, use);
+        std::ranges::for_each(pass.writes, use);
+    }
+
+    const auto pass_count = static_cast<std::uint32_t>(graph.passes.size());
+    graph.stats = RenderGraphStats{.passes = pass_count,
+                                   .culled_passes = pass_count - static_cast<std::uint32_t>(graph.order.size()),
+                                   .textures_created = graph.stats.textures_created,
+                                   .resizes = graph.stats.resizes};
+    AssignPooledTextures(graph);
+}
+
+void ExecuteRenderGraph(const RenderGraph& graph, SDL_GPUCommandBuffer* cmdbuf) {
+    for (const auto i : graph.order) {
+        const auto& pass = graph.passes[i];
+        PROFILE_ZONE(pass.name);
+        pass.execute.invoke(pass.execute.callable, cmdbuf, graph);
+    }
+}
+
+SDL_GPUTexture* GetRenderGraphTexture(const RenderGraph& graph, const RenderResource resource) {
+    const auto& node = graph.resources[resource];
+    if (node.imported != nullptr) {
+        return node.imported;
+    }
+    return node.used ? graph.pool[node.physical].texture : nullptr;
+}
+
+std::uint32_t RenderTextureWidth(const RenderGraph& graph, const RenderResource resource) {
+    return ResolvedWidth(graph, graph.resources[resource].desc);
+}
+
+std::uint32_t RenderTextureHeight(const RenderGraph& graph, const RenderResource resource) {
+    return ResolvedHeight(graph, graph.resources[resource].desc);
+}
+
+void PrintRenderGraphReport(const RenderGraph& graph) {
+    const auto& stats = graph.stats;
+    const auto mb = [](const std::uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    std::cout << std::format("Render graph at {}x{}:\n", graph.backbuffer_width, graph.backbuffer_height);
+    std::cout << std::format("  passes {} ({} culled)  transient textures {} in {} pooled  {:.2f} MB "
+                             "({:.2f} MB without aliasing)  textures created {}  resizes {}\n",
+                             stats.passes, stats.culled_passes, stats.transient_textures, stats.pooled_textures,
+                             mb(stats.transient_bytes), mb(stats.unaliased_bytes), stats.textures_created,
+                             stats.resizes);
+}
@@ -0,0 +1,121 @@
+#include <cassert>
+#include <glm/gtc/quaternion.hpp>
+
+#include "SceneMath.hpp"
+
+void TranslateModel(TransformHierarchy& transforms, const TransformHandle node, const glm::vec3 tr) {
+    // model * translation: the offset is in the object's own rotated, scaled frame
+    const auto scaled = GetRotation(transforms, node) * (GetScale(transforms, node) * tr);
+    SetTranslation(transforms, node, GetTranslation(transforms, node) + scaled);
+}
+
+void RotateModelInPlace(TransformHierarchy& transforms, const TransformHandle node, const float angle,
+                        const glm::vec3 axis) {
+    const bool is_zero_vector = axis.x == 0.0f && axis.y == 0.0f && axis.z == 0.0f;
+    assert(!is_zero_vector);
+    // model * rotation; exact while the scale is uniform, which keeps the model a TRS
+    const auto rotation = glm::angleAxis(-angle, glm::normalize(axis));
+    SetRotation(transforms, node, glm::normalize(GetRotation(transforms, node) * rotation));
+}
+
+void RotateModelAboutOrigin(TransformHierarchy& transforms, const TransformHandle node, const float angle,
+                            const glm::vec3 axis) {
+    const bool is_zero_vector = axis.x == 0.0f && axis.y == 0.0f && axis.z == 0.0f;
+    assert(!is_zero_vector);
+    const auto rotation = glm::angleAxis(-angle, glm::normalize(axis));
+    SetTranslation(transforms, node, rotation * GetTranslation(transforms, node));
+    SetRotation(transforms, node, glm::normalize(rotation * GetRotation(transforms, node)));
+}
+
+void ScaleModel(TransformHierarchy& transforms, const TransformHandle node, const glm::vec3 scalars) {
+    SetScale(transforms, node, GetScale(transforms, node) * scalars);
+}
+
+void ResetModel(TransformHierarchy& transforms, const TransformHandle node) {
+    SetTranslation(transforms, node, glm::vec3{0.0f});
+    SetRotation(transforms, node, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+    SetScale(transforms, node, glm::vec3{1.0f});
+}
+
+void ApplyWorldTransforms(const TransformHierarchy& transforms, std::vector<RenderableObject>& objects) {
+    for (auto& obj : objects) {
+        if (obj.transform != kNoTransform && transforms.world_changed[obj.transform] != 0) {
+            obj.model = transforms.world[obj.transform];
+        }
+    }
+}
+
+glm::vec3& DollyCamera(CameraObject& cam, const float distance) {
+    const auto translation =
+        glm::normalize(cam.target_coords - cam.camera_coords); // gives vec from camera_coords to target_coords
+    cam.camera_coords += (distance * translation);
+    return cam.camera_coords;
+}
+
+glm::vec3& RaiseOrLowerCamera(CameraObject& cam, const float distance) {
+    cam.camera_coords.y += distance;
+    return cam.camera_coords;
+}
+
+glm::vec3& OrbitCameraLaterally(CameraObject& cam, const float angle) {
+    const auto forward =
+        glm::normalize(cam.camera_coords - cam.target_coords); // treats the "center" point as the origin.
+    const auto right = glm::cross(glm::vec3{0.0f, 1.0f, 0.0f}, forward);
+    const auto axis = glm::cross(forward, right);
+
+    const bool is_zero_vector = axis.x == 0.0f && axis.y == 0.0f && axis.z == 0.0f;
+    assert(!is_zero_vector);
+    cam.camera_coords = glm::angleAxis(-angle, glm::normalize(axis)) * cam.camera_coords;
+    return cam.camera_coords;
+}
+
+glm::mat4& LookAt(CameraObject& cam, const glm::vec3 center) {
+    const auto forward = glm::normalize(cam.camera_coords - center); // treats the "center" point as the origin.
+    const auto right = glm::normalize(glm::cross(glm::vec3{0.0f, 1.0f, 0.0f}, forward));
+    const auto up = glm::normalize(glm::cross(forward, right));
+    cam.view = glm::mat4{right.x,
+                         right.y,
+                         right.z,
+                         0.0f,
+                         up.x,
+                         up.y,
+                         up.z,
+                         0.0f,
+                         forward.x,
+                         forward.y,
+                         forward.z,
+                         0.0f,
+                         glm::dot(cam.camera_coords, right),
+                         glm::dot(cam.camera_coords, up),
+                         -glm::dot(cam.camera_coords, forward),
+                         1.0f};
+    return cam.view;
+}
+
+glm::mat4& Project(CameraObject& cam, const float vFov, const float aspectRatio, const float near, const float far) {
+    const auto focal_length = (glm::tan(1 / (vFov / 2)));
+    const auto top = focal_length * near;
+    const auto bottom = -top;
+    const auto right = top * aspectRatio;
+    const auto left = bottom * aspectRatio;
+    const auto base_projection_matrix = glm::mat4{
+        (2 * near) / (right - left),
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        (2 * near) / (top - bottom),
+        0.0f,
+        0.0f,
+        (right + left) / (right - left),
+        (top + bottom) / (top - bottom),
+        -(far + near) / (far - near),
+        -1.0f,
+        0.0f,
+        0.0f,
+        -(2 * far * near) / (far - near),
+        0.0f,
+    };
+    cam.proj = base_projection_matrix;
+    return cam.proj;
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "Hashing.hpp"
+#include "Profiler.hpp"
+#include "Simulation.hpp"
+
+namespace {
+    // after a stall (a debugger break, a slow step) the simulation skips ahead instead of running this many steps
+    // back to back to catch up
+    constexpr int kMaxCatchUpSteps = 8;
+    constexpr std::size_t kNodesPerJob = 2048;
+}
+
+void CaptureSnapshot(SceneSnapshot& snapshot, const CameraObject& camera, const TransformHierarchy& transforms,
+                     ThreadPool& pool) {
+    const auto count = transforms.parent.size();
+    snapshot.camera = camera;
+    snapshot.translation.resize(count);
+    snapshot.rotation.resize(count);
+    snapshot.scale.resize(count);
+    pool.ParallelFor(count, kNodesPerJob, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i) {
+            const auto node = static_cast<TransformHandle>(i);
+            snapshot.translation[i] = GetTranslation(transforms, node);
+            snapshot.rotation[i] = GetRotation(transforms, node);
+            snapshot.scale[i] = GetScale(transforms, node);
+        }
+    });
+}
+
+void InterpolateSnapshots(const SceneSnapshot& previous, const SceneSnapshot& current, const float alpha,
+                          CameraObject& camera, TransformHierarchy& transforms, ThreadPool& pool) {
+    const auto count = std::min({previous.translation.size(), current.translation.size(), transforms.parent.size()});
+    // each node only writes its own TRS and dirty flag
+    pool.ParallelFor(count, kNodesPerJob, [&](const std::size_t begin, const std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i) {
+            const auto node = static_cast<TransformHandle>(i);
+            // unchanged components are copied rather than blended, so resting nodes stay clean
+            const auto translation = previous.translation[i] == current.translation[i]
+                                         ? current.translation[i]
+                                         : glm::mix(previous.translation[i], current.translation[i], alpha);
+            const auto rotation = previous.rotation[i] == current.rotation[i]
+                                      ? current.rotation[i]
+                                      : glm::slerp(previous.rotation[i], current.rotation[i], alpha);
+            const auto scale = previous.scale[i] == current.scale[i]
+                                   ? current.scale[i]
+                                   : glm::mix(previous.scale[i], current.scale[i], alpha);
+            if (translation != GetTranslation(transforms, node)) {
+                SetTranslation(transforms, node, translation);
+            }
+            if (rotation != GetRotation(transforms, node)) {
+                SetRotation(transforms, node, rotation);
+            }
+            if (scale != GetScale(transforms, node)) {
+                SetScale(transforms, node, scale);
+            }
+        }
+    });
+
+    camera.camera_coords = glm::mix(previous.camera.camera_coords, current.camera.camera_coords, alpha);
+    camera.target_coords = current.camera.target_coords;
+    camera.proj = current.camera.proj;
+}
+
+std::uint64_t HashSnapshot(const SceneSnapshot& snapshot) {
+    auto hash = HashBytes(kFnvOffsetBasis, &snapshot.tick, sizeof(snapshot.tick));
+    hash = HashBytes(hash, &snapshot.camera, sizeof(snapshot.camera));
+    hash = HashBytes(hash, snapshot.translation.data(), snapshot.translation.size() * sizeof(glm::vec3));
+    hash = HashBytes(hash, snapshot.rotation.data(), snapshot.rotation.size() * sizeof(glm::quat));
+    return HashBytes(hash, snapshot.scale.data(), snapshot.scale.size() * sizeof(glm::vec3));
+}
+
+SimulationThread::SimulationThread(const SimulationClock::duration step, StepFunction step_function,
+                                   CaptureFunction capture, const SimulationMode mode)
+    : step(step), mode(mode), step_function(std::move(step_function)), capture(std::move(capture)) {
+    auto& initial = snapshots.WriteBuffer();
+    this->capture(initial);
+    initial.tick = 0;
+    initial.time = SimulationClock::now();
+    last_time = initial.time;
+    snapshots.Publish();
+    if (mode == SimulationMode::Threaded) {
+        thread = std::thread([this] { Run(); });
+    }
+}
+
+SimulationThread::~SimulationThread() {
+    stopping.store(true, std::memory_order_relaxed);
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+SimulationClock::time_point SimulationThread::Advance() {
+    if (mode != SimulationMode::Lockstep) {
+        throw std::logic_error("SimulationThread::Advance() outside lockstep mode");
+    }
+    last_time += step;
+    StepAndPublish(last_time);
+    return last_time;
+}
+
+void SimulationThread::StepAndPublish(const SimulationClock::time_point time) {
+    PROFILE_ZONE("SimulationStep");
+    step_function(std::chrono::duration<float>(step).count());
+    auto& snapshot = snapshots.WriteBuffer();
+    capture(snapshot);
+    snapshot.tick = ++tick;
+    snapshot.time = time;
+    snapshots.Publish();
+}
+
+void SimulationThread::Run() {
+    auto next = last_time;
+    SetProfilerThreadName("simulation");
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        next += step;
+        std::this_thread::sleep_until(next);
+        StepAndPublish(next);
+
+        const auto now = SimulationClock::now();
+        if (now - next > step * kMaxCatchUpSteps) {
+            next = now;
+        }
+    }
+}
+
+void InterpolateSimulation(SnapshotInterpolator& interpolator, SimulationThread& simulation,
+                           const SimulationClock::time_point now, CameraObject& camera,
+                           TransformHierarchy& transforms, ThreadPool& pool) {
+    if (simulation.Acquire()) {
+        // the reader's slot stays untouched until the next Acquire(), but the previous one is needed past that
+        std::swap(interpolator.previous, interpolator.current);
+        interpolator.current = simulation.Latest();
+        if (!interpolator.primed) {
+            interpolator.previous = interpolator.current;
+            interpolator.primed = true;
+        }
+    }
+    if (!interpolator.primed) {
+        return;
+    }
+
+    // draw one step behind the newest snapshot, at the matching point between the two held ones; they may be more
+    // than one step apart when frames are slower than the simulation
+    const auto target = now - simulation.Step();
+    const auto span = std::chrono::duration<float>(interpolator.current.time - interpolator.previous.time).count();
+    const auto into = std::chrono::duration<float>(target - interpolator.previous.time).count();
+    const auto alpha = span > 0.0f ? std::clamp(into / span, 0.0f, 1.0f) : 1.0f;
+    InterpolateSnapshots(interpolator.previous, interpolator.current, alpha, camera, transforms, pool);
+}
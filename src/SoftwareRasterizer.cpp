@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "SoftwareRasterizer.hpp"
+
+namespace {
+    constexpr float kNearClipW = 1e-5f;
+
+    struct ClipVertex {
+        glm::vec4 pos;
+        glm::vec3 color;
+    };
+
+    // Sutherland-Hodgman against w > kNearClipW. x/y are left to the tile bounds and depth is not clipped, matching
+    // the pipeline's rasterizer state (depth clip disabled).
+    int ClipTriangleToNearPlane(const ClipVertex (&in)[3], ClipVertex (&out)[4]) {
+        int count = 0;
+        for (int i = 0; i < 3; ++i) {
+            const auto& a = in[i];
+            const auto& b = in[(i + 1) % 3];
+            const bool a_inside = a.pos.w > kNearClipW;
+            const bool b_inside = b.pos.w > kNearClipW;
+            if (a_inside) {
+                out[count++] = a;
+            }
+            if (a_inside != b_inside) {
+                const float t = (kNearClipW - a.pos.w) / (b.pos.w - a.pos.w);
+                out[count++] = ClipVertex{a.pos + (b.pos - a.pos) * t, a.color + (b.color - a.color) * t};
+            }
+        }
+        return count;
+    }
+
+    float EdgeFunction(const float ax, const float ay, const float bx, const float by, const float px,
+                       const float py) {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    }
+
+    // Top-left fill rule for the clockwise-on-screen winding SetupTriangle() normalizes to (y grows downwards).
+    bool IsTopLeftEdge(const float ax, const float ay, const float bx, const float by) {
+        return (ay == by && bx > ax) || by < ay;
+    }
+
+    bool SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, const int width,
+                       const int height, RasterTriangle& tri) {
+        const ClipVertex* verts[3] = {&v0, &v1, &v2};
+        for (int i = 0; i < 3; ++i) {
+            const auto& v = *verts[i];
+            const float inv_w = 1.0f / v.pos.w;
+            tri.x[i] = (v.pos.x * inv_w * 0.5f + 0.5f) * static_cast<float>(width);
+            tri.y[i] = (0.5f - v.pos.y * inv_w * 0.5f) * static_cast<float>(height);
+            tri.inv_w[i] = inv_w;
+            tri.color_over_w[i] = v.color * inv_w;
+        }
+
+        auto area = EdgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+        if (area == 0.0f || !std::isfinite(area)) {
+            return false;
+        }
+        if (area < 0.0f) { // no culling: flip to the canonical winding instead
+            std::swap(tri.x[1], tri.x[2]);
+            std::swap(tri.y[1], tri.y[2]);
+            std::swap(tri.inv_w[1], tri.inv_w[2]);
+            std::swap(tri.color_over_w[1], tri.color_over_w[2]);
+            area = -area;
+        }
+        tri.inv_area = 1.0f / area;
+        tri.max_depth = std::max({tri.inv_w[0], tri.inv_w[1], tri.inv_w[2]});
+
+        const auto min_x = std::min({tri.x[0], tri.x[1], tri.x[2]});
+        const auto max_x = std::max({tri.x[0], tri.x[1], tri.x[2]});
+        const auto min_y = std::min({tri.y[0], tri.y[1], tri.y[2]});
+        const auto max_y = std::max({tri.y[0], tri.y[1], tri.y[2]});
+        tri.min_x = std::max(0, static_cast<int>(std::floor(min_x - 0.5f)));
+        tri.min_y = std::max(0, static_cast<int>(std::floor(min_y - 0.5f)));
+        tri.max_x = std::min(width - 1, static_cast<int>(std::ceil(max_x - 0.5f)));
+        tri.max_y = std::min(height - 1, static_cast<int>(std::ceil(max_y - 0.5f)));
+        return tri.min_x <= tri.max_x && tri.min_y <= tri.max_y;
+    }
+
+    void TransformVertices(SoftwareRasterizer& r, const Scene& scene) {
+        auto& offsets = r.vertex_offsets;
+        offsets.assign(1, 0);
+        for (const auto& obj : scene.Objects) {
+            offsets.push_back(offsets.back() + obj.vertices.size());
+        }
+        r.clip_positions.resize(offsets.back());
+        r.vertex_colors.resize(offsets.back());
+
+        for (std::size_t object_number = 0; object_number < scene.Objects.size(); ++object_number) {
+            const auto& obj = scene.Objects[object_number];
+            const auto mvp = scene.Camera.proj * scene.Camera.view * obj.model;
+            const auto base = offsets[object_number];
+            const bool has_normals = obj.normals.size() == obj.vertices.size();
+
+            r.pool->ParallelFor(obj.vertices.size(), 4096, [&](std::size_t begin, std::size_t end, unsigned) {
+                for (auto i = begin; i < end; ++i) {
+                    r.clip_positions[base + i] = mvp * glm::vec4{obj.vertices[i].pos, 1.0f};
+                    const auto normal = has_normals ? obj.normals[i] : glm::vec3{0.0f, 0.0f, 0.0f};
+                    r.vertex_colors[base + i] = (normal + glm::vec3{1.0f, 1.0f, 1.0f}) * 0.5f;
+                }
+            });
+        }
+    }
+
+    void BinTriangle(SoftwareRasterizer& r, const unsigned thread, const std::uint32_t order,
+                     const RasterTriangle& tri) {
+        auto& triangles = r.thread_triangles[thread];
+        const auto slot = static_cast<std::uint32_t>(triangles.size());
+        triangles.push_back(tri);
+
+        auto& bins = r.thread_bins[thread];
+        for (int ty = tri.min_y / kRasterTileSize; ty <= tri.max_y / kRasterTileSize; ++ty) {
+            for (int tx = tri.min_x / kRasterTileSize; tx <= tri.max_x / kRasterTileSize; ++tx) {
+                bins[ty * r.tiles_x + tx].push_back(RasterBinEntry{order, slot});
+            }
+        }
+    }
+
+    void SetupAndBinTriangles(SoftwareRasterizer& r, const Scene& scene) {
+        auto& offsets = r.triangle_offsets;
+        offsets.assign(1, 0);
+        for (const auto& obj : scene.Objects) {
+            offsets.push_back(offsets.back() + obj.indices.size());
+        }
+
+        r.pool->ParallelFor(offsets.back(), 2048, [&](std::size_t begin, std::size_t end, unsigned thread) {
+            auto& stats = r.thread_stats[thread];
+            auto object_number = static_cast<std::size_t>(
+                std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1);
+
+            for (auto triangle_number = begin; triangle_number < end; ++triangle_number) {
+                while (triangle_number >= offsets[object_number + 1]) {
+                    ++object_number;
+                }
+                const auto& obj = scene.Objects[object_number];
+                const auto base = r.vertex_offsets[object_number];
+                const auto indices = obj.indices[triangle_number - offsets[object_number]];
+                ++stats.triangles_submitted;
+
+                const ClipVertex corners[3] = {
+                    {r.clip_positions[base + indices[0]], r.vertex_colors[base + indices[0]]},
+                    {r.clip_positions[base + indices[1]], r.vertex_colors[base + indices[1]]},
+                    {r.clip_positions[base + indices[2]], r.vertex_colors[base + indices[2]]},
+                };
+                ClipVertex clipped[4];
+                const auto clipped_count = ClipTriangleToNearPlane(corners, clipped);
+
+                // fan out the clipped polygon; both halves keep the source triangle's submission order
+                for (int i = 1; i + 1 < clipped_count; ++i) {
+                    RasterTriangle tri{};
+                    if (SetupTriangle(clipped[0], clipped[i], clipped[i + 1], r.framebuffer.width,
+                                      r.framebuffer.height, tri)) {
+                        BinTriangle(r, thread, static_cast<std::uint32_t>(triangle_number), tri);
+                        ++stats.triangles_rasterized;
+                    }
+                }
+            }
+        });
+    }
+
+    void UpdateBlockMinDepth(SoftwareRasterizer& r, const int block_x, const int block_y) {
+        auto& fb = r.framebuffer;
+        const auto x0 = block_x * kRasterBlockSize;
+        const auto y0 = block_y * kRasterBlockSize;
+        const auto x1 = std::min(x0 + kRasterBlockSize, fb.width);
+        const auto y1 = std::min(y0 + kRasterBlockSize, fb.height);
+
+        auto block_min = fb.depth[y0 * fb.width + x0];
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                block_min = std::min(block_min, fb.depth[y * fb.width + x]);
+            }
+        }
+        const auto blocks_x = (fb.width + kRasterBlockSize - 1) / kRasterBlockSize;
+        r.block_min_depth[block_y * blocks_x + block_x] = block_min;
+    }
+
+    void RasterizeBlock(SoftwareRasterizer& r, const RasterTriangle& tri, const int block_x, const int block_y,
+                        const int x_begin, const int x_end, const int y_begin, const int y_end,
+                        SoftwareRasterizerStats& stats) {
+        auto& fb = r.framebuffer;
+        const auto blocks_x = (fb.width + kRasterBlockSize - 1) / kRasterBlockSize;
+
+        // hierarchical depth: 1/w is affine in screen space, so no fragment can beat the block's farthest depth
+        // unless a vertex does
+        if (tri.max_depth <= r.block_min_depth[block_y * blocks_x + block_x]) {
+            ++stats.blocks_depth_rejected;
+            return;
+        }
+
+        // edge functions and their per-pixel steps; vertex i's weight is the edge opposite it
+        float edge_origin[3];
+        float step_x[3];
+        float step_y[3];
+        bool top_left[3];
+        const float px = static_cast<float>(x_begin) + 0.5f;
+        const float py = static_cast<float>(y_begin) + 0.5f;
+        for (int i = 0; i < 3; ++i) {
+            const int a = (i + 1) % 3;
+            const int b = (i + 2) % 3;
+            edge_origin[i] = EdgeFunction(tri.x[a], tri.y[a], tri.x[b], tri.y[b], px, py);
+            step_x[i] = -(tri.y[b] - tri.y[a]);
+            step_y[i] = tri.x[b] - tri.x[a];
+            top_left[i] = IsTopLeftEdge(tri.x[a], tri.y[a], tri.x[b], tri.y[b]);
+        }
+
+        // trivially reject when all four pixel-center corners are outside the same edge
+        const float span_x = static_cast<float>(x_end - 1 - x_begin);
+        const float span_y = static_cast<float>(y_end - 1 - y_begin);
+        for (int i = 0; i < 3; ++i) {
+            const auto e00 = edge_origin[i];
+            const auto e10 = e00 + step_x[i] * span_x;
+            const auto e01 = e00 + step_y[i] * span_y;
+            const auto e11 = e10 + step_y[i] * span_y;
+            if (std::max({e00, e10, e01, e11}) < 0.0f) {
+                return;
+            }
+        }
+
+        bool wrote_any = false;
+        for (int y = y_begin; y < y_end; ++y) {
+            const float row = static_cast<float>(y - y_begin);
+            const auto lane_count = x_end - x_begin;
+
+            // fixed-width lanes the compiler turns into SIMD on both NEON and SSE targets
+            float w[3][kRasterBlockSize];
+            float depth[kRasterBlockSize];
+            bool covered[kRasterBlockSize];
+            for (int lane = 0; lane < kRasterBlockSize; ++lane) {
+                for (int i = 0; i < 3; ++i) {
+                    w[i][lane] = edge_origin[i] + step_y[i] * row + step_x[i] * static_cast<float>(lane);
+                }
+                covered[lane] = lane < lane_count;
+                for (int i = 0; i < 3; ++i) {
+                    covered[lane] &= (w[i][lane] > 0.0f) | ((w[i][lane] == 0.0f) & top_left[i]);
+                }
+                depth[lane] = (w[0][lane] * tri.inv_w[0] + w[1][lane] * tri.inv_w[1] + w[2][lane] * tri.inv_w[2]) *
+                              tri.inv_area;
+            }
+
+            auto* depth_row = &fb.depth[y * fb.width + x_begin];
+            auto* color_row = &fb.color[y * fb.width + x_begin];
+            for (int lane = 0; lane < lane_count; ++lane) {
+                if (!covered[lane] || !(depth[lane] > depth_row[lane])) {
+                    continue;
+                }
+                const auto color = (tri.color_over_w[0] * w[0][lane] + tri.color_over_w[1] * w[1][lane] +
+                                    tri.color_over_w[2] * w[2][lane]) *
+                                   (tri.inv_area / depth[lane]);
+                depth_row[lane] = depth[lane];
+                color_row[lane] = glm::u8vec4{
+                    static_cast<std::uint8_t>(std::clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f),
+                    static_cast<std::uint8_t>(std::clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f),
+                    static_cast<std::uint8_t>(std::clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f),
+                    255,
+                };
+                wrote_any = true;
+            }
+        }
+        if (wrote_any) {
+            UpdateBlockMinDepth(r, block_x, block_y);
+        }
+    }
+
+    void RasterizeTile(SoftwareRasterizer& r, const int tile_x, const int tile_y, const unsigned thread) {
+        auto& fb = r.framebuffer;
+        const auto tile_index = tile_y * r.tiles_x + tile_x;
+        const auto tile_x0 = tile_x * kRasterTileSize;
+        const auto tile_y0 = tile_y * kRasterTileSize;
+        const auto tile_x1 = std::min(tile_x0 + kRasterTileSize, fb.width) - 1;
+        const auto tile_y1 = std::min(tile_y0 + kRasterTileSize, fb.height) - 1;
+
+        // a thread bins its chunks in whatever order it ran or stole them, so put each bin in submission order
+        // (usually a no-op check), then merge them so ties resolve like the GPU would
+        const auto thread_count = r.thread_bins.size();
+        const auto by_order = [](const RasterBinEntry& a, const RasterBinEntry& b) { return a.order < b.order; };
+        for (std::size_t t = 0; t < thread_count; ++t) {
+            auto& bin = r.thread_bins[t][tile_index];
+            if (!std::is_sorted(bin.begin(), bin.end(), by_order)) {
+                std::stable_sort(bin.begin(), bin.end(), by_order);
+            }
+        }
+        auto& heads = r.thread_merge_heads[thread];
+        std::fill(heads.begin(), heads.end(), 0);
+        while (true) {
+            std::size_t best_thread = thread_count;
+            std::uint32_t best_order = 0;
+            for (std::size_t t = 0; t < thread_count; ++t) {
+                const auto& bin = r.thread_bins[t][tile_index];
+                if (heads[t] < bin.size() && (best_thread == thread_count || bin[heads[t]].order < best_order)) {
+                    best_thread = t;
+                    best_order = bin[heads[t]].order;
+                }
+            }
+            if (best_thread == thread_count) {
+                break;
+            }
+            const auto entry = r.thread_bins[best_thread][tile_index][heads[best_thread]++];
+            const auto& tri = r.thread_triangles[best_thread][entry.slot];
+
+            const auto x0 = std::max(tri.min_x, tile_x0);
+            const auto y0 = std::max(tri.min_y, tile_y0);
+            const auto x1 = std::min(tri.max_x, tile_x1);
+            const auto y1 = std::min(tri.max_y, tile_y1);
+            for (int by = y0 / kRasterBlockSize; by <= y1 / kRasterBlockSize; ++by) {
+                for (int bx = x0 / kRasterBlockSize; bx <= x1 / kRasterBlockSize; ++bx) {
+                    const auto block_x0 = bx * kRasterBlockSize;
+                    const auto block_y0 = by * kRasterBlockSize;
+                    const auto block_x1 = std::min(block_x0 + kRasterBlockSize, fb.width);
+                    const auto block_y1 = std::min(block_y0 + kRasterBlockSize, fb.height);
+                    RasterizeBlock(r, tri, bx, by, block_x0, block_x1, block_y0, block_y1, r.thread_stats[thread]);
+                }
+            }
+        }
+    }
+}
+
+SoftwareRasterizer CreateSoftwareRasterizer(const int width, const int height, ThreadPool& pool) {
+    SoftwareRasterizer r{};
+    r.pool = &pool;
+    r.framebuffer.width = width;
+    r.framebuffer.height = height;
+    r.framebuffer.color.resize(static_cast<std::size_t>(width) * height);
+    r.framebuffer.depth.resize(static_cast<std::size_t>(width) * height);
+    r.tiles_x = (width + kRasterTileSize - 1) / kRasterTileSize;
+    r.tiles_y = (height + kRasterTileSize - 1) / kRasterTileSize;
+
+    const auto blocks_x = (width + kRasterBlockSize - 1) / kRasterBlockSize;
+    const auto blocks_y = (height + kRasterBlockSize - 1) / kRasterBlockSize;
+    r.block_min_depth.resize(static_cast<std::size_t>(blocks_x) * blocks_y);
+
+    const auto thread_count = pool.ThreadCount();
+    r.thread_triangles.resize(thread_count);
+    r.thread_merge_heads.assign(thread_count, std::vector<std::size_t>(thread_count));
+    r.thread_bins.assign(thread_count, std::vector<std::vector<RasterBinEntry>>(r.tiles_x * r.tiles_y));
+    r.thread_stats.resize(thread_count);
+    return r;
+}
+
+SoftwareRasterizerStats RenderSceneSoftware(SoftwareRasterizer& r, const Scene& scene) {
+    auto& fb = r.framebuffer;
+    std::fill(fb.color.begin(), fb.color.end(), glm::u8vec4{0, 0, 0, 255});
+    std::fill(fb.depth.begin(), fb.depth.end(), 0.0f);
+    std::fill(r.block_min_depth.begin(), r.block_min_depth.end(), 0.0f);
+    for (std::size_t t = 0; t < r.thread_bins.size(); ++t) {
+        r.thread_triangles[t].clear();
+        for (auto& bin : r.thread_bins[t]) {
+            bin.clear();
+        }
+        r.thread_stats[t] = SoftwareRasterizerStats{};
+    }
+
+    TransformVertices(r, scene);
+    SetupAndBinTriangles(r, scene);
+
+    r.pool->ParallelFor(static_cast<std::size_t>(r.tiles_x) * r.tiles_y, 1,
+                        [&](std::size_t begin, std::size_t end, unsigned thread) {
+                            for (auto tile = begin; tile < end; ++tile) {
+                                RasterizeTile(r, static_cast<int>(tile % r.tiles_x),
+                                              static_cast<int>(tile / r.tiles_x), thread);
+                            }
+                        });
+
+    SoftwareRasterizerStats total{};
+    for (const auto& stats : r.thread_stats) {
+        total.triangles_submitted += stats.triangles_submitted;
+        total.triangles_rasterized += stats.triangles_rasterized;
+        total.blocks_depth_rejected += stats.blocks_depth_rejected;
+    }
+    return total;
+}
+
+bool WriteFramebufferPPM(const SoftwareFramebuffer& framebuffer, const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file << "P6\n" << framebuffer.width << " " << framebuffer.height << "\n255\n";
+    for (const auto& pixel : framebuffer.color) {
+        const char rgb[3] = {static_cast<char>(pixel.x), static_cast<char>(pixel.y), static_cast<char>(pixel.z)};
+        file.write(rgb, 3);
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <glm/ext/matrix_transform.hpp>
+#include <iostream>
+#include <stdexcept>
+
+#include "FrameStats.hpp"
+#include "FrustumCulling.hpp"
+#include "Profiler.hpp"
+#include "Terrain.hpp"
+
+namespace {
+    float LatticeValue(const std::int32_t x, const std::int32_t z, const std::uint32_t seed) {
+        auto h = static_cast<std::uint32_t>(x) * 0x8da6b343u ^ static_cast<std::uint32_t>(z) * 0xd8163841u ^
+                 seed * 0xcb1ab31fu;
+        h ^= h >> 13;
+        h *= 0x5bd1e995u;
+        h ^= h >> 15;
+        return static_cast<float>(h & 0xffffffu) / static_cast<float>(0xffffffu) * 2.0f - 1.0f;
+    }
+
+    // Smoothly interpolated random values on the integer lattice, in [-1, 1].
+    float ValueNoise(const float x, const float z, const std::uint32_t seed) {
+        const auto x0 = std::floor(x);
+        const auto z0 = std::floor(z);
+        const auto ix = static_cast<std::int32_t>(x0);
+        const auto iz = static_cast<std::int32_t>(z0);
+        const auto fade = [](const float t) { return t * t * (3.0f - 2.0f * t); };
+        const auto u = fade(x - x0);
+        const auto v = fade(z - z0);
+        const auto bottom = glm::mix(LatticeValue(ix, iz, seed), LatticeValue(ix + 1, iz, seed), u);
+        const auto top = glm::mix(LatticeValue(ix, iz + 1, seed), LatticeValue(ix + 1, iz + 1, seed), u);
+        return glm::mix(bottom, top, v);
+    }
+
+    glm::u8vec4 TerrainColor(const TerrainSettings& settings, const float height) {
+        const auto t = std::clamp((height - settings.base_height) / (2.0f * settings.height_scale) + 0.5f, 0.0f, 1.0f);
+        const auto low = glm::vec3{60.0f, 130.0f, 55.0f};
+        const auto mid = glm::vec3{120.0f, 100.0f, 70.0f};
+        const auto high = glm::vec3{235.0f, 235.0f, 240.0f};
+        const auto color = t < 0.6f ? glm::mix(low, mid, t / 0.6f) : glm::mix(mid, high, (t - 0.6f) / 0.4f);
+        return glm::u8vec4{glm::u8vec3{color}, 255};
+    }
+
+    // grid and skirts of one level; TerrainLodLevels() only keeps levels whose stride divides chunk_cells
+    std::uint32_t TerrainLevelTriangles(const std::uint32_t cells, const std::uint32_t level) {
+        const auto quads = cells >> level; // per side
+        return quads * quads * 2 + 8 * quads;
+    }
+
+    // Vertex index of the k-th vertex along one of a chunk's edges: z = 0, z = cells, x = 0, x = cells.
+    std::uint32_t EdgeVertex(const std::uint32_t cells, const std::uint32_t edge, const std::uint32_t k) {
+        const auto side = cells + 1;
+        switch (edge) {
+        case 0:
+            return k;
+        case 1:
+            return cells * side + k;
+        case 2:
+            return k * side;
+        default:
+            return k * side + cells;
+        }
+    }
+
+    double MillisecondsSince(const std::chrono::steady_clock::time_point start) {
+        return MillisecondsBetween(start, std::chrono::steady_clock::now());
+    }
+}
+
+float TerrainHeight(const TerrainSettings& settings, const float x, const float z) {
+    auto frequency = 1.0f / settings.feature_size;
+    auto amplitude = 1.0f;
+    auto sum = 0.0f;
+    auto total_amplitude = 0.0f;
+    for (std::uint32_t octave = 0; octave < settings.octaves; ++octave) {
+        sum += amplitude * ValueNoise(x * frequency, z * frequency, settings.seed + octave);
+        total_amplitude += amplitude;
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+    return settings.base_height + settings.height_scale * sum / std::max(total_amplitude, 1e-6f);
+}
+
+std::uint32_t TerrainLodLevels(const TerrainSettings& settings) {
+    std::uint32_t levels = 1;
+    while (levels < kMaxLodLevels && settings.chunk_cells % (1u << levels) == 0) {
+        ++levels;
+    }
+    return levels;
+}
+
+RenderableObject CreateTerrainChunk(const TerrainSettings& settings, const TerrainChunkCoord coord) {
+    const auto cells = settings.chunk_cells;
+    const auto side = cells + 1;
+    const auto step = settings.chunk_size / static_cast<float>(cells);
+    const auto origin = glm::vec3{static_cast<float>(coord.x), 0.0f, static_cast<float>(coord.z)} * settings.chunk_size;
+
+    // one extra sample all round, so edge normals see the neighbouring chunk's heights
+    const auto apron = side + 2;
+    std::vector<float> heights(std::size_t{apron} * apron);
+    for (std::uint32_t j = 0; j < apron; ++j) {
+        for (std::uint32_t i = 0; i < apron; ++i) {
+            heights[j * apron + i] = TerrainHeight(settings, origin.x + (static_cast<float>(i) - 1.0f) * step,
+                                                   origin.z + (static_cast<float>(j) - 1.0f) * step);
+        }
+    }
+    const auto height = [&](const std::uint32_t i, const std::uint32_t j) { return heights[(j + 1) * apron + i + 1]; };
+
+    RenderableObject chunk{};
+    chunk.vertices.reserve(std::size_t{side} * side + 4 * side);
+    chunk.normals.reserve(chunk.vertices.capacity());
+    for (std::uint32_t j = 0; j < side; ++j) {
+        for (std::uint32_t i = 0; i < side; ++i) {
+            const auto h = height(i, j);
+            chunk.vertices.push_back(PositionAndColorVertex{
+                .pos = {static_cast<float>(i) * step, h, static_cast<float>(j) * step},
+                .color = TerrainColor(settings, h)});
+            // height(i - 1, ...) and height(..., j - 1) reach into the apron
+            const auto dx = heights[(j + 1) * apron + i] - heights[(j + 1) * apron + i + 2];
+            const auto dz = heights[j * apron + i + 1] - heights[(j + 2) * apron + i + 1];
+            chunk.normals.push_back(glm::normalize(glm::vec3{dx, 2.0f * step, dz}));
+        }
+    }
+
+    // each level's error is the largest height difference between the full grid and the coarser grid's cells
+    const auto levels = TerrainLodLevels(settings);
+    for (std::uint32_t level = 1; level < levels; ++level) {
+        const auto stride = 1u << level;
+        auto error = 0.0f;
+        for (std::uint32_t j = 0; j < side; ++j) {
+            for (std::uint32_t i = 0; i < side; ++i) {
+                const auto i0 = std::min(i / stride * stride, cells - stride);
+                const auto j0 = std::min(j / stride * stride, cells - stride);
+                const auto u = static_cast<float>(i - i0) / static_cast<float>(stride);
+                const auto v = static_cast<float>(j - j0) / static_cast<float>(stride);
+                const auto coarse = glm::mix(glm::mix(height(i0, j0), height(i0 + stride, j0), u),
+                                             glm::mix(height(i0, j0 + stride), height(i0 + stride, j0 + stride), u), v);
+                error = std::max(error, std::abs(height(i, j) - coarse));
+            }
+        }
+        chunk.lods.push_back(LodLevel{.indices = {}, .error = error});
+    }
+    // what the shared index pattern draws at each level, for the LOD statistics
+    for (std::uint32_t level = 0; level < levels; ++level) {
+        chunk.level_triangles.push_back(TerrainLevelTriangles(cells, level));
+    }
+
+    // skirts: a copy of every edge vertex, lowered past the coarsest level's error
+    const auto skirt_depth = (chunk.lods.empty() ? 0.0f : chunk.lods.back().error) + step;
+    for (std::uint32_t edge = 0; edge < 4; ++edge) {
+        for (std::uint32_t k = 0; k < side; ++k) {
+            const auto top = EdgeVertex(cells, edge, k);
+            auto vertex = chunk.vertices[top];
+            vertex.pos.y -= skirt_depth;
+            chunk.vertices.push_back(vertex);
+            chunk.normals.push_back(chunk.normals[top]);
+        }
+    }
+
+    chunk.model = glm::translate(glm::identity<glm::mat4>(), origin);
+    UpdateLocalBounds(chunk);
+    return chunk;
+}
+
+RenderableObject CreateTerrainIndexPattern(const TerrainSettings& settings) {
+    const auto cells = settings.chunk_cells;
+    const auto side = cells + 1;
+    const auto skirt_start = side * side;
+
+    RenderableObject pattern{};
+    pattern.vertices.resize(std::size_t{side} * side + 4 * side);
+    for (std::uint32_t level = 0; level < TerrainLodLevels(settings); ++level) {
+        const auto stride = 1u << level;
+        std::vector<TriangleIndices> triangles;
+        triangles.reserve(TerrainLevelTriangles(cells, level));
+        for (std::uint32_t j = 0; j < cells; j += stride) {
+            for (std::uint32_t i = 0; i < cells; i += stride) {
+                const auto a = j * side + i;
+                const auto b = a + stride;
+                const auto c = a + stride * side;
+                const auto d = c + stride;
+                triangles.emplace_back(a, c, b);
+                triangles.emplace_back(b, c, d);
+            }
+        }
+        for (std::uint32_t edge = 0; edge < 4; ++edge) {
+            for (std::uint32_t k = 0; k < cells; k += stride) {
+                const auto top0 = EdgeVertex(cells, edge, k);
+                const auto top1 = EdgeVertex(cells, edge, k + stride);
+                const auto bottom0 = skirt_start + edge * side + k;
+                const auto bottom1 = bottom0 + stride;
+                triangles.emplace_back(top0, bottom0, top1);
+                triangles.emplace_back(top1, bottom0, bottom1);
+            }
+        }
+        if (level == 0) {
+            pattern.indices = std::move(triangles);
+        }
+        else {
+            pattern.lods.push_back(LodLevel{.indices = std::move(triangles), .error = 0.0f});
+        }
+    }
+    return pattern;
+}
+
+TerrainStreamer::TerrainStreamer(const TerrainSettings& settings, const VertexFormat format,
+                                 const unsigned thread_count)
+    : settings(settings), format(format) {
+    if (settings.chunk_cells == 0 || settings.chunk_size <= 0.0f) {
+        throw std::invalid_argument("TerrainStreamer: chunks need a positive size and at least one cell");
+    }
+    for (unsigned i = 0; i < std::max(thread_count, 1u); ++i) {
+        workers.emplace_back(&TerrainStreamer::WorkerLoop, this);
+    }
+}
+
+TerrainStreamer::~TerrainStreamer() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TerrainStreamer::WorkerLoop() {
+    SetProfilerThreadName("terrain");
+    while (true) {
+        Request request;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            request = queue.front();
+            queue.pop_front();
+        }
+
+        GeneratedChunk chunk{.request = request};
+        {
+            PROFILE_ZONE("GenerateTerrainChunk");
+            chunk.obj = CreateTerrainChunk(settings, request.coord);
+            if (format == VertexFormat::Quantized) {
+                chunk.mesh = QuantizeMesh(chunk.obj);
+            }
+        }
+        chunk.generation_ms = MillisecondsSince(request.requested);
+
+        std::lock_guard lock(mutex);
+        generated.push_back(std::move(chunk));
+    }
+}
+
+bool TerrainStreamer::InRange(const TerrainChunkCoord coord, const glm::vec3& center, const float radius) const {
+    const auto chunk_center = glm::vec2{static_cast<float>(coord.x) + 0.5f, static_cast<float>(coord.z) + 0.5f} *
+                              settings.chunk_size;
+    const auto offset = chunk_center - glm::vec2{center.x, center.z};
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+void TerrainStreamer::Update(const glm::vec3& center, std::vector<RenderableObject>& objects, GeometryHeap& heap,
+                             UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf) {
+    PROFILE_ZONE("StreamTerrain");
+    if (pattern == kNoGeometry) {
+        pattern = UploadIndexPattern(heap, ring, cmdbuf, CreateTerrainIndexPattern(settings));
+        const auto& allocation = heap.allocations[pattern];
+        pattern_bytes =
+            std::uint64_t{allocation.indices.count} * (allocation.index_size == SDL_GPU_INDEXELEMENTSIZE_32BIT ? 4 : 2);
+        stats.resident_bytes += pattern_bytes;
+    }
+    Evict(center, objects, heap);
+    UploadFinished(center, objects, heap, ring, cmdbuf);
+    QueueMissing(center);
+    stats.resident_chunks = resident.size();
+    stats.pending_chunks = pending.size();
+}
+
+void TerrainStreamer::Evict(const glm::vec3& center, std::vector<RenderableObject>& objects, GeometryHeap& heap) {
+    const auto keep_radius = settings.load_radius + settings.evict_margin;
+    for (auto it = resident.begin(); it != resident.end();) {
+        if (InRange(it->first, center, keep_radius)) {
+            ++it;
+            continue;
+        }
+        const auto& chunk = it->second;
+        FreeGeometry(heap, chunk.geometry);
+        objects[chunk.object] = RenderableObject{.model = glm::identity<glm::mat4>()};
+        free_objects.push_back(chunk.object);
+        stats.resident_bytes -= chunk.bytes;
+        ++stats.evicted;
+        it = resident.erase(it);
+    }
+
+    // queued chunks that left range are dropped before they are generated
+    std::lock_guard lock(mutex);
+    std::erase_if(queue, [&](const Request& request) {
+        if (InRange(request.coord, center, keep_radius)) {
+            return false;
+        }
+        pending.erase(request.coord);
+        ++stats.cancelled;
+        return true;
+    });
+}
+
+void TerrainStreamer::UploadFinished(const glm::vec3& center, std::vector<RenderableObject>& objects,
+                                     GeometryHeap& heap, UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf) {
+    {
+        std::lock_guard lock(mutex);
+        stats.generated += generated.size();
+        std::ranges::move(generated, std::back_inserter(finished));
+        generated.clear();
+    }
+    if (finished.empty()) {
+        return;
+    }
+
+    // nearest last, so the loop below takes the nearest first
+    const auto distance = [&](const GeneratedChunk& chunk) {
+        const auto chunk_center = glm::vec2{static_cast<float>(chunk.request.coord.x) + 0.5f,
+                                            static_cast<float>(chunk.request.coord.z) + 0.5f} *
+                                  settings.chunk_size;
+        const auto offset = chunk_center - glm::vec2{center.x, center.z};
+        return glm::dot(offset, offset);
+    };
+    std::ranges::sort(finished, std::greater{}, distance);
+
+    const auto keep_radius = settings.load_radius + settings.evict_margin;
+    const auto bytes_per_vertex = std::uint64_t{heap.vertex_stride} + heap.normal_stride;
+    std::uint64_t frame_bytes = 0;
+    while (!finished.empty()) {
+        auto& chunk = finished.back();
+        const auto coord = chunk.request.coord;
+        if (!InRange(coord, center, keep_radius)) {
+            pending.erase(coord);
+            ++stats.cancelled;
+            finished.pop_back();
+            continue;
+        }
+        const auto bytes = chunk.obj.vertices.size() * bytes_per_vertex;
+        if (frame_bytes > 0 && frame_bytes + bytes > settings.upload_budget_bytes) {
+            ++stats.deferred_frames;
+            break;
+        }
+
+        const auto quantized = format == VertexFormat::Quantized;
+        chunk.obj.geometry = UploadPatternGeometry(heap, ring, cmdbuf, chunk.obj, pattern,
+                                                   quantized ? &chunk.mesh : nullptr);
+        if (quantized) {
+            chunk.obj.vertex_transform = chunk.mesh.dequantize;
+        }
+        // bounds and LOD errors are all the frame needs from here on
+        chunk.obj.vertices = {};
+        chunk.obj.normals = {};
+
+        auto object = static_cast<std::uint32_t>(objects.size());
+        if (free_objects.empty()) {
+            objects.emplace_back();
+        }
+        else {
+            object = free_objects.back();
+            free_objects.pop_back();
+        }
+        resident[coord] = ResidentChunk{.object = object, .geometry = chunk.obj.geometry, .bytes = bytes};
+        objects[object] = std::move(chunk.obj);
+
+        frame_bytes += bytes;
+        stats.resident_bytes += bytes;
+        stats.uploaded_bytes += bytes;
+        AddTimingSample(stats.generation_ms, chunk.generation_ms);
+        AddTimingSample(stats.resident_ms, MillisecondsSince(chunk.request.requested));
+        pending.erase(coord);
+        finished.pop_back();
+    }
+}
+
+void TerrainStreamer::QueueMissing(const glm::vec3& center) {
+    if (pending.size() >= settings.max_pending) {
+        return;
+    }
+    const auto reach = static_cast<std::int32_t>(std::ceil(settings.load_radius / settings.chunk_size));
+    const auto center_x = static_cast<std::int32_t>(std::floor(center.x / settings.chunk_size));
+    const auto center_z = static_cast<std::int32_t>(std::floor(center.z / settings.chunk_size));
+
+    missing.clear();
+    for (auto z = center_z - reach; z <= center_z + reach; ++z) {
+        for (auto x = center_x - reach; x <= center_x + reach; ++x) {
+            const auto coord = TerrainChunkCoord{x, z};
+            if (!InRange(coord, center, settings.load_radius) || resident.contains(coord) || pending.contains(coord)) {
+                continue;
+            }
+            const auto offset = glm::vec2{static_cast<float>(x) + 0.5f, static_cast<float>(z) + 0.5f} *
+                                    settings.chunk_size -
+                                glm::vec2{center.x, center.z};
+            missing.emplace_back(glm::dot(offset, offset), coord);
+        }
+    }
+    const auto count = std::min<std::size_t>(missing.size(), settings.max_pending - pending.size());
+    std::ranges::partial_sort(missing, missing.begin() + static_cast<std::ptrdiff_t>(count), {},
+                              [](const auto& candidate) { return candidate.first; });
+    if (count == 0) {
+        return;
+    }
+
+    const auto now = Clock::now();
+    {
+        std::lock_guard lock(mutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            queue.push_back(Request{.coord = missing[i].second, .requested = now});
+            pending.insert(missing[i].second);
+        }
+    }
+    wake.notify_all();
+}
+
+TerrainStats TerrainStreamer::Stats() const {
+    return stats;
+}
+
+void PrintTerrainReport(const TerrainStats& stats) {
+    const auto mb = [](const std::uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    const auto generation = SummarizeTimings(stats.generation_ms.samples);
+    const auto resident = SummarizeTimings(stats.resident_ms.samples);
+    std::cout << "Terrain streaming:\n";
+    std::cout << std::format("  resident chunks {}  pending {}  {:.2f} MB resident  generated {}  evicted {}  "
+                             "cancelled {}\n",
+                             stats.resident_chunks, stats.pending_chunks, mb(stats.resident_bytes), stats.generated,
+                             stats.evicted, stats.cancelled);
+    std::cout << std::format("  requested->generated median {:.2f} ms p99 {:.2f} ms  requested->resident median "
+                             "{:.2f} ms p99 {:.2f} ms\n",
+                             generation.median, generation.p99, resident.median, resident.p99);
+    std::cout << std::format("  {:.2f} MB uploaded  {} frames deferred chunks to stay within the upload budget\n",
+                             mb(stats.uploaded_bytes), stats.deferred_frames);
+}
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    // The pool the current thread is running jobs for, and under which index; set for a worker's whole life and for
+    // an external thread while it is inside ParallelFor or Wait.
+    struct ThreadContext {
+        const ThreadPool* pool = nullptr;
+        unsigned index = 0;
+    };
+    thread_local ThreadContext current_thread{};
+
+    class ThreadScope {
+    public:
+        ThreadScope(const ThreadPool* pool, const unsigned index) : saved(current_thread) {
+            current_thread = ThreadContext{pool, index};
+        }
+        ~ThreadScope() {
+            current_thread = saved;
+        }
+        ThreadScope(const ThreadScope&) = delete;
+        ThreadScope& operator=(const ThreadScope&) = delete;
+
+    private:
+        ThreadContext saved;
+    };
+}
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    queues.resize(kMaxExternalThreads + thread_count - 1);
+    for (auto& queue : queues) {
+        queue = std::make_unique<JobQueue>();
+    }
+    workers.reserve(thread_count - 1);
+    for (unsigned i = 0; i + 1 < thread_count; ++i) {
+        workers.emplace_back([this, i] { WorkerLoop(kMaxExternalThreads + i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(const std::size_t count, std::size_t grain, const RangeTask task) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    const ThreadScope scope(this, EnterThread());
+    if (workers.empty() || count <= grain) {
+        task(0, count, current_thread.index);
+        return;
+    }
+
+    // this thread splits the range first, so the halves it pushes are there to steal from the start
+    JobCounter counter;
+    counter.pending.store(1, std::memory_order_relaxed);
+    Run(current_thread.index, Job{.range = &task, .begin = 0, .end = count, .grain = grain, .counter = &counter});
+    Wait(counter);
+}
+
+void ThreadPool::Spawn(JobCounter& counter, const JobTask& task) {
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+    Push(EnterThread(), Job{.task = &task, .counter = &counter});
+}
+
+void ThreadPool::Wait(JobCounter& counter) {
+    const ThreadScope scope(this, EnterThread());
+    Job job;
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        if (PopOrSteal(current_thread.index, job)) {
+            Run(current_thread.index, job);
+        } else {
+            // what is left is running on other threads
+            std::this_thread::yield();
+        }
+    }
+    // the acquire above saw the failing job's release, so its error is visible
+    if (counter.failed.load(std::memory_order_relaxed)) {
+        auto error = std::exchange(counter.error, nullptr);
+        counter.failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::WorkerLoop(const unsigned thread_index) {
+    current_thread = ThreadContext{this, thread_index};
+    SetProfilerThreadName("pool worker");
+    Job job;
+    while (true) {
+        if (PopOrSteal(thread_index, job)) {
+            Run(thread_index, job);
+            continue;
+        }
+
+        // a pusher that saw no sleepers pushed before this thread counted itself, so the check below sees its job
+        std::unique_lock lock(sleep_mutex);
+        sleeping.fetch_add(1);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+ThreadPool::HeldExternalSlots::~HeldExternalSlots() {
+    for (const auto& [slots, index] : held) {
+        std::lock_guard lock(slots->mutex);
+        slots->taken[index] = false;
+    }
+}
+
+unsigned ThreadPool::EnterThread() {
+    if (current_thread.pool == this) {
+        return current_thread.index;
+    }
+    thread_local HeldExternalSlots thread_slots;
+    for (const auto& [slots, index] : thread_slots.held) {
+        if (slots == external_slots) {
+            return index;
+        }
+    }
+    std::lock_guard lock(external_slots->mutex);
+    const auto free = std::find(external_slots->taken.begin(), external_slots->taken.end(), false);
+    if (free == external_slots->taken.end()) {
+        throw std::logic_error("ThreadPool: more live external threads than kMaxExternalThreads");
+    }
+    *free = true;
+    const auto index = static_cast<unsigned>(free - external_slots->taken.begin());
+    thread_slots.held.emplace_back(external_slots, index);
+    return index;
+}
+
+void ThreadPool::Push(const unsigned thread_index, const Job& job) {
+    {
+        auto& queue = *queues[thread_index];
+        std::lock_guard lock(queue.mutex);
+        if (queue.size == queue.ring.size()) {
+            std::vector<Job> grown(queue.ring.size() * 2);
+            for (std::size_t i = 0; i < queue.size; ++i) {
+                grown[i] = queue.ring[(queue.front + i) & (queue.ring.size() - 1)];
+            }
+            queue.ring = std::move(grown);
+            queue.front = 0;
+        }
+        queue.ring[(queue.front + queue.size) & (queue.ring.size() - 1)] = job;
+        ++queue.size;
+    }
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        // taking the lock orders this notify after a sleeper's predicate check
+        { std::lock_guard lock(sleep_mutex); }
+        wake.notify_one();
+    }
+}
+
+bool ThreadPool::PopOrSteal(const unsigned thread_index, Job& job) {
+    {
+        auto& own = *queues[thread_index];
+        std::lock_guard lock(own.mutex);
+        if (own.size > 0) {
+            --own.size;
+            job = own.ring[(own.front + own.size) & (own.ring.size() - 1)];
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    if (queued.load() == 0) {
+        return false;
+    }
+    const auto queue_count = static_cast<unsigned>(queues.size());
+    for (unsigned offset = 1; offset < queue_count; ++offset) {
+        auto& victim = *queues[(thread_index + offset) % queue_count];
+        std::lock_guard lock(victim.mutex);
+        if (victim.size > 0) {
+            job = victim.ring[victim.front];
+            victim.front = (victim.front + 1) & (victim.ring.size() - 1);
+            --victim.size;
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Run(const unsigned thread_index, Job job) {
+    try {
+        if (job.range != nullptr) {
+            // keep the first half and hand out the rest, so thieves take the largest pieces left
+            while (job.end - job.begin > job.grain) {
+                const auto pieces = (job.end - job.begin + job.grain - 1) / job.grain;
+                const auto middle = job.begin + pieces / 2 * job.grain;
+                job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+                Push(thread_index, Job{.range = job.range, .begin = middle, .end = job.end, .grain = job.grain,
+                                       .counter = job.counter});
+                job.end = middle;
+            }
+            PROFILE_ZONE("ParallelFor chunk");
+            (*job.range)(job.begin, job.end, thread_index);
+        } else {
+            PROFILE_ZONE("Job");
+            (*job.task)(thread_index);
+        }
+    } catch (...) {
+        // the counter must still reach zero or its Wait() never returns; Wait() rethrows this instead
+        if (!job.counter->failed.exchange(true, std::memory_order_relaxed)) {
+            job.counter->error = std::current_exception();
+        }
+    }
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+ThreadPool& GetThreadPool() {
+    static ThreadPool pool{};
+    return pool;
+}
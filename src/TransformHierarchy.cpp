@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "TransformHierarchy.hpp"
+
+namespace {
+    constexpr std::size_t kLocalGrain = 1024;
+    constexpr std::size_t kWorldGrain = 1024;
+
+    void MarkDirty(TransformHierarchy& transforms, const TransformHandle handle) {
+        transforms.dirty.at(handle) = 1;
+    }
+
+    // world = parent * local, with local's implicit last row of (0, 0, 0, 1)
+    glm::mat4 ComposeWorld(const glm::mat4& parent, const std::array<std::vector<float>, 12>& local,
+                           const std::size_t k) {
+        const auto l = [&](const int r, const int c) { return local[r * 4 + c][k]; };
+        return glm::mat4{parent[0] * l(0, 0) + parent[1] * l(1, 0) + parent[2] * l(2, 0),
+                         parent[0] * l(0, 1) + parent[1] * l(1, 1) + parent[2] * l(2, 1),
+                         parent[0] * l(0, 2) + parent[1] * l(1, 2) + parent[2] * l(2, 2),
+                         parent[0] * l(0, 3) + parent[1] * l(1, 3) + parent[2] * l(2, 3) + parent[3]};
+    }
+}
+
+TransformHandle AddTransform(TransformHierarchy& transforms, const TransformHandle parent,
+                             const glm::vec3 translation, const glm::quat rotation, const glm::vec3 scale) {
+    const auto handle = static_cast<TransformHandle>(transforms.parent.size());
+    if (parent != kNoTransform && parent >= handle) {
+        throw std::out_of_range("AddTransform: parent does not exist");
+    }
+
+    transforms.translation_x.push_back(translation.x);
+    transforms.translation_y.push_back(translation.y);
+    transforms.translation_z.push_back(translation.z);
+    transforms.rotation_x.push_back(rotation.x);
+    transforms.rotation_y.push_back(rotation.y);
+    transforms.rotation_z.push_back(rotation.z);
+    transforms.rotation_w.push_back(rotation.w);
+    transforms.scale_x.push_back(scale.x);
+    transforms.scale_y.push_back(scale.y);
+    transforms.scale_z.push_back(scale.z);
+    transforms.parent.push_back(parent);
+    transforms.depth.push_back(parent == kNoTransform ? 0 : transforms.depth[parent] + 1);
+    transforms.dirty.push_back(1);
+    transforms.world_changed.push_back(0);
+    transforms.world.emplace_back(1.0f);
+    return handle;
+}
+
+glm::vec3 GetTranslation(const TransformHierarchy& transforms, const TransformHandle handle) {
+    return {transforms.translation_x.at(handle), transforms.translation_y[handle], transforms.translation_z[handle]};
+}
+
+glm::quat GetRotation(const TransformHierarchy& transforms, const TransformHandle handle) {
+    return glm::quat{transforms.rotation_w.at(handle), transforms.rotation_x[handle], transforms.rotation_y[handle],
+                     transforms.rotation_z[handle]};
+}
+
+glm::vec3 GetScale(const TransformHierarchy& transforms, const TransformHandle handle) {
+    return {transforms.scale_x.at(handle), transforms.scale_y[handle], transforms.scale_z[handle]};
+}
+
+void SetTranslation(TransformHierarchy& transforms, const TransformHandle handle, const glm::vec3 translation) {
+    MarkDirty(transforms, handle);
+    transforms.translation_x[handle] = translation.x;
+    transforms.translation_y[handle] = translation.y;
+    transforms.translation_z[handle] = translation.z;
+}
+
+void SetRotation(TransformHierarchy& transforms, const TransformHandle handle, const glm::quat rotation) {
+    MarkDirty(transforms, handle);
+    transforms.rotation_x[handle] = rotation.x;
+    transforms.rotation_y[handle] = rotation.y;
+    transforms.rotation_z[handle] = rotation.z;
+    transforms.rotation_w[handle] = rotation.w;
+}
+
+void SetScale(TransformHierarchy& transforms, const TransformHandle handle, const glm::vec3 scale) {
+    MarkDirty(transforms, handle);
+    transforms.scale_x[handle] = scale.x;
+    transforms.scale_y[handle] = scale.y;
+    transforms.scale_z[handle] = scale.z;
+}
+
+void ComposeLocalMatrices(const TransformHierarchy& transforms, const TransformHandle* nodes, const std::size_t count,
+                          const std::array<float*, 12>& rows) {
+    // plain arrays and no branches, so the compiler vectorizes the loop with gathered loads
+    const auto* __restrict tx = transforms.translation_x.data();
+    const auto* __restrict ty = transforms.translation_y.data();
+    const auto* __restrict tz = transforms.translation_z.data();
+    const auto* __restrict qx = transforms.rotation_x.data();
+    const auto* __restrict qy = transforms.rotation_y.data();
+    const auto* __restrict qz = transforms.rotation_z.data();
+    const auto* __restrict qw = transforms.rotation_w.data();
+    const auto* __restrict sx = transforms.scale_x.data();
+    const auto* __restrict sy = transforms.scale_y.data();
+    const auto* __restrict sz = transforms.scale_z.data();
+    float* __restrict m00 = rows[0];
+    float* __restrict m01 = rows[1];
+    float* __restrict m02 = rows[2];
+    float* __restrict m03 = rows[3];
+    float* __restrict m10 = rows[4];
+    float* __restrict m11 = rows[5];
+    float* __restrict m12 = rows[6];
+    float* __restrict m13 = rows[7];
+    float* __restrict m20 = rows[8];
+    float* __restrict m21 = rows[9];
+    float* __restrict m22 = rows[10];
+    float* __restrict m23 = rows[11];
+
+    for (std::size_t k = 0; k < count; ++k) {
+        const auto i = nodes[k];
+        const auto x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+        const auto xx = x * x, yy = y * y, zz = z * z;
+        const auto xy = x * y, xz = x * z, yz = y * z;
+        const auto wx = w * x, wy = w * y, wz = w * z;
+
+        // columns of the rotation matrix, each scaled by its axis
+        m00[k] = (1.0f - 2.0f * (yy + zz)) * sx[i];
+        m10[k] = 2.0f * (xy + wz) * sx[i];
+        m20[k] = 2.0f * (xz - wy) * sx[i];
+        m01[k] = 2.0f * (xy - wz) * sy[i];
+        m11[k] = (1.0f - 2.0f * (xx + zz)) * sy[i];
+        m21[k] = 2.0f * (yz + wx) * sy[i];
+        m02[k] = 2.0f * (xz + wy) * sz[i];
+        m12[k] = 2.0f * (yz - wx) * sz[i];
+        m22[k] = (1.0f - 2.0f * (xx + yy)) * sz[i];
+        m03[k] = tx[i];
+        m13[k] = ty[i];
+        m23[k] = tz[i];
+    }
+}
+
+void UpdateTransforms(TransformHierarchy& transforms, ThreadPool& pool) {
+    const auto count = transforms.parent.size();
+    auto& updated = transforms.updated;
+    auto& offsets = transforms.depth_offsets;
+
+    // topological order: a parent's flag is final before any of its children read it
+    std::uint32_t max_depth = 0;
+    std::size_t changed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto parent = transforms.parent[i];
+        const bool moved =
+            transforms.dirty[i] != 0 || (parent != kNoTransform && transforms.world_changed[parent] != 0);
+        transforms.world_changed[i] = moved ? 1 : 0;
+        transforms.dirty[i] = 0;
+        if (moved) {
+            max_depth = std::max(max_depth, transforms.depth[i]);
+            ++changed;
+        }
+    }
+    if (changed == 0) {
+        return;
+    }
+
+    // counting sort by depth, so each depth is one contiguous run with its parents already composed
+    offsets.assign(max_depth + 2, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (transforms.world_changed[i] != 0) {
+            ++offsets[transforms.depth[i] + 1];
+        }
+    }
+    for (std::uint32_t d = 0; d <= max_depth; ++d) {
+        offsets[d + 1] += offsets[d];
+    }
+    updated.resize(changed);
+    auto& cursors = transforms.depth_cursors;
+    cursors.assign(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (transforms.world_changed[i] != 0) {
+            updated[cursors[transforms.depth[i]]++] = static_cast<TransformHandle>(i);
+        }
+    }
+
+    for (auto& row : transforms.local) {
+        row.resize(changed);
+    }
+    pool.ParallelFor(changed, kLocalGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        std::array<float*, 12> rows{};
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            rows[r] = transforms.local[r].data() + begin;
+        }
+        ComposeLocalMatrices(transforms, updated.data() + begin, end - begin, rows);
+    });
+
+    for (std::uint32_t d = 0; d <= max_depth; ++d) {
+        const auto first = offsets[d];
+        pool.ParallelFor(offsets[d + 1] - first, kWorldGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+            for (auto k = first + begin; k < first + end; ++k) {
+                const auto node = updated[k];
+                const auto parent = transforms.parent[node];
+                transforms.world[node] = ComposeWorld(
+                    parent == kNoTransform ? glm::mat4{1.0f} : transforms.world[parent], transforms.local, k);
+            }
+        });
+    }
+}
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include "UploadRing.hpp"
+
+namespace {
+    constexpr std::uint64_t kUploadAlignment = 4; // small so back-to-back writes stay contiguous and coalesce
+
+    std::uint64_t AlignUp(const std::uint64_t value, const std::uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    SDL_GPUTransferBuffer* CreateUploadTransferBuffer(SDL_GPUDevice* device, const std::uint32_t capacity) {
+        const auto info = SDL_GPUTransferBufferCreateInfo{.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = capacity};
+        auto transfer_buffer = SDL_CreateGPUTransferBuffer(device, &info);
+        if (transfer_buffer == nullptr) {
+            throw std::runtime_error(SDL_GetError());
+        }
+        return transfer_buffer;
+    }
+
+    // Returns true if at least one frame's bytes were reclaimed.
+    bool ReclaimSignalledFrames(UploadRing& ring) {
+        bool reclaimed = false;
+        while (!ring.in_flight.empty()) {
+            const auto& oldest = ring.in_flight.front();
+            if (oldest.fence != nullptr) {
+                if (!SDL_QueryGPUFence(ring.device, oldest.fence)) {
+                    break;
+                }
+                SDL_ReleaseGPUFence(ring.device, oldest.fence);
+            }
+            ring.retired_position = oldest.end;
+            ring.in_flight.erase(ring.in_flight.begin());
+            reclaimed = true;
+        }
+        return reclaimed;
+    }
+
+    void WaitForOldestFrame(UploadRing& ring) {
+        auto fence = ring.in_flight.front().fence;
+        if (fence != nullptr) {
+            SDL_WaitForGPUFences(ring.device, true, &fence, 1);
+        }
+        ++ring.frame_stats.stalls;
+        ReclaimSignalledFrames(ring);
+    }
+
+    // Only reached with nothing in flight: the current frame alone needs more than the ring holds. Its earlier writes
+    // stay in the old transfer buffer, which `pending` still references and which stays mapped, so pointers already
+    // handed out stay writable, until the next flush.
+    void GrowRing(UploadRing& ring, const std::uint32_t min_capacity) {
+        ring.outgrown.push_back(OutgrownTransferBuffer{ring.transfer_buffer, ring.mapped != nullptr});
+        ring.mapped = nullptr;
+
+        ring.capacity = static_cast<std::uint32_t>(
+            AlignUp(std::max<std::uint64_t>(std::uint64_t{ring.capacity} * 2, min_capacity), kUploadAlignment));
+        ring.transfer_buffer = CreateUploadTransferBuffer(ring.device, ring.capacity);
+        ring.write_position = 0;
+        ring.retired_position = 0;
+        ring.frame_start = 0;
+        ++ring.frame_stats.growths;
+    }
+
+    void AccumulateStats(UploadRingStats& total, const UploadRingStats& frame) {
+        total.bytes_uploaded += frame.bytes_uploaded;
+        total.upload_calls += frame.upload_calls;
+        total.stalls += frame.stalls;
+        total.growths += frame.growths;
+    }
+}
+
+UploadRing CreateUploadRing(SDL_GPUDevice* device, const std::uint32_t capacity) {
+    UploadRing ring{};
+    ring.device = device;
+    ring.capacity = static_cast<std::uint32_t>(AlignUp(capacity, kUploadAlignment));
+    ring.transfer_buffer = CreateUploadTransferBuffer(device, ring.capacity);
+    return ring;
+}
+
+void DestroyUploadRing(UploadRing& ring) {
+    if (ring.mapped != nullptr) {
+        SDL_UnmapGPUTransferBuffer(ring.device, ring.transfer_buffer);
+    }
+    for (const auto& frame : ring.in_flight) {
+        if (frame.fence != nullptr) {
+            SDL_ReleaseGPUFence(ring.device, frame.fence);
+        }
+    }
+    for (const auto& outgrown : ring.outgrown) {
+        if (outgrown.mapped) {
+            SDL_UnmapGPUTransferBuffer(ring.device, outgrown.buffer);
+        }
+        SDL_ReleaseGPUTransferBuffer(ring.device, outgrown.buffer);
+    }
+    SDL_ReleaseGPUTransferBuffer(ring.device, ring.transfer_buffer);
+    ring = UploadRing{};
+}
+
+void* WriteUpload(UploadRing& ring, SDL_GPUBuffer* destination, const std::uint32_t destination_offset,
+                  const std::uint32_t size, const bool cycle) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    std::uint64_t position = 0;
+    while (true) {
+        position = AlignUp(ring.write_position, kUploadAlignment);
+        if (position % ring.capacity + size > ring.capacity) { // never split a write across the wrap point
+            position = AlignUp(position, ring.capacity);
+        }
+        if (position + size - ring.retired_position <= ring.capacity) {
+            break;
+        }
+        if (ReclaimSignalledFrames(ring)) {
+            continue;
+        }
+        if (!ring.in_flight.empty()) {
+            WaitForOldestFrame(ring);
+            continue;
+        }
+        GrowRing(ring, size);
+    }
+
+    if (ring.mapped == nullptr) {
+        ring.mapped = static_cast<std::byte*>(SDL_MapGPUTransferBuffer(ring.device, ring.transfer_buffer, false));
+    }
+    const auto offset = static_cast<std::uint32_t>(position % ring.capacity);
+    ring.pending.push_back(PendingUpload{ring.transfer_buffer, offset, destination, destination_offset, size, cycle});
+    ring.write_position = position + size;
+    ring.frame_stats.bytes_uploaded += size;
+    return ring.mapped + offset;
+}
+
+void UploadBytes(UploadRing& ring, SDL_GPUBuffer* destination, const std::uint32_t destination_offset,
+                 const void* data, const std::uint32_t size, const bool cycle) {
+    if (auto target = WriteUpload(ring, destination, destination_offset, size, cycle)) {
+        memcpy(target, data, size);
+    }
+}
+
+void FlushUploadRing(UploadRing& ring, SDL_GPUCommandBuffer* cmdbuf) {
+    if (ring.mapped != nullptr) {
+        SDL_UnmapGPUTransferBuffer(ring.device, ring.transfer_buffer);
+        ring.mapped = nullptr;
+    }
+    for (auto& outgrown : ring.outgrown) {
+        if (outgrown.mapped) {
+            SDL_UnmapGPUTransferBuffer(ring.device, outgrown.buffer);
+            outgrown.mapped = false;
+        }
+    }
+
+    if (!ring.pending.empty()) {
+        // group by destination; stable so overlapping writes to one buffer still land in the order they were made
+        std::stable_sort(ring.pending.begin(), ring.pending.end(),
+                         [](const PendingUpload& a, const PendingUpload& b) { return a.destination < b.destination; });
+
+        auto copy_pass = SDL_BeginGPUCopyPass(cmdbuf);
+        SDL_GPUBuffer* previous_destination = nullptr;
+        for (std::size_t i = 0; i < ring.pending.size();) {
+            auto merged = ring.pending[i++];
+            while (i < ring.pending.size()) {
+                const auto& next = ring.pending[i];
+                const bool contiguous = next.source == merged.source && next.destination == merged.destination &&
+                                        next.source_offset == merged.source_offset + merged.size &&
+                                        next.destination_offset == merged.destination_offset + merged.size;
+                if (!contiguous) {
+                    break;
+                }
+                merged.size += next.size;
+                ++i;
+            }
+
+            const auto source =
+                SDL_GPUTransferBufferLocation{.transfer_buffer = merged.source, .offset = merged.source_offset};
+            const auto region = SDL_GPUBufferRegion{
+                .buffer = merged.destination, .offset = merged.destination_offset, .size = merged.size};
+            // cycling again after the first copy into a buffer would discard the copies before it
+            const bool cycle = merged.cycle && merged.destination != previous_destination;
+            previous_destination = merged.destination;
+            SDL_UploadToGPUBuffer(copy_pass, &source, &region, cycle);
+            ++ring.frame_stats.upload_calls;
+        }
+        SDL_EndGPUCopyPass(copy_pass);
+        ring.pending.clear();
+    }
+
+    for (const auto& outgrown : ring.outgrown) {
+        SDL_ReleaseGPUTransferBuffer(ring.device, outgrown.buffer);
+    }
+    ring.outgrown.clear();
+}
+
+void RetireUploadRingFrame(UploadRing& ring, SDL_GPUFence* fence) {
+    ring.in_flight.push_back(InFlightUploads{fence, ring.write_position});
+    ring.frame_start = ring.write_position;
+
+    ring.last_frame_stats = ring.frame_stats;
+    AccumulateStats(ring.total_stats, ring.frame_stats);
+    ring.frame_stats = UploadRingStats{};
+
+    ReclaimSignalledFrames(ring);
+}
+
+std::size_t UploadRingFramesInFlight(UploadRing& ring) {
+    ReclaimSignalledFrames(ring);
+    return ring.in_flight.size();
+}
+
+void WaitForUploadRingFrames(UploadRing& ring, const std::size_t max_frames) {
+    while (UploadRingFramesInFlight(ring) > max_frames) {
+        auto fence = ring.in_flight.front().fence;
+        SDL_WaitForGPUFences(ring.device, true, &fence, 1);
+    }
+}
+
+void PrintUploadRingReport(const UploadRingStats& stats, const std::size_t frame_count) {
+    const auto frames = static_cast<double>(std::max<std::size_t>(frame_count, 1));
+    std::cout << std::format("Upload ring over {} frames:\n", frame_count);
+    std::cout << std::format("  bytes/frame {:10.1f}  upload calls/frame {:6.2f}  stalls {}  growths {}\n",
+                             static_cast<double>(stats.bytes_uploaded) / frames,
+                             static_cast<double>(stats.upload_calls) / frames, stats.stalls, stats.growths);
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+
+#include "VertexNormals.hpp"
+
+namespace {
+    constexpr int kLanes = 8;
+    constexpr std::size_t kTriangleGrain = 16384;
+    constexpr std::size_t kVertexGrain = 16384;
+
+    // Face normals for triangles ids[begin, end) (or begin..end directly when ids is null), kLanes triangles at a
+    // time so the cross products run over contiguous lane arrays the compiler can vectorize.
+    void ComputeFaceNormals(VertexNormalEngine& e, const RenderableObject& obj, const std::uint32_t* ids,
+                            const std::size_t begin, const std::size_t end) {
+        for (auto base = begin; base < end; base += kLanes) {
+            const auto lane_count = static_cast<int>(std::min<std::size_t>(kLanes, end - base));
+
+            std::uint32_t tri[kLanes] = {};
+            float ax[kLanes] = {}, ay[kLanes] = {}, az[kLanes] = {};
+            float bx[kLanes] = {}, by[kLanes] = {}, bz[kLanes] = {};
+            float cx[kLanes] = {}, cy[kLanes] = {}, cz[kLanes] = {};
+            for (int lane = 0; lane < lane_count; ++lane) {
+                tri[lane] = ids != nullptr ? ids[base + lane] : static_cast<std::uint32_t>(base + lane);
+                const auto indices = obj.indices[tri[lane]];
+                ax[lane] = e.pos_x[indices[0]], ay[lane] = e.pos_y[indices[0]], az[lane] = e.pos_z[indices[0]];
+                bx[lane] = e.pos_x[indices[1]], by[lane] = e.pos_y[indices[1]], bz[lane] = e.pos_z[indices[1]];
+                cx[lane] = e.pos_x[indices[2]], cy[lane] = e.pos_y[indices[2]], cz[lane] = e.pos_z[indices[2]];
+            }
+
+            float nx[kLanes], ny[kLanes], nz[kLanes];
+            for (int lane = 0; lane < kLanes; ++lane) {
+                const auto e1x = bx[lane] - ax[lane], e1y = by[lane] - ay[lane], e1z = bz[lane] - az[lane];
+                const auto e2x = cx[lane] - ax[lane], e2y = cy[lane] - ay[lane], e2z = cz[lane] - az[lane];
+                nx[lane] = e1y * e2z - e1z * e2y;
+                ny[lane] = e1z * e2x - e1x * e2z;
+                nz[lane] = e1x * e2y - e1y * e2x;
+            }
+
+            for (int lane = 0; lane < lane_count; ++lane) {
+                const auto t = tri[lane];
+                if (e.weighting == NormalWeighting::Area) {
+                    e.face_x[t] = nx[lane];
+                    e.face_y[t] = ny[lane];
+                    e.face_z[t] = nz[lane];
+                    continue;
+                }
+
+                const glm::vec3 normal{nx[lane], ny[lane], nz[lane]};
+                const auto twice_area = glm::length(normal);
+                const auto unit = twice_area > 0.0f ? normal / twice_area : glm::vec3{0.0f, 0.0f, 0.0f};
+                e.face_x[t] = unit.x;
+                e.face_y[t] = unit.y;
+                e.face_z[t] = unit.z;
+
+                const glm::vec3 corner_pos[3] = {
+                    {ax[lane], ay[lane], az[lane]}, {bx[lane], by[lane], bz[lane]}, {cx[lane], cy[lane], cz[lane]}};
+                for (int corner = 0; corner < 3; ++corner) {
+                    const auto to_next = corner_pos[(corner + 1) % 3] - corner_pos[corner];
+                    const auto to_prev = corner_pos[(corner + 2) % 3] - corner_pos[corner];
+                    e.corner_angles[t * 3 + corner] =
+                        std::atan2(glm::length(glm::cross(to_next, to_prev)), glm::dot(to_next, to_prev));
+                }
+            }
+        }
+    }
+
+    // Sums the adjacent face normals of vertices ids[begin, end) (or begin..end when ids is null).
+    void GatherVertexNormals(const VertexNormalEngine& e, RenderableObject& obj, const std::uint32_t* ids,
+                             const std::size_t begin, const std::size_t end) {
+        const bool angle_weighted = e.weighting == NormalWeighting::Angle;
+        for (auto i = begin; i < end; ++i) {
+            const auto v = ids != nullptr ? ids[i] : static_cast<std::uint32_t>(i);
+
+            float sum_x = 0.0f, sum_y = 0.0f, sum_z = 0.0f;
+            for (auto c = e.corner_offsets[v]; c < e.corner_offsets[v + 1]; ++c) {
+                const auto corner = e.corners[c];
+                const auto t = corner / 3;
+                const auto weight = angle_weighted ? e.corner_angles[corner] : 1.0f;
+                sum_x += e.face_x[t] * weight;
+                sum_y += e.face_y[t] * weight;
+                sum_z += e.face_z[t] * weight;
+            }
+
+            // the faces above are cross(b - a, c - a); negated to point outward, the same way as FaceNormal()
+            const auto length = std::sqrt(sum_x * sum_x + sum_y * sum_y + sum_z * sum_z);
+            obj.normals[v] = length > 0.0f ? VertexNormal{-sum_x / length, -sum_y / length, -sum_z / length}
+                                           : VertexNormal{0.0f, 0.0f, 0.0f};
+        }
+    }
+}
+
+void BuildVertexNormalEngine(VertexNormalEngine& e, const RenderableObject& obj, const NormalWeighting weighting) {
+    const auto vertex_count = obj.vertices.size();
+    const auto triangle_count = obj.indices.size();
+    e.weighting = weighting;
+
+    e.pos_x.resize(vertex_count);
+    e.pos_y.resize(vertex_count);
+    e.pos_z.resize(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        e.pos_x[v] = obj.vertices[v].pos.x;
+        e.pos_y[v] = obj.vertices[v].pos.y;
+        e.pos_z[v] = obj.vertices[v].pos.z;
+    }
+
+    e.face_x.resize(triangle_count);
+    e.face_y.resize(triangle_count);
+    e.face_z.resize(triangle_count);
+    e.corner_angles.resize(weighting == NormalWeighting::Angle ? triangle_count * 3 : 0);
+
+    // counting sort of corners by vertex
+    e.corner_offsets.assign(vertex_count + 1, 0);
+    for (const auto& indices : obj.indices) {
+        ++e.corner_offsets[indices[0] + 1];
+        ++e.corner_offsets[indices[1] + 1];
+        ++e.corner_offsets[indices[2] + 1];
+    }
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        e.corner_offsets[v + 1] += e.corner_offsets[v];
+    }
+    e.corners.resize(triangle_count * 3);
+    std::vector<std::uint32_t> cursor(e.corner_offsets.begin(), e.corner_offsets.end() - 1);
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            e.corners[cursor[obj.indices[t][corner]]++] = static_cast<std::uint32_t>(t * 3 + corner);
+        }
+    }
+
+    e.triangle_marks.assign(triangle_count, 0);
+    e.vertex_marks.assign(vertex_count, 0);
+}
+
+void ComputeVertexNormals(VertexNormalEngine& e, RenderableObject& obj, ThreadPool& pool) {
+    obj.normals.resize(obj.vertices.size());
+
+    pool.ParallelFor(obj.indices.size(), kTriangleGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        ComputeFaceNormals(e, obj, nullptr, begin, end);
+    });
+    pool.ParallelFor(obj.vertices.size(), kVertexGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        GatherVertexNormals(e, obj, nullptr, begin, end);
+    });
+}
+
+void UpdateVertexNormals(VertexNormalEngine& e, RenderableObject& obj, const std::span<const std::uint32_t> changed,
+                         ThreadPool& pool) {
+    e.dirty_triangles.clear();
+    e.dirty_vertices.clear();
+
+    // a moved vertex changes its triangles' face normals, which change every vertex of those triangles
+    for (const auto v : changed) {
+        e.pos_x[v] = obj.vertices[v].pos.x;
+        e.pos_y[v] = obj.vertices[v].pos.y;
+        e.pos_z[v] = obj.vertices[v].pos.z;
+        for (auto c = e.corner_offsets[v]; c < e.corner_offsets[v + 1]; ++c) {
+            const auto t = e.corners[c] / 3;
+            if (e.triangle_marks[t] == 0) {
+                e.triangle_marks[t] = 1;
+                e.dirty_triangles.push_back(t);
+            }
+        }
+    }
+    for (const auto t : e.dirty_triangles) {
+        e.triangle_marks[t] = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            const auto v = obj.indices[t][corner];
+            if (e.vertex_marks[v] == 0) {
+                e.vertex_marks[v] = 1;
+                e.dirty_vertices.push_back(v);
+            }
+        }
+    }
+    for (const auto v : e.dirty_vertices) {
+        e.vertex_marks[v] = 0;
+    }
+
+    pool.ParallelFor(e.dirty_triangles.size(), kTriangleGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        ComputeFaceNormals(e, obj, e.dirty_triangles.data(), begin, end);
+    });
+    pool.ParallelFor(e.dirty_vertices.size(), kVertexGrain, [&](std::size_t begin, std::size_t end, unsigned) {
+        GatherVertexNormals(e, obj, e.dirty_vertices.data(), begin, end);
+    });
+}
+
+RenderableObject& CalculateVertexNormals(RenderableObject& obj) {
+    VertexNormalEngine engine{};
+    BuildVertexNormalEngine(engine, obj, NormalWeighting::Area);
+    ComputeVertexNormals(engine, obj, GetThreadPool());
+    return obj;
+}
+
+glm::vec3 FaceNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return glm::cross(c - a, b - a);
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+
+#include "VertexQuantization.hpp"
+
+namespace {
+    constexpr float kUnormMax = 65535.0f;
+    constexpr float kSnormMax = 32767.0f;
+
+    std::int16_t ToSnorm16(const float value) {
+        return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * kSnormMax));
+    }
+    float FromSnorm16(const std::int16_t value) {
+        return std::max(static_cast<float>(value) / kSnormMax, -1.0f);
+    }
+    float SignNotZero(const float value) {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    float AngleBetweenDegrees(const glm::vec3 a, const glm::vec3 b) {
+        const auto cosine = std::clamp(glm::dot(a, b), -1.0f, 1.0f);
+        return std::acos(cosine) * 180.0f / 3.14159265f;
+    }
+}
+
+std::uint32_t VertexStride(const VertexFormat format) {
+    return format == VertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(PositionAndColorVertex);
+}
+
+std::uint32_t NormalStride(const VertexFormat format) {
+    return format == VertexFormat::Quantized ? sizeof(PackedNormal) : sizeof(VertexNormal);
+}
+
+PackedNormal EncodeOctahedral(const glm::vec3 normal) {
+    const auto l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1 == 0.0f) {
+        return kZeroPackedNormal;
+    }
+    auto x = normal.x / l1, y = normal.y / l1;
+    if (normal.z < 0.0f) {
+        const auto folded_x = (1.0f - std::abs(y)) * SignNotZero(x);
+        const auto folded_y = (1.0f - std::abs(x)) * SignNotZero(y);
+        x = folded_x, y = folded_y;
+    }
+
+    // plain rounding can land on a neighbour that decodes further away; try the four surrounding codes
+    const auto unit = glm::normalize(normal);
+    const auto base_x = std::floor(std::clamp(x, -1.0f, 1.0f) * kSnormMax);
+    const auto base_y = std::floor(std::clamp(y, -1.0f, 1.0f) * kSnormMax);
+    PackedNormal best{ToSnorm16(x), ToSnorm16(y)};
+    auto best_error = 1.0f - glm::dot(DecodeOctahedral(best), unit);
+    for (int dx = 0; dx < 2; ++dx) {
+        for (int dy = 0; dy < 2; ++dy) {
+            const auto candidate =
+                PackedNormal{ToSnorm16((base_x + dx) / kSnormMax), ToSnorm16((base_y + dy) / kSnormMax)};
+            const auto error = 1.0f - glm::dot(DecodeOctahedral(candidate), unit);
+            if (error < best_error) {
+                best = candidate;
+                best_error = error;
+            }
+        }
+    }
+    if (best.x == kZeroPackedNormal.x && best.y == kZeroPackedNormal.y) {
+        return PackedNormal{32767, 32767}; // straight down, like the reserved corner
+    }
+    return best;
+}
+
+glm::vec3 DecodeOctahedral(const PackedNormal packed) {
+    // mirrors DecodeOctahedral() in MVPInstancedQuantized.vert.hlsl
+    if (packed.x == kZeroPackedNormal.x && packed.y == kZeroPackedNormal.y) {
+        return glm::vec3{0.0f};
+    }
+    const auto x = FromSnorm16(packed.x), y = FromSnorm16(packed.y);
+    glm::vec3 n{x, y, 1.0f - std::abs(x) - std::abs(y)};
+    const auto t = std::clamp(-n.z, 0.0f, 1.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    const auto length = glm::length(n);
+    return length > 0.0f ? n / length : n;
+}
+
+QuantizedMesh QuantizeMesh(const RenderableObject& obj) {
+    QuantizedMesh mesh{};
+    const auto vertex_count = obj.vertices.size();
+    mesh.vertices.resize(vertex_count);
+    mesh.normals.resize(vertex_count, kZeroPackedNormal);
+
+    glm::vec3 box_min{0.0f}, box_max{0.0f};
+    if (vertex_count > 0) {
+        box_min = box_max = obj.vertices[0].pos;
+        for (const auto& vertex : obj.vertices) {
+            box_min = glm::min(box_min, vertex.pos);
+            box_max = glm::max(box_max, vertex.pos);
+        }
+    }
+    // flat axes still need a non-zero scale for the matrix to stay invertible
+    const auto extent = glm::max(box_max - box_min, glm::vec3{1e-6f});
+
+    mesh.dequantize = glm::mat4{extent.x, 0.0f,     0.0f,     0.0f, 0.0f,      extent.y,  0.0f,      0.0f,
+                                0.0f,     0.0f,     extent.z, 0.0f, box_min.x, box_min.y, box_min.z, 1.0f};
+
+    auto& report = mesh.report;
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        const auto& source = obj.vertices[v];
+        auto& target = mesh.vertices[v];
+        for (int axis = 0; axis < 3; ++axis) {
+            const auto normalized = std::clamp((source.pos[axis] - box_min[axis]) / extent[axis], 0.0f, 1.0f);
+            target.position[axis] = static_cast<std::uint16_t>(std::lround(normalized * kUnormMax));
+            const auto decoded = box_min[axis] + static_cast<float>(target.position[axis]) / kUnormMax * extent[axis];
+            report.max_position_error = std::max(report.max_position_error, std::abs(decoded - source.pos[axis]));
+        }
+        target.position[3] = 0;
+        target.color = source.color;
+    }
+
+    if (obj.normals.size() == vertex_count) {
+        for (std::size_t v = 0; v < vertex_count; ++v) {
+            const auto length = glm::length(obj.normals[v]);
+            if (length == 0.0f) {
+                continue;
+            }
+            mesh.normals[v] = EncodeOctahedral(obj.normals[v]);
+            const auto error = AngleBetweenDegrees(DecodeOctahedral(mesh.normals[v]), obj.normals[v] / length);
+            report.max_normal_error = std::max(report.max_normal_error, error);
+        }
+    }
+
+    report.float_bytes = vertex_count * (sizeof(PositionAndColorVertex) + sizeof(VertexNormal));
+    report.quantized_bytes = vertex_count * (sizeof(QuantizedVertex) + sizeof(PackedNormal));
+    return mesh;
+}
+
+void PrintQuantizationReport(const std::string_view name, const QuantizationReport& report) {
+    const auto saved = report.float_bytes - report.quantized_bytes;
+    const auto percent = report.float_bytes > 0 ? 100.0 * static_cast<double>(saved) / report.float_bytes : 0.0;
+    std::cout << std::format("  {:<8} max position error {:.2e}  max normal error {:.4f} deg  {} -> {} bytes "
+                             "({} saved, {:.0f}%)\n",
+                             name, report.max_position_error, report.max_normal_error, report.float_bytes,
+                             report.quantized_bytes, saved, percent);
+}